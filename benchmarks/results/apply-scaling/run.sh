@@ -0,0 +1,6 @@
+#!/bin/sh
+make run THREADS=1
+make run THREADS=2
+make run THREADS=4
+make run THREADS=8
+make data
@@ -0,0 +1,6 @@
+#!/bin/sh
+make gen SIZE=15
+make run EXT=lrat SIZE=15
+make run EXT=drat SIZE=15
+make clear SIZE=15
+make data
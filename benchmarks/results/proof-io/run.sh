@@ -0,0 +1,7 @@
+#!/bin/sh
+make gen SIZE=5000
+make run rate EXT=lrat SIZE=5000
+make run rate EXT=lratb SIZE=5000
+make run rate EXT=drat SIZE=5000
+make clear SIZE=5000
+make data
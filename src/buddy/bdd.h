@@ -111,9 +111,21 @@
 #define bddop_andimptstj  20
 #endif
 
+/*=== Operator caches, for bdd_setopcacheratio and cache statistics ====*/
+
+#define bddcache_apply    0   /* Apply, not and simplify */
+#define bddcache_ite      1
+#define bddcache_quant    2   /* Quantification and appex */
+#define bddcache_replace  3   /* Replace and compose */
+#define bddcache_misc     4   /* Restrict, constrain and counting */
+#define bddcache_proof    5   /* Proof generating apply operations */
+#define BDD_CACHE_NUM     6
+
 /*=== Defining clauses ===================================================*/
 
 #if ENABLE_TBDD
+#include "ilist.h"   /* For clause_id_t */
+
 typedef enum { DEF_HU, DEF_LU, DEF_HD, DEF_LD } dclause_t;
 #endif
 
@@ -134,6 +146,9 @@ typedef struct s_bddPair
    struct s_bddPair *next;
 } bddPair;
 
+   /* All state of the package.  Contents are private */
+typedef struct s_BddManager BddManager;
+
 
 /*=== Status information ===============================================*/
 
@@ -151,6 +166,10 @@ PROTO   {* typedef struct s_bddStat
    int varnum;
    int cachesize;
    int gbcnum;
+   int gbcyoungnum;
+   int resizenum;
+   int cacheresizenum;
+   int memlimit;
 } bddStat;  *}
 DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{lp{10cm}}
   {\tt produced}     & total number of new nodes ever produced \\
@@ -161,7 +180,12 @@ DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{lp{10cm}}
                        garbage collection. \\
   {\tt varnum}       & number of defined bdd variables \\
   {\tt cachesize}    & number of entries in the internal caches \\
-  {\tt gbcnum}       & number of garbage collections done until now
+  {\tt gbcnum}       & number of garbage collections done until now \\
+  {\tt gbcyoungnum}  & number of those that only collected young nodes \\
+  {\tt resizenum}    & number of times the node table has grown \\
+  {\tt cacheresizenum} & number of times an operator cache has grown
+                       from its hit rate (see {\tt bdd\_setadaptive}) \\
+  {\tt memlimit}     & memory limit in megabytes, or 0 for none
   \end{tabular} *}
 ALSO    {* bdd\_stats *}
 */
@@ -175,6 +199,10 @@ typedef struct s_bddStat
    int varnum;
    int cachesize;
    int gbcnum;
+   int gbcyoungnum;
+   int resizenum;
+   int cacheresizenum;
+   int memlimit;
 } bddStat;
 
 
@@ -190,6 +218,7 @@ PROTO   {* typedef struct s_bddGbcStat
    long time;
    long sumtime;
    int num;
+   int cachekept;
 } bddGbcStat;  *}
 DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{ll}
   {\tt nodes}     & Total number of allocated nodes in the nodetable \\
@@ -197,7 +226,8 @@ DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{ll}
   {\tt prevfreednodes} & number of bdd nodes that were freed during the preceding garbage collection \\
   {\tt time}      & Time used for garbage collection this time \\
   {\tt sumtime}   & Total time used for garbage collection \\
-  {\tt num}       & number of garbage collections done until now
+  {\tt num}       & number of garbage collections done until now \\
+  {\tt cachekept} & number of operator cache entries kept by the preceding garbage collection
   \end{tabular} *}
 ALSO    {* bdd\_gbc\_hook *}
 */
@@ -209,6 +239,7 @@ typedef struct s_bddGbcStat
    long time;
    long sumtime;
    int num;
+   int cachekept;
 } bddGbcStat;
 
 
@@ -225,6 +256,9 @@ PROTO   {* typedef struct s_bddCacheStat
    long unsigned int opHit;
    long unsigned int opMiss;
    long unsigned int swapCount;
+   long unsigned int gbcKept;
+   long unsigned int cacheHit[BDD_CACHE_NUM];
+   long unsigned int cacheMiss[BDD_CACHE_NUM];
 } bddCacheStat; *}
 DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{ll}
   {\bf Name}         & {\bf Number of } \\
@@ -235,6 +269,9 @@ DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{ll}
   opHit        & entries found in the operator caches \\
   opMiss       & entries not found in the operator caches \\
   swapCount    & number of variable swaps in reordering \\
+  gbcKept      & operator cache entries kept across garbage collections \\
+  cacheHit     & entries found, for each of the operator caches \\
+  cacheMiss    & entries not found, for each of the operator caches \\
 \end{tabular} *}
 ALSO    {* bdd\_cachestats *}
 */
@@ -247,6 +284,9 @@ typedef struct s_bddCacheStat
    long unsigned int opHit;
    long unsigned int opMiss;
    long unsigned int swapCount;
+   long unsigned int gbcKept;
+   long unsigned int cacheHit[BDD_CACHE_NUM];
+   long unsigned int cacheMiss[BDD_CACHE_NUM];
 } bddCacheStat;
 
 /*=== BDD interface prototypes =========================================*/
@@ -286,13 +326,23 @@ extern bddfilehandler bdd_file_hook(bddfilehandler);
    
 extern int      bdd_init(int, int);
 extern void     bdd_done(void);
+extern BddManager* bdd_newmanager(void);
+extern void     bdd_deletemanager(BddManager*);
+extern BddManager* bdd_setmanager(BddManager*);
+extern BddManager* bdd_getmanager(void);
 extern int      bdd_setvarnum(int);
 extern int      bdd_setvarnum_ordered(int, int*);
 extern int      bdd_extvarnum(int);
 extern int      bdd_isrunning(void);
 extern int      bdd_setmaxnodenum(int);
 extern int      bdd_setmaxincrease(int);
+extern int      bdd_sethugepages(int);
+extern int      bdd_setadaptive(int);
+extern int      bdd_setmemlimit(int);
+extern int      bdd_memnodenum(int);
 extern int      bdd_setminfreenodes(int);
+extern int      bdd_setgenerational(int);
+extern int      bdd_setapplythreads(int);
 extern int      bdd_getnodenum(void);
 extern int      bdd_getallocnum(void);
 extern char*    bdd_versionstr(void);
@@ -331,11 +381,12 @@ extern void     bdd_freepair(bddPair*);
 #if ENABLE_TBDD
 extern int      bdd_xvar(BDD);
 extern int      bdd_nameid(BDD);
-extern int      bdd_dclause(BDD, dclause_t);
+extern clause_id_t bdd_dclause(BDD, dclause_t);
 #endif     
   /* In bddop.c */
 
 extern int      bdd_setcacheratio(int);
+extern int      bdd_setopcacheratio(int, int);
 extern BDD      bdd_buildcube(int, int, BDD *);
 extern BDD      bdd_ibuildcube(int, int, int *);
 extern BDD      bdd_not(BDD);
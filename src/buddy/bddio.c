@@ -48,7 +48,7 @@ static int  bdd_loaddata(FILE *);
 static int  loadhash_get(int);
 static void loadhash_add(int, int);
 
-static bddfilehandler filehandler;
+#define filehandler   (bddmanager->io.filehandler)
 
 typedef struct s_LoadHash
 {
@@ -58,10 +58,11 @@ typedef struct s_LoadHash
    int next;
 } LoadHash;
 
-static LoadHash *lh_table;
-static int       lh_freepos;
-static int       lh_nodenum;
-static int      *loadvar2level;
+   /* Loading state of the current manager, see manager.h */
+#define lh_table      (bddmanager->io.lh_table)
+#define lh_freepos    (bddmanager->io.lh_freepos)
+#define lh_nodenum    (bddmanager->io.lh_nodenum)
+#define loadvar2level (bddmanager->io.loadvar2level)
 
 /*=== PRINTING ========================================================*/
 
@@ -130,7 +131,7 @@ void bdd_fprintall(FILE *ofile)
    {
       if (LOW(n) != -1)
       {
-	 fprintf(ofile, "[%5d - %2d] ", n, bddnodes[n].refcou);
+	 fprintf(ofile, "[%5d - %2d] ", n, REFCOU(n));
 	 if (filehandler)
 	    filehandler(ofile, bddlevel2var[LEVEL(n)]);
 	 else
@@ -179,11 +180,11 @@ void bdd_fprinttable(FILE *ofile, BDD r)
    
    for (n=0 ; n<bddnodesize ; n++)
    {
-      if (LEVEL(n) & MARKON)
+      if (MARKED(n))
       {
 	 node = &bddnodes[n];
 	 
-	 LEVELp(node) &= MARKOFF;
+	 UNMARKp(node);
 
 	 fprintf(ofile, "[%5d] ", n);
 	 if (filehandler)
@@ -425,9 +426,9 @@ static int bdd_save_rec(FILE *ofile, int root)
    if (root < 2)
       return 0;
 
-   if (LEVELp(node) & MARKON)
+   if (MARKEDp(node))
       return 0;
-   LEVELp(node) |= MARKON;
+   SETMARKp(node);
    
    if ((err=bdd_save_rec(ofile, LOWp(node))) < 0)
       return err;
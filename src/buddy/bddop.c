@@ -117,35 +117,43 @@ static int oprres[OPERATOR_NUM][4] =
 };
 
 
-   /* Variables needed for the operators */
-static int applyop;                 /* Current operator for apply */
-static int appexop;                 /* Current operator for appex */
-static int appexid;                 /* Current cache id for appex */
-static int quantid;                 /* Current cache id for quantifications */
-static int *quantvarset;            /* Current variable set for quant. */
-static int quantvarsetID;           /* Current id used in quantvarset */
-static int quantlast;               /* Current last variable to be quant. */
-static int replaceid;               /* Current cache id for replace */
-static int *replacepair;            /* Current replace pair */
-static int replacelast;             /* Current last var. level to replace */
-static int composelevel;            /* Current variable used for compose */
-static int miscid;                  /* Current cache id for other results */
-static int *varprofile;             /* Current variable profile */
-static int supportID;               /* Current ID (true value) for support */
-static int supportMin;              /* Min. used level in support calc. */
-static int supportMax;              /* Max. used level in support calc. */
-static int* supportSet;             /* The found support set */
-static BddCache opcache;            /* Cache for all operations */
-static int cacheratio;
-static BDD satPolarity;
-static int firstReorder;            /* Used instead of local variable in order
-				       to avoid compiler warning about 'first'
-				       being clobbered by setjmp */
-
-static char*            allsatProfile; /* Variable profile for bdd_allsat() */
-static bddallsathandler allsatHandler; /* Callback handler for bdd_allsat() */
-
-extern bddCacheStat bddcachestats;
+   /* Variables needed for the operators, kept in the current manager */
+#define applyop        (bddmanager->op.applyop)
+#define appexop        (bddmanager->op.appexop)
+#define appexid        (bddmanager->op.appexid)
+#define quantid        (bddmanager->op.quantid)
+#define quantvarset    (bddmanager->op.quantvarset)
+#define quantvarsetID  (bddmanager->op.quantvarsetID)
+#define quantlast      (bddmanager->op.quantlast)
+#define replaceid      (bddmanager->op.replaceid)
+#define replacepair    (bddmanager->op.replacepair)
+#define replacelast    (bddmanager->op.replacelast)
+#define composelevel   (bddmanager->op.composelevel)
+#define miscid         (bddmanager->op.miscid)
+#define varprofile     (bddmanager->op.varprofile)
+#define supportID      (bddmanager->op.supportID)
+#define supportMin     (bddmanager->op.supportMin)
+#define supportMax     (bddmanager->op.supportMax)
+#define supportSet     (bddmanager->op.supportSet)
+#define supportSize    (bddmanager->op.supportSize)
+#define opcache        (bddmanager->op.opcache)
+#define cacheratio     (bddmanager->op.cacheratio)
+#define opcacheratio   (bddmanager->op.opcacheratio)
+#define adapthit       (bddmanager->op.adapthit)
+#define adaptmiss      (bddmanager->op.adaptmiss)
+#define satPolarity    (bddmanager->op.satPolarity)
+#define firstReorder   (bddmanager->op.firstReorder)
+#define allsatProfile  (bddmanager->op.allsatProfile)
+#define allsatHandler  (bddmanager->op.allsatHandler)
+#define quantstack     (bddmanager->op.quantstack)
+#define quantstackalloc (bddmanager->op.quantstackalloc)
+#define jstack         (bddmanager->op.jstack)
+#define jstackalloc    (bddmanager->op.jstackalloc)
+#define aijstack       (bddmanager->op.aijstack)
+#define aijstackalloc  (bddmanager->op.aijstackalloc)
+#define applystack     (bddmanager->op.applystack)
+#define applystackalloc (bddmanager->op.applystackalloc)
+
 
    /* Internal prototypes */
 static BDD    not_rec(BDD);
@@ -179,6 +187,32 @@ static pcbdd    bdd_applyj(BDD, BDD, int op);
 static pcbdd    bdd_apply_aij(BDD, BDD, BDD);
 static pcbdd    applyj_rec(BDD, BDD);
 static pcbdd    apply_aij_rec(BDD, BDD, BDD);
+#endif
+
+   /* Caches */
+#if ENABLE_TBDD
+#define OPCACHE_NUM BDD_CACHE_NUM
+#else
+#define OPCACHE_NUM bddcache_proof
+#endif
+
+#define applycache    (opcache[bddcache_apply])
+#define itecache      (opcache[bddcache_ite])
+#define quantcache    (opcache[bddcache_quant])
+#define replacecache  (opcache[bddcache_replace])
+#define misccache     (opcache[bddcache_misc])
+#define proofcache    (opcache[bddcache_proof])
+
+   /* Default size of each cache, as a divisor of the base size */
+static const int opcachescale[BDD_CACHE_NUM] = { 1, 4, 1, 4, 4, 1 };
+
+   /* With adaptive sizing, double a cache whose hit rate is at least
+      this percentage */
+#define ADAPTCACHEHIT 30
+
+#ifdef CACHESTATS
+#define OPHIT(c)  (bddcachestats.opHit++, bddcachestats.cacheHit[c]++)
+#define OPMISS(c) (bddcachestats.opMiss++, bddcachestats.cacheMiss[c]++)
 #endif
 
    /* Hashvalues */
@@ -211,8 +245,22 @@ static pcbdd    apply_aij_rec(BDD, BDD, BDD);
 
 int bdd_operator_init(int cachesize)
 {
-   if (BddCache_init(&opcache,cachesize) < 0)
-      return bdd_error(BDD_MEMORY);
+   int c;
+
+   for (c=0 ; c<OPCACHE_NUM ; c++)
+   {
+      int err;
+
+      /* Only the misc cache holds double results */
+      if (c == bddcache_misc)
+	 err = BddCache_init_wide(&opcache[c], cachesize/opcachescale[c]);
+      else
+	 err = BddCache_init(&opcache[c], cachesize/opcachescale[c]);
+      if (err < 0)
+	 return bdd_error(BDD_MEMORY);
+      opcacheratio[c] = 0;
+      adapthit[c] = adaptmiss[c] = 0;
+   }
 
    quantvarsetID = 0;
    quantvarset = NULL;
@@ -225,26 +273,224 @@ int bdd_operator_init(int cachesize)
 
 void bdd_operator_done(void)
 {
+   int c;
+
    if (quantvarset != NULL)
       free(quantvarset);
    
 #if ENABLE_TBDD
-   BddCache_clear_clauses(&opcache);
+   BddCache_clear_clauses(&proofcache);
    process_deferred_deletions();
 #endif
-   BddCache_done(&opcache);
+   for (c=0 ; c<OPCACHE_NUM ; c++)
+      BddCache_done(&opcache[c]);
 
    if (supportSet != NULL)
      free(supportSet);
+
+   free(applystack);
+   free(quantstack);
+   free(jstack);
+   free(aijstack);
+   applystack = quantstack = jstack = aijstack = NULL;
+   applystackalloc = quantstackalloc = jstackalloc = aijstackalloc = 0;
+}
+
+
+/*
+  Make room for frame sp on an explicit stack.  Returns 0 if out of
+  memory
+*/
+int bdd_framestack_reserve(BddFrame **stack, int *alloc, int sp)
+{
+   int newalloc;
+   BddFrame *newstack;
+
+   if (sp < *alloc)
+      return 1;
+   newalloc = *alloc < 64 ? 64 : 2 * *alloc;
+   if ((newstack=(BddFrame*)realloc(*stack, sizeof(BddFrame)*newalloc)) == NULL)
+      return 0;
+   *stack = newstack;
+   *alloc = newalloc;
+   return 1;
 }
 
 
 void bdd_operator_reset(void)
 {
+   int c;
+
+#if ENABLE_TBDD
+   BddCache_clear_clauses(&proofcache);
+#endif
+   for (c=0 ; c<OPCACHE_NUM ; c++)
+      BddCache_reset(&opcache[c]);
+   bdd_papply_reset();
+}
+
+
+/* Node still allocated after garbage collection */
+#define SURVIVED(n) ((n) < 2  ||  LOW(n) != -1)
+
+static int bdd_cache_clean(BddCache *cache, int checkc)
+{
+   int n, kept = 0;
+
+   for (n=0 ; n<cache->tablesize ; n++)
+   {
+      BddCacheData *entry = &cache->table[n];
+
+      if (entry->a == -1)
+	 continue;
+
+      if (SURVIVED(entry->a)  &&  (entry->b == -1  ||  SURVIVED(entry->b))  &&
+	  SURVIVED(entry->res)  &&  (!checkc  ||  SURVIVED(entry->c)))
+	 kept++;
+      else
+	 entry->a = -1;
+   }
+
+   return kept;
+}
+
+#if ENABLE_TBDD
+static int bdd_proofcache_clean(void)
+{
+   int n, kept = 0;
+
+   for (n=0 ; n<proofcache.tablesize ; n++)
+   {
+      BddCacheData *entry = &proofcache.table[n];
+
+      if (entry->a == -1)
+	 continue;
+
+      /* res holds the third operand of andimptstj, or a result node */
+      if (SURVIVED(entry->a)  &&  SURVIVED(PROOFNODE(entry->b))  &&
+	  SURVIVED(entry->res))
+	 kept++;
+      else
+      {
+	 BddCache_clause_evict(entry);
+	 entry->a = -1;
+      }
+   }
+
+   return kept;
+}
+#endif
+
+/* Number of nodes for each entry of cache c, or 0 for a fixed size */
+static int cache_ratio(int c)
+{
+   if (opcacheratio[c] > 0)
+      return opcacheratio[c];
+   if (cacheratio > 0)
+      return cacheratio * opcachescale[c];
+   return 0;
+}
+
+
+static size_t cache_entrybytes(int c)
+{
+   return opcache[c].wide ? sizeof(BddCacheWide) : sizeof(BddCacheData);
+}
+
+
+/*
+  Memory taken by the operator caches if the node table had nodesize
+  nodes.  Caches without a ratio keep their present size.
+*/
+size_t bdd_operator_cachebytes(int nodesize)
+{
+   size_t bytes = 0;
+   int c;
+
+   for (c=0 ; c<OPCACHE_NUM ; c++)
+   {
+      int ratio = cache_ratio(c);
+      size_t entries = ratio > 0 ? nodesize / ratio : opcache[c].tablesize;
+
+      bytes += entries * cache_entrybytes(c);
+   }
+   return bytes;
+}
+
+
+/*
+  Adaptive cache sizing, called at garbage collection.  Once a cache
+  has seen as many lookups as it has entries, double it if its hit
+  rate over these shows that it holds results worth keeping, as long
+  as it stays smaller than the node table and within the memory
+  limit.  The cache keeps its new ratio when the node table grows.
+*/
+static void bdd_operator_adapt(void)
+{
+#ifdef CACHESTATS
+   int c;
+
+   for (c=0 ; c<OPCACHE_NUM ; c++)
+   {
+      BddCache *cache = &opcache[c];
+      long unsigned int hit = bddcachestats.cacheHit[c] - adapthit[c];
+      long unsigned int miss = bddcachestats.cacheMiss[c] - adaptmiss[c];
+      int ratio;
+
+      if (hit+miss < (long unsigned int) cache->tablesize)
+	 continue;
+      adapthit[c] = bddcachestats.cacheHit[c];
+      adaptmiss[c] = bddcachestats.cacheMiss[c];
+
+      ratio = bddnodesize / cache->tablesize;
+      if (hit*100 < ADAPTCACHEHIT*(hit+miss)  ||  ratio < 2)
+	 continue;
+      if (!bdd_memroom(cache->tablesize * cache_entrybytes(c)))
+	 continue;
+
 #if ENABLE_TBDD
-   BddCache_clear_clauses(&opcache);
+      if (c == bddcache_proof)
+	 BddCache_clear_clauses(&proofcache);
+#endif
+      opcacheratio[c] = ratio / 2;
+      if (BddCache_resize(cache, bddnodesize / opcacheratio[c]) < 0)
+      {
+	 bdd_error(BDD_MEMORY);
+	 return;
+      }
+      opcacheresizenum++;
+   }
 #endif
-   BddCache_reset(&opcache);
+}
+
+
+/*
+  Called after garbage collection, in place of bdd_operator_reset.
+  Keep the cache entries whose operands and result all survived.
+  The quantification and misc caches are cleared, since their IDs
+  encode the variable set node ambiguously, or their results are not
+  nodes.  Return the number of entries kept.
+*/
+int bdd_operator_clean(void)
+{
+   int kept = 0;
+
+   if (bddadaptive)
+      bdd_operator_adapt();
+
+   BddCache_reset(&quantcache);
+   BddCache_reset(&misccache);
+   bdd_papply_reset();
+
+   kept += bdd_cache_clean(&applycache, 0);
+   kept += bdd_cache_clean(&itecache, 1);
+   kept += bdd_cache_clean(&replacecache, 0);
+#if ENABLE_TBDD
+   kept += bdd_proofcache_clean();
+#endif
+
+   bddcachestats.gbcKept += kept;
+   return kept;
 }
 
 
@@ -263,14 +509,20 @@ void bdd_operator_varresize(void)
 
 static void bdd_operator_noderesize(void)
 {
-   if (cacheratio > 0)
+   int c;
+
+   for (c=0 ; c<OPCACHE_NUM ; c++)
    {
-      int newcachesize = bddnodesize / cacheratio;
+      int ratio = cache_ratio(c);
+
+      if (ratio == 0)
+	 continue;
       
 #if ENABLE_TBDD
-      BddCache_clear_clauses(&opcache);
+      if (c == bddcache_proof)
+	 BddCache_clear_clauses(&proofcache);
 #endif
-      BddCache_resize(&opcache, newcachesize);
+      BddCache_resize(&opcache[c], bddnodesize / ratio);
    }
 }
 
@@ -291,9 +543,12 @@ DESCR   {* The ratio between the number of nodes in the nodetable
 	   {\tt bdd\_setcacheratio} to any positive value. When this is done
 	   the caches are resized instantly to fit the new ratio.
 	   The default is a fixed cache size determined at
-	   initialization time. *}
+	   initialization time.  The caches for ITE, replace and the
+	   miscellaneous operations get a quarter of this size, and
+	   caches given their own ratio by {\tt bdd\_setopcacheratio}
+	   are not affected. *}
 RETURN  {* The previous cache ratio or a negative number on error. *}
-ALSO    {* bdd\_init *}
+ALSO    {* bdd\_init, bdd\_setopcacheratio *}
 */
 int bdd_setcacheratio(int r)
 {
@@ -310,6 +565,39 @@ int bdd_setcacheratio(int r)
 }
 
 
+/*
+NAME    {* bdd\_setopcacheratio *}
+SECTION {* kernel *}
+SHORT   {* Sets the cache ratio for one of the operator caches *}
+PROTO   {* int bdd_setopcacheratio(int cache, int r) *}
+DESCR   {* Each group of operations has its own cache, identified by
+	   one of {\tt bddcache\_apply}, {\tt bddcache\_ite},
+	   {\tt bddcache\_quant}, {\tt bddcache\_replace},
+	   {\tt bddcache\_misc} and {\tt bddcache\_proof}, the last
+	   holding the results and justifying clauses of the proof
+	   generating operations.  This sets the cache ratio for
+	   {\tt cache} alone, and resizes it instantly.  A ratio of zero
+	   makes the cache follow the one set by
+	   {\tt bdd\_setcacheratio}. *}
+RETURN  {* The previous cache ratio or a negative number on error. *}
+ALSO    {* bdd\_setcacheratio *}
+*/
+int bdd_setopcacheratio(int cache, int r)
+{
+   int old;
+
+   if (cache < 0  ||  cache >= OPCACHE_NUM  ||  r < 0)
+      return bdd_error(BDD_RANGE);
+   old = opcacheratio[cache];
+   if (bddnodesize == 0)
+      return old;
+
+   opcacheratio[cache] = r;
+   bdd_operator_noderesize();
+   return old;
+}
+
+
 /*************************************************************************
   Operators
 *************************************************************************/
@@ -450,17 +738,17 @@ static BDD not_rec(BDD r)
    if (ISONE(r))
       return BDDZERO;
    
-   entry = BddCache_lookup(&opcache, NOTHASH(r));
+   entry = BddCache_lookup(&applycache, NOTHASH(r));
       
-   if (entry->a == r  &&  entry->op == bddop_not)
+   if (entry->a == r  &&  entry->c == bddop_not)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      OPHIT(bddcache_apply);
 #endif
-      return entry->r.res;
+      return entry->res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   OPMISS(bddcache_apply);
 #endif
    
    PUSHREF( not_rec(LOW(r)) );
@@ -468,15 +756,11 @@ static BDD not_rec(BDD r)
    res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
    POPREF(2);
    
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
    entry->a = r;
    entry->b = -1;
-   entry->c = -1;
-   entry->op = bddop_not;
-   entry->r.res = res;
+   entry->c = bddop_not;
+   entry->res = res;
 
    return res;
 }
@@ -542,7 +826,8 @@ BDD bdd_apply(BDD l, BDD r, int op)
       
       if (!firstReorder)
 	 bdd_disable_reorder();
-      res = apply_rec(l, r);
+      if (!bdd_papply(l, r, op, &res))
+	 res = apply_rec(l, r);
       if (!firstReorder)
 	 bdd_enable_reorder();
    }
@@ -560,12 +845,105 @@ BDD bdd_apply(BDD l, BDD r, int op)
 }
 
 
+   /* Operands of the low or high branch of apply_rec or applyj_rec */
+static void apply_split(BDD l, BDD r, int high, BDD *sl, BDD *sr)
+{
+   int level = MIN(LEVEL(l), LEVEL(r));
+
+   *sl = LEVEL(l) != level ? l : high ? HIGH(l) : LOW(l);
+   *sr = LEVEL(r) != level ? r : high ? HIGH(r) : LOW(r);
+}
+
+
+/*
+  Terminal cases and cache hits of apply_rec.  Returns the result, or
+  -1 if the operands must be split
+*/
+static BDD apply_known(BDD l, BDD r)
+{
+   BddCacheData *entry;
+   BDD res;
+
+   if ((res=bdd_apply_terminal(applyop, l, r)) >= 0)
+      return res;
+
+   entry = BddCache_lookup(&applycache, APPLYHASH(l,r,applyop));
+   if (entry->a == l  &&  entry->b == r  &&  entry->c == applyop)
+   {
+#ifdef CACHESTATS
+      OPHIT(bddcache_apply);
+#endif
+      return entry->res;
+   }
+#ifdef CACHESTATS
+   OPMISS(bddcache_apply);
+#endif
+   return -1;
+}
+
+
+/*
+  Apply, using the explicit stack applystack.  Both branches of a
+  node are solved, low first, and their results are kept on the
+  reference stack until the node is made
+*/
 static BDD apply_rec(BDD l, BDD r)
 {
    BddCacheData *entry;
+   BddFrame *f;
    BDD res;
-   
-   switch (applyop)
+   int sp = 0;
+
+   for (;;)
+   {
+	 /* Descend along low branches to a known result */
+      while ((res=apply_known(l, r)) < 0)
+      {
+	 if (!bdd_framestack_reserve(&applystack, &applystackalloc, sp))
+	    return bdd_error(BDD_MEMORY);
+	 f = &applystack[sp++];
+	 f->l = l;
+	 f->r = r;
+	 f->high = 0;
+	 apply_split(l, r, 0, &l, &r);
+      }
+
+	 /* Finish the frames whose high branch is now solved */
+      for (;;)
+      {
+	 if (sp == 0)
+	    return res;
+	 f = &applystack[sp-1];
+	 PUSHREF( res );
+	 if (!f->high)
+	    break;
+
+	 l = f->l;
+	 r = f->r;
+	 res = bdd_makenode(MIN(LEVEL(l), LEVEL(r)), READREF(2), READREF(1));
+	 POPREF(2);
+
+	 entry = BddCache_lookup(&applycache, APPLYHASH(l,r,applyop));
+	 entry->a = l;
+	 entry->b = r;
+	 entry->c = applyop;
+	 entry->res = res;
+	 sp--;
+      }
+
+      f->high = 1;
+      apply_split(f->l, f->r, 1, &l, &r);
+   }
+}
+
+
+/*
+  Result of an apply operation that needs no recursion, or -1.
+  The terminal cases of apply_rec, for the parallel version in papply.c
+*/
+int bdd_apply_terminal(int op, BDD l, BDD r)
+{
+   switch (op)
    {
     case bddop_and:
        if (l == r)
@@ -614,56 +992,8 @@ static BDD apply_rec(BDD l, BDD r)
    }
 
    if (ISCONST(l)  &&  ISCONST(r))
-      res = oprres[applyop][l<<1 | r];
-   else
-   {
-      entry = BddCache_lookup(&opcache, APPLYHASH(l,r,applyop));
-      
-      if (entry->a == l  &&  entry->b == r  &&  entry->op == applyop)
-      {
-#ifdef CACHESTATS
-	 bddcachestats.opHit++;
-#endif
-	 return entry->r.res;
-      }
-#ifdef CACHESTATS
-      bddcachestats.opMiss++;
-#endif
-      
-      if (LEVEL(l) == LEVEL(r))
-      {
-	 PUSHREF( apply_rec(LOW(l), LOW(r)) );
-	 PUSHREF( apply_rec(HIGH(l), HIGH(r)) );
-	 res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
-      }
-      else
-      if (LEVEL(l) < LEVEL(r))
-      {
-	 PUSHREF( apply_rec(LOW(l), r) );
-	 PUSHREF( apply_rec(HIGH(l), r) );
-	 res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
-      }
-      else
-      {
-	 PUSHREF( apply_rec(l, LOW(r)) );
-	 PUSHREF( apply_rec(l, HIGH(r)) );
-	 res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
-      }
-
-      POPREF(2);
-
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
-
-      entry->a = l;
-      entry->b = r;
-      entry->c = -1;
-      entry->op = applyop;
-      entry->r.res = res;
-   }
-
-   return res;
+      return oprres[op][l<<1 | r];
+   return -1;
 }
 
 
@@ -806,6 +1136,15 @@ static pcbdd bdd_applyj(BDD l, BDD r, int op)
       
       if (!firstReorder)
 	 bdd_disable_reorder();
+      if (op == bddop_andj  &&  bdd_pjustify_ready(l, r))
+      {
+	    /* Build the result first, so that the parallel tasks
+	       only need to look up nodes */
+	 applyop = bddop_and;
+	 PUSHREF( apply_rec(l, r) );
+	 applyop = op;
+	 bdd_pjustify(l, r);
+      }
       res = applyj_rec(l, r);
       if (!firstReorder)
 	 bdd_enable_reorder();
@@ -875,301 +1214,353 @@ static pcbdd bdd_apply_aij(BDD l, BDD r, BDD t)
 }
 
 
-static pcbdd applyj_rec(BDD l, BDD r)
+/*
+  Terminal cases and cache hits of applyj_rec.  Returns 1, with the
+  result in tres, if the operands need not be split
+*/
+static int applyj_known(BDD l, BDD r, pcbdd *tres)
 {
    BddCacheData *entry;
-   pcbdd tres;
-   
-   //   printf("applyj_rec called with l=%d (N%d), r=%d (N%d), op = %d\n", (int) l, NNAME(l), (int) r, NNAME(r), applyop);
 
-   tres.root = BDDZERO;
-   tres.clause_id = TAUTOLOGY;
+   tres->root = BDDZERO;
+   tres->clause_id = TAUTOLOGY;
 
    switch (applyop)
    {
     case bddop_andj:
        if (l == r)
-	   { tres.root = l ; return tres; }
+	   { tres->root = l ; return 1; }
        if (ISZERO(l)  ||  ISZERO(r))
-	   { tres.root = 0; return tres; }
+	   { tres->root = 0; return 1; }
        if (ISONE(l))
-	   { tres.root = r; return tres; }
+	   { tres->root = r; return 1; }
        if (ISONE(r))
-	   { tres.root = l; return tres; }
+	   { tres->root = l; return 1; }
        break;
    case bddop_imptstj:
        if (l == r)
-	   { tres.root = BDDONE ; return tres; }
+	   { tres->root = BDDONE ; return 1; }
        if (ISZERO(l))
-	   { tres.root = BDDONE; return tres; }
+	   { tres->root = BDDONE; return 1; }
        if (ISONE(r))
-	   { tres.root = BDDONE; return tres; }
+	   { tres->root = BDDONE; return 1; }
        if (ISONE(l))
 	   /* Implication cannot hold for all arguments */
 	   { 
-	       tres.root = BDDZERO;
+	       tres->root = BDDZERO;
 	       fprintf(stderr, "Implication failure.  N%d -/-> N%d\n", bdd_nameid(l), bdd_nameid(r));
 	       bdd_error(TBDD_PROOF);
-	       return tres;
+	       return 1;
 	   }
        if (ISZERO(r))
 	   /* Implication cannot hold for all arguments */
 	   { 
-	       tres.root = BDDZERO;
+	       tres->root = BDDZERO;
 	       fprintf(stderr, "Implication failure.  N%d -/-> N%d\n", bdd_nameid(l), bdd_nameid(r));
 	       bdd_error(TBDD_PROOF);
-	       return tres;
+	       return 1;
 	   }
        break;
    }
 
-
+   entry = BddCache_lookup_set(&proofcache, APPLYHASH(l,r,applyop), l, PROOFKEY(r,applyop), -1);
+   if (entry != NULL)
    {
-      entry = BddCache_lookup(&opcache, APPLYHASH(l,r,applyop));
-      if (entry->a == l  &&  entry->b == r  &&  entry->op == applyop)
-      {
 #ifdef CACHESTATS
-	 bddcachestats.opHit++;
+      OPHIT(bddcache_proof);
 #endif
-	 tres.root = entry->r.res;
-	 tres.clause_id = entry->r.jclause;
+      tres->root = entry->res;
+      tres->clause_id = entry->jclause;
 #if DO_TRACE
-	 if (tres.clause_id == TRACE_CLAUSE) {
-	     printf("TRACE: Retrieving clause #%d from cache in apply_rec.  Operands = N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r));
-	 }
-	 if (NNAME(tres.root) == TRACE_NNAME) {
-	     printf("TRACE: Retrieving node N%d from cache in apply_rec.  Operands = N%d, N%d\n", TRACE_NNAME, NNAME(l), NNAME(r));
-	 }
-#endif /* DO_TRACE */
-
-	 return tres;
+      if (tres->clause_id == TRACE_CLAUSE) {
+	  printf("TRACE: Retrieving clause #%d from cache in apply_rec.  Operands = N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r));
+      }
+      if (NNAME(tres->root) == TRACE_NNAME) {
+	  printf("TRACE: Retrieving node N%d from cache in apply_rec.  Operands = N%d, N%d\n", TRACE_NNAME, NNAME(l), NNAME(r));
       }
+#endif /* DO_TRACE */
+      return 1;
+   }
 #ifdef CACHESTATS
-      bddcachestats.opMiss++;
+   OPMISS(bddcache_proof);
 #endif
-      
-      pcbdd tresh;
-      pcbdd tresl;
-      int splitVar;
-      int splitLevel;
+   return 0;
+}
 
-      if (LEVEL(l) == LEVEL(r))
-      {
-	  splitLevel = LEVEL(l);
-	  tresl = applyj_rec(LOW(l), LOW(r));
-	  PUSHREF( tresl.root );
-	  tresh = applyj_rec(HIGH(l), HIGH(r));
-	  PUSHREF( tresh.root );
-      }
-      else
-      if (LEVEL(l) < LEVEL(r))
-      {
-	  splitLevel = LEVEL(l);
-	  tresl = applyj_rec(LOW(l), r);
-	  PUSHREF( tresl.root );
-	  tresh = applyj_rec(HIGH(l), r);
-	  PUSHREF( tresh.root );
-      }
-      else
-      {
-	  splitLevel = LEVEL(r);
-	  tresl =  applyj_rec(l, LOW(r));
-	  PUSHREF( tresl.root );
-	  tresh = applyj_rec(l, HIGH(r));
-	  PUSHREF( tresh.root );
-      }
-      splitVar = bdd_level2var(splitLevel);
-      if (applyop == bddop_imptstj)
-	  tres.root = ISONE(tresl.root) && ISONE(tresh.root) ? BDDONE : BDDZERO;
-      else 
-	  tres.root = bdd_makenode(splitLevel, READREF(2), READREF(1));
-      tres.clause_id = justify_apply(applyop, l, r, splitVar, tresl, tresh, tres.root);
+
+/*
+  Combine the results of both branches of applyj_rec, which are also
+  the top two entries of the reference stack
+*/
+static pcbdd applyj_finish(BDD l, BDD r, pcbdd tresl, pcbdd tresh)
+{
+   BddCacheData *entry;
+   pcbdd tres;
+   int splitLevel = MIN(LEVEL(l), LEVEL(r));
+   int splitVar = bdd_level2var(splitLevel);
+
+   if (applyop == bddop_imptstj)
+      tres.root = ISONE(tresl.root) && ISONE(tresh.root) ? BDDONE : BDDZERO;
+   else 
+      tres.root = bdd_makenode(splitLevel, READREF(2), READREF(1));
+   tres.clause_id = justify_apply(applyop, l, r, splitVar, tresl, tresh, tres.root);
 
 #if DO_TRACE
-      if (tresh.clause_id == TRACE_CLAUSE) {
-	  printf("TRACE: Got clause #%d from apply_rec as high result.  Operands = N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r));
-      }
-      if (tresl.clause_id == TRACE_CLAUSE) {
-	  printf("TRACE: Got clause #%d from apply_rec as low result.  Operands = N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r));
-      }
+   if (tresh.clause_id == TRACE_CLAUSE) {
+      printf("TRACE: Got clause #%d from apply_rec as high result.  Operands = N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r));
+   }
+   if (tresl.clause_id == TRACE_CLAUSE) {
+      printf("TRACE: Got clause #%d from apply_rec as low result.  Operands = N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r));
+   }
 #endif /* DO_TRACE */
 
+   POPREF(2);
 
-      POPREF(2);
-
-      BddCache_clause_evict(entry);
-      entry->a = l;
-      entry->b = r;
-      entry->c = -1;
-      entry->op = applyop;
-      entry->r.res = tres.root;
-      entry->r.jclause = tres.clause_id;
+   entry = BddCache_insert_set(&proofcache, APPLYHASH(l,r,applyop));
+   entry->a = l;
+   entry->b = PROOFKEY(r,applyop);
+   entry->res = tres.root;
+   entry->jclause = tres.clause_id;
 #if DO_TRACE
-      if (tres.clause_id == TRACE_CLAUSE) {
-	  printf("TRACE: Adding clause #%d to cache.  Operands = N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r));
+   if (tres.clause_id == TRACE_CLAUSE) {
+      printf("TRACE: Adding clause #%d to cache.  Operands = N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r));
+   }
+   if (NNAME(tres.root) == TRACE_NNAME) {
+      printf("TRACE: Adding operation with result node N%d to cache.  Operands = N%d, N%d\n", TRACE_NNAME, NNAME(l), NNAME(r));
+   }
+#endif /* DO_TRACE */
+   return tres;
+}
+
+
+/*
+  Apply with proof, using the explicit stack jstack.  Both branches
+  of a node are solved, low first, before the node is justified, as
+  in a recursion
+*/
+static pcbdd applyj_rec(BDD l, BDD r)
+{
+   BddFrame *f;
+   pcbdd tres;
+   int sp = 0;
+
+   for (;;)
+   {
+	 /* Descend along low branches to a known result */
+      while (!applyj_known(l, r, &tres))
+      {
+	 if (!bdd_framestack_reserve(&jstack, &jstackalloc, sp))
+	 {
+	    bdd_error(BDD_MEMORY);
+	    return pcbdd_null();
+	 }
+	 f = &jstack[sp++];
+	 f->l = l;
+	 f->r = r;
+	 f->high = 0;
+	 apply_split(f->l, f->r, 0, &l, &r);
       }
-      if (NNAME(tres.root) == TRACE_NNAME) {
-	  printf("TRACE: Adding operation with result node N%d to cache.  Operands = N%d, N%d\n", TRACE_NNAME, NNAME(l), NNAME(r));
+
+	 /* Finish the frames whose high branch is now solved */
+      for (;;)
+      {
+	 if (sp == 0)
+	    return tres;
+	 f = &jstack[sp-1];
+	 PUSHREF( tres.root );
+	 if (!f->high)
+	    break;
+	 tres = applyj_finish(f->l, f->r, f->tresl, tres);
+	 sp--;
       }
-#endif /* DO_TRACE */
+
+      f->tresl = tres;
+      f->high = 1;
+      apply_split(f->l, f->r, 1, &l, &r);
    }
+}
 
-   return tres;
+/*
+  Access to the entries for conjunction, for bdd_pjustify.  Several
+  threads may call bdd_proofcache_find at once, since it leaves the
+  cache unchanged.
+*/
+int bdd_proofcache_find(BDD l, BDD r, pcbdd *res)
+{
+   BddCacheData *entry;
+
+   entry = BddCache_find_set(&proofcache, APPLYHASH(l,r,bddop_andj), l, PROOFKEY(r,bddop_andj), -1);
+   if (entry == NULL)
+      return 0;
+   res->root = entry->res;
+   res->clause_id = entry->jclause;
+   return 1;
 }
 
-static pcbdd apply_aij_rec(BDD l, BDD r, BDD t)
+
+void bdd_proofcache_insert(BDD l, BDD r, pcbdd res)
+{
+   BddCacheData *entry;
+
+   entry = BddCache_insert_set(&proofcache, APPLYHASH(l,r,bddop_andj));
+   entry->a = l;
+   entry->b = PROOFKEY(r,bddop_andj);
+   entry->res = res.root;
+   entry->jclause = res.clause_id;
+}
+
+
+/*
+  Terminal cases and cache hits of apply_aij_rec.  Returns 1, with
+  the result in tres, if the operands need not be split.  Some cases
+  degenerate to implication checks by applyj_rec
+*/
+static int apply_aij_known(BDD l, BDD r, BDD t, pcbdd *tres)
 {
    BddCacheData *entry;
-   pcbdd tres;
-   
-   //   printf("apply_aij_rec called with l=%d (N%d), r=%d (N%d), t = %d (N%d)\n", (int) l, NNAME(l), (int) r, NNAME(r), int(t), NNAME(t));
 
-   tres.root = BDDONE;
-   tres.clause_id = TAUTOLOGY;
+   tres->root = BDDONE;
+   tres->clause_id = TAUTOLOGY;
 
    /* Terminal cases */
    if (ISZERO(l)  ||  ISZERO(r))
-       return tres;
+       return 1;
    if (ISONE(l))
        /* Implication */
-       return applyj_rec(r, t);
+       { *tres = applyj_rec(r, t); return 1; }
    if (ISONE(r))
        /* Implication */
-       return applyj_rec(l, t);
+       { *tres = applyj_rec(l, t); return 1; }
    if (l == r)
        /* Implication */
-       return applyj_rec(l, t);
+       { *tres = applyj_rec(l, t); return 1; }
    if (ISONE(t))
-       return tres;
+       return 1;
+
+   entry = BddCache_lookup_set(&proofcache, APPLYHASH(l,r,t), l, PROOFKEY(r,bddop_andimptstj), t);
+   if (entry != NULL)
    {
-      entry = BddCache_lookup(&opcache, APPLYHASH(l,r,t));
-      if (entry->a == l  &&  entry->b == r  &&  entry->c == t && entry->op == bddop_andimptstj)
-      {
 #ifdef CACHESTATS
-	 bddcachestats.opHit++;
+      OPHIT(bddcache_proof);
 #endif
-	 tres.root = entry->r.res;
-	 tres.clause_id = entry->r.jclause;
+      tres->root = (entry->b & PROOF_RESBIT) ? BDDONE : BDDZERO;
+      tres->clause_id = entry->jclause;
 #if DO_TRACE
-	 if (tres.clause_id == TRACE_CLAUSE) {
-	     printf("TRACE: Retrieving clause #%d from cache in apply_aij_rec.  Operands = N%d, N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r), NNAME(t));
-	 }
-	 if (NNAME(tres.root) == TRACE_NNAME) {
-	     printf("TRACE: Retrieving node N%d from cache in apply_aij_rec.  Operands = N%d, N%d\n", N%d, TRACE_NNAME, NNAME(l), NNAME(r), NNAME(t));
-	 }
-#endif /* DO_TRACE */
-
-	 return tres;
+      if (tres->clause_id == TRACE_CLAUSE) {
+	  printf("TRACE: Retrieving clause #%d from cache in apply_aij_rec.  Operands = N%d, N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r), NNAME(t));
       }
+      if (NNAME(tres->root) == TRACE_NNAME) {
+	  printf("TRACE: Retrieving node N%d from cache in apply_aij_rec.  Operands = N%d, N%d, N%d\n", TRACE_NNAME, NNAME(l), NNAME(r), NNAME(t));
+      }
+#endif /* DO_TRACE */
+      return 1;
+   }
 #ifdef CACHESTATS
-      bddcachestats.opMiss++;
+   OPMISS(bddcache_proof);
 #endif
-      
-      pcbdd tresh;
-      pcbdd tresl;
-      int splitVar;
-      int splitLevel;
+   return 0;
+}
 
-      if (LEVEL(l) == LEVEL(r))
-      {
-	  if (LEVEL(t) < LEVEL(l)) {
-	      splitLevel = LEVEL(t);
-	      tresl = apply_aij_rec(l, r, LOW(t));
-	      PUSHREF( tresl.root );
-	      tresh = apply_aij_rec(l, r, HIGH(t));
-	      PUSHREF( tresh.root );
-	  } else if (LEVEL(t) == LEVEL(l)) {
-	      splitLevel = LEVEL(l);
-	      tresl = apply_aij_rec(LOW(l), LOW(r), LOW(t));
-	      PUSHREF( tresl.root );
-	      tresh = apply_aij_rec(HIGH(l), HIGH(r), HIGH(t));
-	      PUSHREF( tresh.root );
-	  } else {
-	      splitLevel = LEVEL(l);
-	      tresl = apply_aij_rec(LOW(l), LOW(r), t);
-	      PUSHREF( tresl.root );
-	      tresh = apply_aij_rec(HIGH(l), HIGH(r), t);
-	      PUSHREF( tresh.root );
-	  }
-      } else if (LEVEL(l) < LEVEL(r))
-      {
-	  if (LEVEL(t) < LEVEL(l)) {
-	      splitLevel = LEVEL(t);
-	      tresl = apply_aij_rec(l, r, LOW(t));
-	      PUSHREF( tresl.root );
-	      tresh = apply_aij_rec(l, r, HIGH(t));
-	      PUSHREF( tresh.root );
-	  } else if (LEVEL(t) == LEVEL(l)) {
-	      splitLevel = LEVEL(l);
-	      tresl = apply_aij_rec(LOW(l), r, LOW(t));
-	      PUSHREF( tresl.root );
-	      tresh = apply_aij_rec(HIGH(l), r, HIGH(t));
-	      PUSHREF( tresh.root );
-	  } else {
-	      splitLevel = LEVEL(l);
-	      tresl = apply_aij_rec(LOW(l), r, t);
-	      PUSHREF( tresl.root );
-	      tresh = apply_aij_rec(HIGH(l), r, t);
-	      PUSHREF( tresh.root );
-	  }
-      } else
-      {
-	  if (LEVEL(t) < LEVEL(r)) {
-	      splitLevel = LEVEL(t);
-	      tresl = apply_aij_rec(l, r, LOW(t));
-	      PUSHREF( tresl.root );
-	      tresh = apply_aij_rec(l, r, HIGH(t));
-	      PUSHREF( tresh.root );
-	  } else if (LEVEL(t) == LEVEL(r)) {
-	      splitLevel = LEVEL(r);
-	      tresl =  apply_aij_rec(l, LOW(r), LOW(t));
-	      PUSHREF( tresl.root );
-	      tresh = apply_aij_rec(l, HIGH(r), HIGH(t));
-	      PUSHREF( tresh.root );
-	  } else {
-	      splitLevel = LEVEL(r);
-	      tresl =  apply_aij_rec(l, LOW(r), t);
-	      PUSHREF( tresl.root );
-	      tresh = apply_aij_rec(l, HIGH(r), t);
-	      PUSHREF( tresh.root );
-	  }
-      }
-      splitVar = bdd_level2var(splitLevel);
-      tres.root = ISONE(tresl.root) && ISONE(tresh.root) ? BDDONE : BDDZERO;
-      //      printf("Attempting to justify AIJ.  Operands = N%d, N%d, N%d.  Var = %d\n", NNAME(l), NNAME(r), NNAME(t), splitVar);
-      //      printf("   Recursive results give clauses tresl:%d, tresh:%d\n", tresl.clause_id, tresh.clause_id);
-      tres.clause_id = justify_apply(bddop_andj, l, r, splitVar, tresl, tresh, t);
+
+   /* Operands of the low or high branch of apply_aij_rec.  The
+      operands at the topmost level are split */
+static void apply_aij_split(BDD l, BDD r, BDD t, int high, BDD *sl, BDD *sr, BDD *st)
+{
+   int level = MIN(MIN(LEVEL(l), LEVEL(r)), LEVEL(t));
+
+   *sl = LEVEL(l) != level ? l : high ? HIGH(l) : LOW(l);
+   *sr = LEVEL(r) != level ? r : high ? HIGH(r) : LOW(r);
+   *st = LEVEL(t) != level ? t : high ? HIGH(t) : LOW(t);
+}
+
+
+/*
+  Combine the results of both branches of apply_aij_rec, which are
+  also the top two entries of the reference stack
+*/
+static pcbdd apply_aij_finish(BDD l, BDD r, BDD t, pcbdd tresl, pcbdd tresh)
+{
+   BddCacheData *entry;
+   pcbdd tres;
+   int splitLevel = MIN(MIN(LEVEL(l), LEVEL(r)), LEVEL(t));
+   int splitVar = bdd_level2var(splitLevel);
+
+   tres.root = ISONE(tresl.root) && ISONE(tresh.root) ? BDDONE : BDDZERO;
+   tres.clause_id = justify_apply(bddop_andj, l, r, splitVar, tresl, tresh, t);
 
 #if DO_TRACE
-      if (tresh.clause_id == TRACE_CLAUSE) {
-	  printf("TRACE: Got clause #%d from apply_aij_rec as high result.  Operands = N%d, N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r), NNAME(t));
-      }
-      if (tresl.clause_id == TRACE_CLAUSE) {
-	  printf("TRACE: Got clause #%d from apply_aij_rec as low result.  Operands = N%d, N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r), NNAME(t)));
-      }
+   if (tresh.clause_id == TRACE_CLAUSE) {
+      printf("TRACE: Got clause #%d from apply_aij_rec as high result.  Operands = N%d, N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r), NNAME(t));
+   }
+   if (tresl.clause_id == TRACE_CLAUSE) {
+      printf("TRACE: Got clause #%d from apply_aij_rec as low result.  Operands = N%d, N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r), NNAME(t));
+   }
 #endif /* DO_TRACE */
 
+   POPREF(2);
 
-      POPREF(2);
-
-      BddCache_clause_evict(entry);
-      entry->a = l;
-      entry->b = r;
-      entry->c = t;
-      entry->op = bddop_andimptstj;
-      entry->r.res = tres.root;
-      entry->r.jclause = tres.clause_id;
+   entry = BddCache_insert_set(&proofcache, APPLYHASH(l,r,t));
+   entry->a = l;
+   entry->b = PROOFKEY(r,bddop_andimptstj) | (ISONE(tres.root) ? PROOF_RESBIT : 0);
+   entry->res = t;
+   entry->jclause = tres.clause_id;
 #if DO_TRACE
-      if (tres.clause_id == TRACE_CLAUSE) {
-	  printf("TRACE: Adding clause #%d to cache.  Operands = N%d, N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r), NNAME(t));
+   if (tres.clause_id == TRACE_CLAUSE) {
+      printf("TRACE: Adding clause #%d to cache.  Operands = N%d, N%d, N%d\n", TRACE_CLAUSE, NNAME(l), NNAME(r), NNAME(t));
+   }
+   if (NNAME(tres.root) == TRACE_NNAME) {
+      printf("TRACE: Adding operation with result node N%d to cache.  Operands = N%d, N%d, N%d\n", TRACE_NNAME, NNAME(l), NNAME(r), NNAME(t));
+   }
+#endif /* DO_TRACE */
+   return tres;
+}
+
+
+/*
+  Proof that l & r implies t, using the explicit stack aijstack in the
+  same way as applyj_rec
+*/
+static pcbdd apply_aij_rec(BDD l, BDD r, BDD t)
+{
+   BddFrame *f;
+   pcbdd tres;
+   int sp = 0;
+
+   for (;;)
+   {
+	 /* Descend along low branches to a known result */
+      while (!apply_aij_known(l, r, t, &tres))
+      {
+	 if (!bdd_framestack_reserve(&aijstack, &aijstackalloc, sp))
+	 {
+	    bdd_error(BDD_MEMORY);
+	    return pcbdd_null();
+	 }
+	 f = &aijstack[sp++];
+	 f->l = l;
+	 f->r = r;
+	 f->t = t;
+	 f->high = 0;
+	 apply_aij_split(f->l, f->r, f->t, 0, &l, &r, &t);
       }
-      if (NNAME(tres.root) == TRACE_NNAME) {
-	  printf("TRACE: Adding operation with result node N%d to cache.  Operands = N%d, N%d, N%d\n", TRACE_NNAME, NNAME(l), NNAME(r), NNAME(t));
+
+	 /* Finish the frames whose high branch is now solved */
+      for (;;)
+      {
+	 if (sp == 0)
+	    return tres;
+	 f = &aijstack[sp-1];
+	 PUSHREF( tres.root );
+	 if (!f->high)
+	    break;
+	 tres = apply_aij_finish(f->l, f->r, f->t, f->tresl, tres);
+	 sp--;
       }
-#endif /* DO_TRACE */
-   }
 
-   return tres;
+      f->tresl = tres;
+      f->high = 1;
+      apply_aij_split(f->l, f->r, f->t, 1, &l, &r, &t);
+   }
 }
 
 
@@ -1285,16 +1676,16 @@ static BDD ite_rec(BDD f, BDD g, BDD h)
    if (ISZERO(g) && ISONE(h))
       return not_rec(f);
 
-   entry = BddCache_lookup(&opcache, ITEHASH(f,g,h));
-   if (entry->a == f  &&  entry->b == g  &&  entry->c == h && entry->op == bddop_ite)
+   entry = BddCache_lookup(&itecache, ITEHASH(f,g,h));
+   if (entry->a == f  &&  entry->b == g  &&  entry->c == h)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      OPHIT(bddcache_ite);
 #endif
-      return entry->r.res;
+      return entry->res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   OPMISS(bddcache_ite);
 #endif
       
    if (LEVEL(f) == LEVEL(g))
@@ -1367,15 +1758,11 @@ static BDD ite_rec(BDD f, BDD g, BDD h)
 
    POPREF(2);
 
-#if ENABLE_TBDD
-   BddCache_clause_evict(entry);
-#endif      
 
    entry->a = f;
    entry->b = g;
    entry->c = h;
-   entry->op = bddop_ite;
-   entry->r.res = res;
+   entry->res = res;
 
    return res;
 }
@@ -1451,22 +1838,22 @@ BDD bdd_restrict(BDD r, BDD var)
 
 static int restrict_rec(int r)
 {
-   BddCacheData *entry;
+   BddCacheWide *entry;
    int res;
    
    if (ISCONST(r)  ||  LEVEL(r) > quantlast)
       return r;
 
-   entry = BddCache_lookup(&opcache, RESTRHASH(r,miscid));
-   if (entry->a == r  &&  entry->c == miscid && entry->op == bddop_misc)
+   entry = BddCache_lookup_wide(&misccache, RESTRHASH(r,miscid));
+   if (entry->a == r  &&  entry->c == miscid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      OPHIT(bddcache_misc);
 #endif
       return entry->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   OPMISS(bddcache_misc);
 #endif
    
    if (INSVARSET(LEVEL(r)))
@@ -1484,14 +1871,10 @@ static int restrict_rec(int r)
       POPREF(2);
    }
 
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
    entry->a = r;
    entry->b = -1;
    entry->c = miscid;
-   entry->op = bddop_misc;
    entry->r.res = res;
 
    return res;
@@ -1546,7 +1929,7 @@ BDD bdd_constrain(BDD f, BDD c)
 
 static BDD constrain_rec(BDD f, BDD c)
 {
-   BddCacheData *entry;
+   BddCacheWide *entry;
    BDD res;
 
    if (ISONE(c))
@@ -1558,16 +1941,16 @@ static BDD constrain_rec(BDD f, BDD c)
    if (ISZERO(c))
       return BDDZERO;
 
-   entry = BddCache_lookup(&opcache, CONSTRAINHASH(f,c));
-   if (entry->a == f  &&  entry->b == c  &&  entry->c == miscid && entry->op == bddop_misc)
+   entry = BddCache_lookup_wide(&misccache, CONSTRAINHASH(f,c));
+   if (entry->a == f  &&  entry->b == c  &&  entry->c == miscid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      OPHIT(bddcache_misc);
 #endif
       return entry->r.res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   OPMISS(bddcache_misc);
 #endif
 
    if (LEVEL(f) == LEVEL(c))
@@ -1607,15 +1990,11 @@ static BDD constrain_rec(BDD f, BDD c)
       }
    }
 
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
 
    entry->a = f;
    entry->b = c;
    entry->c = miscid;
-   entry->op = bddop_misc;
    entry->r.res = res;
 
    return res;
@@ -1680,16 +2059,16 @@ static BDD replace_rec(BDD r)
    if (ISCONST(r)  ||  LEVEL(r) > replacelast)
       return r;
 
-   entry = BddCache_lookup(&opcache, REPLACEHASH(r));
-   if (entry->a == r  &&  entry->c == replaceid && entry->op == bddop_replace)
+   entry = BddCache_lookup(&replacecache, REPLACEHASH(r));
+   if (entry->a == r  &&  entry->c == replaceid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      OPHIT(bddcache_replace);
 #endif
-      return entry->r.res;
+      return entry->res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   OPMISS(bddcache_replace);
 #endif
 
    PUSHREF( replace_rec(LOW(r)) );
@@ -1698,16 +2077,12 @@ static BDD replace_rec(BDD r)
    res = bdd_correctify(LEVEL(replacepair[LEVEL(r)]), READREF(2), READREF(1));
    POPREF(2);
 
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
 
    entry->a = r;
    entry->b = -1;
    entry->c = replaceid;
-   entry->op = bddop_replace;
-   entry->r.res = res;
+   entry->res = res;
 
    return res;
 }
@@ -1811,16 +2186,16 @@ static BDD compose_rec(BDD f, BDD g)
    if (LEVEL(f) > composelevel)
       return f;
 
-   entry = BddCache_lookup(&opcache, COMPOSEHASH(f,g));
-   if (entry->a == f  &&  entry->b == g  &&  entry->c == replaceid && entry->op == bddop_replace)
+   entry = BddCache_lookup(&replacecache, COMPOSEHASH(f,g));
+   if (entry->a == f  &&  entry->b == g  &&  entry->c == replaceid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      OPHIT(bddcache_replace);
 #endif
-      return entry->r.res;
+      return entry->res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   OPMISS(bddcache_replace);
 #endif
 
    if (LEVEL(f) < composelevel)
@@ -1852,16 +2227,12 @@ static BDD compose_rec(BDD f, BDD g)
       res = ite_rec(g, HIGH(f), LOW(f));
    }
 
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
 
    entry->a = f;
    entry->b = g;
    entry->c = replaceid;
-   entry->op = bddop_replace;
-   entry->r.res = res;
+   entry->res = res;
 
    return res;
 }
@@ -1930,16 +2301,16 @@ static BDD veccompose_rec(BDD f)
    if (LEVEL(f) > replacelast)
       return f;
    
-   entry = BddCache_lookup(&opcache, VECCOMPOSEHASH(f));
-   if (entry->a == f  &&  entry->c == replaceid && entry->op == bddop_replace)
+   entry = BddCache_lookup(&replacecache, VECCOMPOSEHASH(f));
+   if (entry->a == f  &&  entry->c == replaceid)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      OPHIT(bddcache_replace);
 #endif
-      return entry->r.res;
+      return entry->res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   OPMISS(bddcache_replace);
 #endif
 
    PUSHREF( veccompose_rec(LOW(f)) );
@@ -1947,16 +2318,12 @@ static BDD veccompose_rec(BDD f)
    res = ite_rec(replacepair[LEVEL(f)], READREF(1), READREF(2));
    POPREF(2);
 
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
 
    entry->a = f;
    entry->b = -1;
    entry->c = replaceid;
-   entry->op = bddop_replace;
-   entry->r.res = res;
+   entry->res = res;
 
    return res;
 }
@@ -2022,17 +2389,17 @@ static BDD simplify_rec(BDD f, BDD d)
    if (ISZERO(d))
       return BDDZERO;
 
-   entry = BddCache_lookup(&opcache, APPLYHASH(f,d,bddop_simplify));
+   entry = BddCache_lookup(&applycache, APPLYHASH(f,d,bddop_simplify));
    
-   if (entry->a == f  &&  entry->b == d  &&  entry->op == bddop_simplify)
+   if (entry->a == f  &&  entry->b == d  &&  entry->c == bddop_simplify)
    {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+      OPHIT(bddcache_apply);
 #endif
-      return entry->r.res;
+      return entry->res;
    }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+   OPMISS(bddcache_apply);
 #endif
    
    if (LEVEL(f) == LEVEL(d))
@@ -2065,15 +2432,11 @@ static BDD simplify_rec(BDD f, BDD d)
       POPREF(1);
    }
 
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
    entry->a = f;
    entry->b = d;
-   entry->c = -1;
-   entry->op = bddop_simplify;
-   entry->r.res = res;
+   entry->c = bddop_simplify;
+   entry->res = res;
 
    return res;
 }
@@ -2237,47 +2600,79 @@ BDD bdd_unique(BDD r, BDD var)
 }
 
 
+/*
+  Quantification, using the explicit stack quantstack.  Both
+  branches of a node are quantified, low first, and their results
+  are kept on the reference stack until the node is finished
+*/
 static int quant_rec(int r)
 {
    BddCacheData *entry;
+   BddFrame *f;
    int res;
-   
-   if (r < 2  ||  LEVEL(r) > quantlast)
-      return r;
+   int sp = 0;
 
-   entry = BddCache_lookup(&opcache, QUANTHASH(r));
-   if (entry->a == r  &&  entry->c == quantid && entry->op == bddop_quant)
+   for (;;)
    {
+	 /* Descend along low branches to a known result */
+      for (;;)
+      {
+	 if (r < 2  ||  LEVEL(r) > quantlast)
+	 {
+	    res = r;
+	    break;
+	 }
+
+	 entry = BddCache_lookup(&quantcache, QUANTHASH(r));
+	 if (entry->a == r  &&  entry->c == quantid)
+	 {
 #ifdef CACHESTATS
-      bddcachestats.opHit++;
+	    OPHIT(bddcache_quant);
 #endif
-      return entry->r.res;
-   }
+	    res = entry->res;
+	    break;
+	 }
 #ifdef CACHESTATS
-   bddcachestats.opMiss++;
+	 OPMISS(bddcache_quant);
 #endif
 
-   PUSHREF( quant_rec(LOW(r)) );
-   PUSHREF( quant_rec(HIGH(r)) );
-   
-   if (INVARSET(LEVEL(r)))
-      res = apply_rec(READREF(2), READREF(1));
-   else
-      res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
+	 if (!bdd_framestack_reserve(&quantstack, &quantstackalloc, sp))
+	    return bdd_error(BDD_MEMORY);
+	 f = &quantstack[sp++];
+	 f->l = r;
+	 f->high = 0;
+	 r = LOW(r);
+      }
 
-   POPREF(2);
-   
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
+	 /* Finish the frames whose high branch is now quantified */
+      for (;;)
+      {
+	 if (sp == 0)
+	    return res;
+	 f = &quantstack[sp-1];
+	 PUSHREF( res );
+	 if (!f->high)
+	    break;
+
+	 r = f->l;
+	 if (INVARSET(LEVEL(r)))
+	    res = apply_rec(READREF(2), READREF(1));
+	 else
+	    res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
 
-   entry->a = r;
-   entry->b = -1;
-   entry->c = quantid;
-   entry->op = bddop_quant;
-   entry->r.res = res;
+	 POPREF(2);
 
-   return res;
+	 entry = BddCache_lookup(&quantcache, QUANTHASH(r));
+	 entry->a = r;
+	 entry->b = -1;
+	 entry->c = quantid;
+	 entry->res = res;
+	 sp--;
+      }
+
+      f->high = 1;
+      r = HIGH(f->l);
+   }
 }
 
 
@@ -2540,16 +2935,16 @@ static int appquant_rec(int l, int r)
    }
    else
    {
-      entry = BddCache_lookup(&opcache, APPEXHASH(l,r,appexop));
-      if (entry->a == l  &&  entry->b == r  &&  entry->c == appexid && entry->op == bddop_appex)
+      entry = BddCache_lookup(&quantcache, APPEXHASH(l,r,appexop));
+      if (entry->a == l  &&  entry->b == r  &&  entry->c == appexid)
       {
 #ifdef CACHESTATS
-	 bddcachestats.opHit++;
+	 OPHIT(bddcache_quant);
 #endif
-	 return entry->r.res;
+	 return entry->res;
       }
 #ifdef CACHESTATS
-      bddcachestats.opMiss++;
+      OPMISS(bddcache_quant);
 #endif
 
       if (LEVEL(l) == LEVEL(r))
@@ -2583,15 +2978,11 @@ static int appquant_rec(int l, int r)
 
       POPREF(2);
       
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
       entry->a = l;
       entry->b = r;
       entry->c = appexid;
-      entry->op = bddop_appex;
-      entry->r.res = res;
+      entry->res = res;
    }
 
    return res;
@@ -2616,7 +3007,6 @@ RETURN  {* A BDD variable set. *}
 */
 BDD bdd_support(BDD r)
 {
-   static int  supportSize = 0;
    int n;
    int res=1;
 
@@ -2683,7 +3073,7 @@ static void support_rec(int r, int* support)
       return;
 
    node = &bddnodes[r];
-   if (LEVELp(node) & MARKON  ||  LOWp(node) == -1)
+   if (MARKEDp(node)  ||  LOWp(node) == -1)
       return;
 
    support[LEVELp(node)] = supportID;
@@ -2691,7 +3081,7 @@ static void support_rec(int r, int* support)
    if (LEVELp(node) > supportMax)
      supportMax = LEVELp(node);
    
-   LEVELp(node) |= MARKON;
+   SETMARKp(node);
    
    support_rec(LOWp(node), support);
    support_rec(HIGHp(node), support);
@@ -3053,15 +3443,15 @@ double bdd_satcountset(BDD r, BDD varset)
 
 static double satcount_rec(int root)
 {
-   BddCacheData *entry;
+   BddCacheWide *entry;
    BddNode *node;
    double size, s;
    
    if (root < 2)
       return root;
 
-   entry = BddCache_lookup(&opcache, SATCOUHASH(root));
-   if (entry->a == root  &&  entry->c == miscid && entry->op == bddop_misc)
+   entry = BddCache_lookup_wide(&misccache, SATCOUHASH(root));
+   if (entry->a == root  &&  entry->c == miscid)
       return entry->r.dres;
 
    node = &bddnodes[root];
@@ -3075,14 +3465,10 @@ static double satcount_rec(int root)
    s *= pow(2.0, (float)(LEVEL(HIGHp(node)) - LEVELp(node) - 1));
    size += s * satcount_rec(HIGHp(node));
 
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
    entry->a = root;
    entry->b = -1;
    entry->c = miscid;
-   entry->op = bddop_misc;
    entry->r.dres = size;
    
    return size;
@@ -3143,7 +3529,7 @@ double bdd_satcountlnset(BDD r, BDD varset)
 
 static double satcountln_rec(int root)
 {
-   BddCacheData *entry;
+   BddCacheWide *entry;
    BddNode *node;
    double size, s1,s2;
    
@@ -3152,8 +3538,8 @@ static double satcountln_rec(int root)
    if (root == 1)
       return 0.0;
 
-   entry = BddCache_lookup(&opcache, SATCOUHASH(root));
-   if (entry->a == root  &&  entry->c == miscid && entry->op == bddop_misc)
+   entry = BddCache_lookup_wide(&misccache, SATCOUHASH(root));
+   if (entry->a == root  &&  entry->c == miscid)
       return entry->r.dres;
 
    node = &bddnodes[root];
@@ -3175,14 +3561,10 @@ static double satcountln_rec(int root)
    else
       size = s1 + log1p(pow(2.0,s2-s1)) / M_LN2;
    
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
    entry->a = root;
    entry->b = -1;
    entry->c = miscid;
-   entry->op = bddop_misc;
    entry->r.dres = size;
    
    return size;
@@ -3281,11 +3663,11 @@ static void varprofile_rec(int r)
       return;
 
    node = &bddnodes[r];
-   if (LEVELp(node) & MARKON)
+   if (MARKEDp(node))
       return;
 
    varprofile[bddlevel2var[LEVELp(node)]]++;
-   LEVELp(node) |= MARKON;
+   SETMARKp(node);
    
    varprofile_rec(LOWp(node));
    varprofile_rec(HIGHp(node));
@@ -3316,7 +3698,7 @@ double bdd_pathcount(BDD r)
 
 static double bdd_pathcount_rec(BDD r)
 {
-   BddCacheData *entry;
+   BddCacheWide *entry;
    double size;
 
    if (ISZERO(r))
@@ -3324,20 +3706,16 @@ static double bdd_pathcount_rec(BDD r)
    if (ISONE(r))
       return 1.0;
 
-   entry = BddCache_lookup(&opcache, PATHCOUHASH(r));
-   if (entry->a == r  &&  entry->c == miscid && entry->op == bddop_misc)
+   entry = BddCache_lookup_wide(&misccache, PATHCOUHASH(r));
+   if (entry->a == r  &&  entry->c == miscid)
       return entry->r.dres;
 
    size = bdd_pathcount_rec(LOW(r)) + bdd_pathcount_rec(HIGH(r));
 
-#if ENABLE_TBDD
-      BddCache_clause_evict(entry);
-#endif      
 
    entry->a = r;
    entry->b = -1;
    entry->c = miscid;
-   entry->op = bddop_misc;
    entry->r.dres = size;
    
    return size;
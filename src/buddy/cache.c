@@ -66,6 +66,7 @@
   DATE:  (C) june 1997
 *************************************************************************/
 #include <stdlib.h>
+#include <string.h>
 #include "kernel.h"
 #include "cache.h"
 #include "prime.h"
@@ -73,74 +74,181 @@
 /*************************************************************************
 *************************************************************************/
 
-int BddCache_init(BddCache *cache, int size)
+static int BddCache_alloc(BddCache *cache, int size)
 {
-   int n;
-
    size = bdd_prime_gte(size);
    
-   if ((cache->table=NEW(BddCacheData,size)) == NULL)
+   if (cache->wide)
+   {
+      if ((cache->wtable=(BddCacheWide*)VMRESIZE(NULL,BddCacheWide,0,size)) == NULL)
+	 return bdd_error(BDD_MEMORY);
+   }
+   else if ((cache->table=(BddCacheData*)VMRESIZE(NULL,BddCacheData,0,size)) == NULL)
       return bdd_error(BDD_MEMORY);
    
-   for (n=0 ; n<size ; n++)
-      cache->table[n].a = -1;
    cache->tablesize = size;
+   cache->setcount = size / CACHE_WAYS;
+   BddCache_reset(cache);
    
    return 0;
 }
 
 
+static void BddCache_free(BddCache *cache)
+{
+   if (cache->wide)
+      VMFREE(cache->wtable, BddCacheWide, cache->tablesize);
+   else
+      VMFREE(cache->table, BddCacheData, cache->tablesize);
+}
+
+
+int BddCache_init(BddCache *cache, int size)
+{
+   cache->wide = 0;
+   return BddCache_alloc(cache, size);
+}
+
+
+int BddCache_init_wide(BddCache *cache, int size)
+{
+   cache->wide = 1;
+   return BddCache_alloc(cache, size);
+}
+
+
 void BddCache_done(BddCache *cache)
 {
-   free(cache->table);
+   BddCache_free(cache);
    cache->table = NULL;
    cache->tablesize = 0;
+   cache->setcount = 0;
 }
 
 
 int BddCache_resize(BddCache *cache, int newsize)
 {
-   int n;
-
-   free(cache->table);
-
-   newsize = bdd_prime_gte(newsize);
-   
-   if ((cache->table=NEW(BddCacheData,newsize)) == NULL)
-      return bdd_error(BDD_MEMORY);
-   
-   for (n=0 ; n<newsize ; n++)
-      cache->table[n].a = -1;
-   cache->tablesize = newsize;
-   
-   return 0;
+   BddCache_free(cache);
+   return BddCache_alloc(cache, newsize);
 }
 
 
 void BddCache_reset(BddCache *cache)
 {
    register int n;
-   for (n=0 ; n<cache->tablesize ; n++)
-      cache->table[n].a = -1;
+   if (cache->wide)
+      for (n=0 ; n<cache->tablesize ; n++)
+	 cache->wtable[n].a = -1;
+   else
+      for (n=0 ; n<cache->tablesize ; n++)
+	 cache->table[n].a = -1;
 }
 
 #if ENABLE_TBDD
+/* Only for entries of the proof cache */
 void BddCache_clause_evict(BddCacheData *entry) {
-    int id;
-    if (entry->a != -1 &&
-	(entry->op == bddop_andimptstj || entry->op == bddop_andj || entry->op == bddop_imptstj)) {
-	id = entry->r.jclause;
+    clause_id_t id;
+    if (entry->a != -1) {
+	id = entry->jclause;
 	if (id == TAUTOLOGY)
 	    return;
 #if DO_TRACE
-	if (NNAME(entry->r.res) == TRACE_NNAME) {
-	    printf("TRACE: Evicting node N%d.  Deleting clause %d\n", TRACE_NNAME, entry->r.jclause);
+	if (NNAME(entry->res) == TRACE_NNAME) {
+	    printf("TRACE: Evicting node N%d.  Deleting clause " CLAUSE_ID_FMT "\n", TRACE_NNAME, entry->jclause);
 	}
 #endif	
 	defer_delete_clause(id);
     }
 }
 
+/*
+  Set-associative access, used by the proof-generating operations.
+  Each set holds CACHE_WAYS entries ordered from most to least recently
+  used.  Evicting an entry with a justification clause costs a clause
+  deletion now and a new proof later, and so the replacement policy
+  keeps these entries in preference to ones without clauses, and,
+  among those, keeps the ones covering larger subproblems, estimated by
+  how close the first operand is to the top of the variable ordering.
+  The most recently used entry is never evicted.
+*/
+
+#define BddCache_set(cache, hash) (&(cache)->table[((hash) % (cache)->setcount) * CACHE_WAYS])
+
+static int BddCache_cost(BddCacheData *entry)
+{
+   if (entry->a == -1  ||  entry->jclause == TAUTOLOGY)
+      return 0;
+   return 1 + bddvarnum - (LEVEL(entry->a) & MARKOFF);
+}
+
+/*
+  Way of the set holding the matching entry, or -1 if none.
+  Key b is built with PROOFKEY.  For andimptstj, c is the third operand, and
+  the result bit in b is ignored.  Otherwise c is -1.
+*/
+static int BddCache_way(BddCacheData *set, int a, int b, int c)
+{
+   int bmask = c < 0 ? -1 : ~PROOF_RESBIT;
+   int w;
+
+   for (w=0 ; w<CACHE_WAYS ; w++)
+      if (set[w].a == a  &&  (set[w].b & bmask) == b  &&  (c < 0  ||  set[w].res == c))
+	 return w;
+   return -1;
+}
+
+/* Find matching entry and make it the most recently used.  Return NULL if none */
+BddCacheData *BddCache_lookup_set(BddCache *cache, unsigned int hash, int a, int b, int c)
+{
+   BddCacheData *set = BddCache_set(cache, hash);
+   BddCacheData entry;
+   int w = BddCache_way(set, a, b, c);
+
+   if (w < 0)
+      return NULL;
+   if (w > 0)
+   {
+      entry = set[w];
+      memmove(set+1, set, w*sizeof(BddCacheData));
+      set[0] = entry;
+   }
+   return set;
+}
+
+/* Same, but leaves the cache unchanged, so that several threads may search it */
+BddCacheData *BddCache_find_set(BddCache *cache, unsigned int hash, int a, int b, int c)
+{
+   BddCacheData *set = BddCache_set(cache, hash);
+   int w = BddCache_way(set, a, b, c);
+
+   return w < 0 ? NULL : &set[w];
+}
+
+/* Evict an entry from the set and return the freed slot, now the most recently used */
+BddCacheData *BddCache_insert_set(BddCache *cache, unsigned int hash)
+{
+   BddCacheData *set = BddCache_set(cache, hash);
+   int w, victim = CACHE_WAYS-1;
+   int cost, mincost;
+
+   mincost = BddCache_cost(&set[victim]);
+   for (w=CACHE_WAYS-2 ; w>0 && mincost > 0 ; w--)
+   {
+      cost = BddCache_cost(&set[w]);
+      if (cost < mincost)
+      {
+	 victim = w;
+	 mincost = cost;
+      }
+   }
+   BddCache_clause_evict(&set[victim]);
+   if (victim > 0)
+      memmove(set+1, set, victim*sizeof(BddCacheData));
+   set[0].a = -1;
+   return set;
+}
+
+
 void BddCache_clear_clauses(BddCache *cache)
 {
    register int n;
@@ -69,6 +69,9 @@
 /*************************************************************************
   Modified 2022/02/10.  R.E. Bryant
   Create four cache operands (a, b, c, op) so that single cache would suffice for all operations
+  Modified again: with a cache per group of operations, the op field is
+  gone and entries are 16 bytes.  Only the misc cache, holding double
+  results, uses the wider entries.
 *************************************************************************/
 
 #ifndef _CACHE_H
@@ -78,33 +81,64 @@
 #define ENABLE_TBDD 0
 #endif
 
+/* Associativity of the cache sets used by the proof-generating operations.
+   The default of 1 gives a direct-mapped cache */
+#ifndef CACHE_WAYS
+#define CACHE_WAYS 1
+#endif
+
+/* Compact entry, four to a 64-byte cache line.  Entries in the cache of
+   the proof generating operations hold the justifying clause in place
+   of c, and fold the operation into the top bits of b (see PROOFKEY).
+   With 64-bit clause IDs (CLAUSE_ID64), entries take 24 bytes */
 typedef struct
 {
+   int a,b;
    union
    {
-      double dres;
+      int c;
 #if ENABLE_TBDD
-       // C compiler needs to support anonymous structs
-       struct {
-	   BDD res;
-	   int jclause;
-       };
-#else
-       int res;
-#endif       
+      clause_id_t jclause;
+#endif
+   };
+   int res;
+} BddCacheData;
+
+/* Wide entry, for results that may be doubles */
+typedef struct
+{
+   union
+   {
+      double dres;
+      int res;
    } r;
    int a,b,c;
-   int op;
-} BddCacheData;
+} BddCacheWide;
 
 
 typedef struct
 {
-   BddCacheData *table;
+   union
+   {
+      BddCacheData *table;
+      BddCacheWide *wtable;
+   };
    int tablesize;
+   int setcount;
+   int wide;
 } BddCache;
 
+#if ENABLE_TBDD
+/* Operation tags for the proof cache.  The result of andimptstj is a
+   constant, given by PROOF_RESBIT, and c is kept in place of res */
+#define PROOF_TAGSHIFT 30
+#define PROOF_RESBIT   (1 << PROOF_TAGSHIFT)
+#define PROOFKEY(b,op) ((int) ((unsigned) (b) | ((unsigned) ((op)-bddop_andj) << PROOF_TAGSHIFT)))
+#define PROOFNODE(b)   ((b) & (PROOF_RESBIT-1))
+#endif
+
 extern int  BddCache_init(BddCache *, int);
+extern int  BddCache_init_wide(BddCache *, int);
 extern void BddCache_done(BddCache *);
 extern int  BddCache_resize(BddCache *, int);
 extern void BddCache_reset(BddCache *);
@@ -112,9 +146,13 @@ extern void BddCache_reset(BddCache *);
 #if ENABLE_TBDD
 extern void BddCache_clause_evict(BddCacheData *entry);
 extern void BddCache_clear_clauses(BddCache *);
+extern BddCacheData *BddCache_lookup_set(BddCache *, unsigned int, int, int, int);
+extern BddCacheData *BddCache_find_set(BddCache *, unsigned int, int, int, int);
+extern BddCacheData *BddCache_insert_set(BddCache *, unsigned int);
 #endif
 
 #define BddCache_lookup(cache, hash) (&(cache)->table[hash % (cache)->tablesize])
+#define BddCache_lookup_wide(cache, hash) (&(cache)->wtable[hash % (cache)->tablesize])
 
 
 #endif /* _CACHE_H */
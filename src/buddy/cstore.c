@@ -0,0 +1,203 @@
+/*========================================================================
+  Copyright (c) 2022 Randal E. Bryant, Carnegie Mellon University
+  
+  This code was not included in the original BuDDy distribution and is
+  therefore not subject to any of its licensing terms.
+
+  Permission is hereby granted, free of
+  charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+========================================================================*/
+
+
+/* Clause store: Literals of the clauses that a DRAT or FRAT proof must repeat when deleting them */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "kernel.h"
+#include "cstore.h"
+
+/* Indicates that no clause is recorded with an ID */
+#define NO_CLAUSE SIZE_MAX
+
+/* Initial size of arena */
+#define CSTORE_INITIAL_BYTES (1 << 20)
+
+/* Fields of the current manager, see manager.h */
+/* Index covers IDs base_id .. base_id+index_count-1 */
+#define base_id            (bddmanager->cstore.base_id)
+#define clause_offset      (bddmanager->cstore.clause_offset)
+#define index_count        (bddmanager->cstore.index_count)
+#define index_alloc        (bddmanager->cstore.index_alloc)
+/*
+  Recorded clauses.  For each clause:
+  number of literals, literals.
+  Each encoded with variable-byte encoding of binary proofs.
+ */
+#define arena              (bddmanager->cstore.arena)
+#define arena_count        (bddmanager->cstore.arena_count)
+#define arena_alloc        (bddmanager->cstore.arena_alloc)
+#define dead_count         (bddmanager->cstore.dead_count)
+
+/* Number of bytes taken by clause at p */
+static size_t clause_bytes(unsigned char *p) {
+    unsigned char *start = p;
+    int len = pw_int_unpack(&p);
+    int i;
+    for (i = 0; i < len; i++) {
+	while (*p >= 128)
+	    p++;
+	p++;
+    }
+    return p - start;
+}
+
+/*
+  Move live clauses to the start of the arena, keeping their order,
+  and drop deleted IDs below the first live clause from the index.
+ */
+static void cstore_compact() {
+    clause_id_t skip = 0;
+    clause_id_t i;
+    size_t count = 0;
+    while (skip < index_count && clause_offset[skip] == NO_CLAUSE)
+	skip++;
+    for (i = skip; i < index_count; i++) {
+	size_t offset = clause_offset[i];
+	if (offset == NO_CLAUSE) {
+	    clause_offset[i-skip] = NO_CLAUSE;
+	    continue;
+	}
+	size_t bytes = clause_bytes(arena + offset);
+	memmove(arena + count, arena + offset, bytes);
+	clause_offset[i-skip] = count;
+	count += bytes;
+    }
+    for (i = index_count - skip; i < index_count; i++)
+	clause_offset[i] = NO_CLAUSE;
+    base_id += skip;
+    index_count -= skip;
+    arena_count = count;
+    dead_count = 0;
+    /* Return space once well under half of it is used */
+    if (arena_alloc > CSTORE_INITIAL_BYTES && 4 * arena_count < arena_alloc) {
+	size_t new_alloc = arena_alloc / 2;
+	unsigned char *new_arena = realloc(arena, new_alloc);
+	if (new_arena != NULL) {
+	    arena = new_arena;
+	    arena_alloc = new_alloc;
+	}
+    }
+}
+
+int cstore_init(clause_id_t id_count) {
+    clause_id_t id;
+    base_id = 1;
+    index_count = 0;
+    index_alloc = id_count + 1000;
+    clause_offset = malloc(index_alloc * sizeof(size_t));
+    if (clause_offset == NULL)
+	return bdd_error(BDD_MEMORY);
+    for (id = 0; id < index_alloc; id++)
+	clause_offset[id] = NO_CLAUSE;
+    arena_alloc = CSTORE_INITIAL_BYTES;
+    arena_count = 0;
+    dead_count = 0;
+    arena = malloc(arena_alloc);
+    if (arena == NULL)
+	return bdd_error(BDD_MEMORY);
+    return 0;
+}
+
+void cstore_add(clause_id_t clause_id, ilist clause) {
+    clause_id_t i;
+    clause_id_t pos = clause_id - base_id;
+    if (pos >= index_alloc) {
+	clause_id_t new_alloc = 2 * index_alloc;
+	if (new_alloc <= pos)
+	    new_alloc = pos + 1;
+	size_t *new_offset = realloc(clause_offset, new_alloc * sizeof(size_t));
+	if (new_offset == NULL) {
+	    bdd_error(BDD_MEMORY);
+	    return;
+	}
+	clause_offset = new_offset;
+	for (i = index_alloc; i < new_alloc; i++)
+	    clause_offset[i] = NO_CLAUSE;
+	index_alloc = new_alloc;
+    }
+    size_t need = PW_INT_MAX_BYTES * (1 + ilist_length(clause));
+    if (arena_count + need > arena_alloc) {
+	size_t new_alloc = arena_alloc;
+	while (arena_count + need > new_alloc)
+	    new_alloc *= 2;
+	unsigned char *new_arena = realloc(arena, new_alloc);
+	if (new_arena == NULL) {
+	    bdd_error(BDD_MEMORY);
+	    return;
+	}
+	arena = new_arena;
+	arena_alloc = new_alloc;
+    }
+    clause_offset[pos] = arena_count;
+    index_count = pos + 1;
+    unsigned char *d = arena + arena_count;
+    d += pw_int_pack(ilist_length(clause), d);
+    for (i = 0; i < ilist_length(clause); i++)
+	d += pw_int_pack(clause[i], d);
+    arena_count = d - arena;
+}
+
+ilist cstore_get(clause_id_t clause_id, ilist *bufp) {
+    clause_id_t pos = clause_id - base_id;
+    int i;
+    if (pos < 0 || pos >= index_count || clause_offset[pos] == NO_CLAUSE)
+	return TAUTOLOGY_CLAUSE;
+    unsigned char *p = arena + clause_offset[pos];
+    int len = pw_int_unpack(&p);
+    ilist clause = ilist_resize(*bufp, len);
+    for (i = 0; i < len; i++)
+	clause[i] = pw_int_unpack(&p);
+    *bufp = clause;
+    return clause;
+}
+
+void cstore_delete(clause_id_t clause_id) {
+    clause_id_t pos = clause_id - base_id;
+    if (pos < 0 || pos >= index_count || clause_offset[pos] == NO_CLAUSE)
+	return;
+    dead_count += clause_bytes(arena + clause_offset[pos]);
+    clause_offset[pos] = NO_CLAUSE;
+    /* Compact once most of the arena holds deleted clauses */
+    if (arena_count >= CSTORE_INITIAL_BYTES && 2 * dead_count > arena_count)
+	cstore_compact();
+}
+
+void cstore_done() {
+    free(clause_offset);
+    free(arena);
+    clause_offset = NULL;
+    arena = NULL;
+    index_count = index_alloc = 0;
+    arena_count = arena_alloc = dead_count = 0;
+}
+
+/* EOF */
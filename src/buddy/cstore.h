@@ -0,0 +1,78 @@
+/*========================================================================
+  Copyright (c) 2022 Randal E. Bryant, Carnegie Mellon University
+  
+  This code was not included in the original BuDDy distribution and is
+  therefore not subject to any of its licensing terms.
+
+  Permission is hereby granted, free of
+  charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+========================================================================*/
+
+
+/* Clause store: Literals of the clauses that a DRAT or FRAT proof must repeat when deleting them */
+
+#ifndef CSTORE_H
+#define CSTORE_H
+
+#include "ilist.h"
+
+/* Allow this headerfile to define C++ constructs if requested */
+#ifdef __cplusplus
+#define CPLUSPLUS
+#endif
+
+#ifdef CPLUSPLUS
+extern "C" {
+#endif
+
+/*
+  Clauses are packed one after the other into a single arena, using
+  the variable-byte encoding of binary proofs, and located by an index
+  of offsets by clause ID.  Deleting a clause only marks it in the
+  index.  Once deleted clauses take up most of the arena, it is
+  compacted, and the index drops the IDs below the first live clause.
+ */
+
+/* Set up for clause IDs up to id_count */
+extern int cstore_init(clause_id_t id_count);
+
+/* Record clause.  Clause IDs must be increasing */
+extern void cstore_add(clause_id_t clause_id, ilist clause);
+
+/* 
+   Retrieve clause, unpacked into *bufp, which is resized as needed.
+   Return TAUTOLOGY_CLAUSE if no clause is recorded with this ID.
+*/
+extern ilist cstore_get(clause_id_t clause_id, ilist *bufp);
+
+/* Forget clause and reclaim its space later */
+extern void cstore_delete(clause_id_t clause_id);
+
+/* Free all storage */
+extern void cstore_done();
+
+#ifdef CPLUSPLUS
+}
+#endif
+
+#endif /* CSTORE_H */
+
+/* EOF */
@@ -61,12 +61,12 @@ typedef struct s_Domain
 static void Domain_allocate(Domain*, int);
 static void Domain_done(Domain*);
 
-static int    firstbddvar;
-static int    fdvaralloc;         /* Number of allocated domains */
-static int    fdvarnum;           /* Number of defined domains */
-static Domain *domain;            /* Table of domain sizes */
-
-static bddfilehandler filehandler;
+   /* Domains of the current manager, see manager.h */
+#define firstbddvar (bddmanager->fdd.firstbddvar)
+#define fdvaralloc  (bddmanager->fdd.fdvaralloc)
+#define fdvarnum    (bddmanager->fdd.fdvarnum)
+#define domain      (bddmanager->fdd.domain)
+#define filehandler (bddmanager->fdd.filehandler)
 
 /*************************************************************************
   Domain definition
@@ -59,11 +59,11 @@ static ilist ilist_error(char *fname) {
 }
 
 /* 
-   Convert an array of ints to an ilist.  Don't call free_ilist on
+   Convert an array of ival_t's to an ilist.  Don't call free_ilist on
    this one!  The size of the array should be max_length + ILIST_OVHD
    Will be statically sized
 */
-ilist ilist_make(int *p, int max_length) {
+ilist ilist_make(ival_t *p, int max_length) {
     ilist result = p+ILIST_OVHD;
     ILIST_LENGTH(result) = 0;
     ILIST_MAXLENGTHFIELD(result) = max_length;
@@ -74,7 +74,7 @@ ilist ilist_make(int *p, int max_length) {
 ilist ilist_new(int max_length) {
     if (max_length == 0)
 	max_length++;
-    int *p = calloc(max_length + ILIST_OVHD, sizeof(int));
+    ival_t *p = calloc(max_length + ILIST_OVHD, sizeof(ival_t));
      ilist result = p+ILIST_OVHD;
     ILIST_LENGTH(result) = 0;
     ILIST_MAXLENGTHFIELD(result) = -max_length;
@@ -86,7 +86,7 @@ void ilist_free(ilist ils) {
     if (!ils)
 	return;
     if (ILIST_MAXLENGTHFIELD(ils) < 0) {
-	int *p = ILIST_BASE(ils);
+	ival_t *p = ILIST_BASE(ils);
 	free(p);
     }
 }
@@ -107,12 +107,12 @@ ilist ilist_resize(ilist ils, int nlength) {
     int true_max_length = IABS(list_max_length);
     if (nlength > true_max_length) {
 	if (list_max_length < 0) {
-	    int *p = ILIST_BASE(ils);
+	    ival_t *p = ILIST_BASE(ils);
 	    /* Dynamically resize */
 	    true_max_length *= 2;
 	    if (nlength > true_max_length)
 		true_max_length = nlength;
-	    p = realloc(p, (true_max_length + ILIST_OVHD) * sizeof(int));
+	    p = realloc(p, (true_max_length + ILIST_OVHD) * sizeof(ival_t));
 	    if (p == NULL) {
 		/* Need to throw error here */
 		return ilist_error("resize (dynamic)");
@@ -131,7 +131,7 @@ ilist ilist_resize(ilist ils, int nlength) {
   Add new value(s) to end of ilist.
   For dynamic ilists, the value of the pointer may change
 */
-ilist ilist_push(ilist ils, int val) {
+ilist ilist_push(ilist ils, ival_t val) {
     int length = ILIST_LENGTH(ils);
     int nlength = length+1;
     ils = ilist_resize(ils, nlength);
@@ -148,7 +148,7 @@ ilist ilist_push(ilist ils, int val) {
   Populate ilist with 1, 2, 3, or 4 elements.
   For dynamic ilists, the value of the pointer may change
  */
-ilist ilist_fill1(ilist ils, int val1) {
+ilist ilist_fill1(ilist ils, ival_t val1) {
     ils = ilist_resize(ils, 1);
     if (!ils) {
 	/* Want to throw an exception here */
@@ -158,7 +158,7 @@ ilist ilist_fill1(ilist ils, int val1) {
     return ils;
 }
 
-ilist ilist_fill2(ilist ils, int val1, int val2) {
+ilist ilist_fill2(ilist ils, ival_t val1, ival_t val2) {
     ils = ilist_resize(ils, 2);
     if (!ils) {
 	/* Want to throw an exception here */
@@ -169,7 +169,7 @@ ilist ilist_fill2(ilist ils, int val1, int val2) {
     return ils;
 }
 
-ilist ilist_fill3(ilist ils, int val1, int val2, int val3) {
+ilist ilist_fill3(ilist ils, ival_t val1, ival_t val2, ival_t val3) {
     ils = ilist_resize(ils, 3);
     if (!ils) {
 	/* Want to throw an exception here */
@@ -181,7 +181,7 @@ ilist ilist_fill3(ilist ils, int val1, int val2, int val3) {
     return ils;
 }
 
-ilist ilist_fill4(ilist ils, int val1, int val2, int val3, int val4) {
+ilist ilist_fill4(ilist ils, ival_t val1, ival_t val2, ival_t val3, ival_t val4) {
     ils = ilist_resize(ils, 4);
     if (!ils) {
 	/* Want to throw an exception here */
@@ -200,7 +200,9 @@ ilist ilist_fill4(ilist ils, int val1, int val2, int val3, int val4) {
 ilist ilist_copy_list(int *ls, int length) {
     ilist rils =  ilist_new(length);
     rils = ilist_resize(rils, length);
-    memcpy(rils, ls, length*sizeof(int));
+    int i;
+    for (i = 0; i < length; i++)
+	rils[i] = ls[i];
     return rils;
 }
 
@@ -210,9 +212,9 @@ ilist ilist_copy_list(int *ls, int length) {
  */
 ilist ilist_read_file(FILE *infile) {
     ilist rils = ilist_new(1);
-    int val;
+    ival_t val;
     int rcode;
-    while ((rcode = fscanf(infile, "%d", &val)) == 1) {
+    while ((rcode = fscanf(infile, CLAUSE_ID_FMT, &val)) == 1) {
 	rils = ilist_push(rils, val);
     }
     if (rcode != EOF)
@@ -224,7 +226,7 @@ ilist ilist_read_file(FILE *infile) {
 /*
   Test whether value is member of list
  */
-extern bool ilist_is_member(ilist ils, int val) {
+extern bool ilist_is_member(ilist ils, ival_t val) {
     int i;
     for (i = 0; i < ilist_length(ils); i++)
 	if (val == ils[i])
@@ -236,18 +238,21 @@ extern bool ilist_is_member(ilist ils, int val) {
   Dynamically allocate ilist and copy from existing one.
  */
 ilist ilist_copy(ilist ils) {
-    ilist rils = ilist_copy_list(ils, ilist_length(ils));
+    int length = ilist_length(ils);
+    ilist rils =  ilist_new(length);
+    rils = ilist_resize(rils, length);
+    memcpy(rils, ils, length*sizeof(ival_t));
     return rils;
 }
 
 /*
   Reverse elements in ilist
  */
-void ilist_reverse(int *ils) {
+void ilist_reverse(ival_t *ils) {
     int left = 0;
     int right = ilist_length(ils)-1;
     while (left < right) {
-	int v = ils[left];
+	ival_t v = ils[left];
 	ils[left] = ils[right];
 	ils[right] = v;
 	left++;
@@ -259,8 +264,8 @@ void ilist_reverse(int *ils) {
   Sort integers in ascending order
  */
 int int_compare_ilist(const void *i1p, const void *i2p) {
-    int i1 = *(int *) i1p;
-    int i2 = *(int *) i2p;
+    ival_t i1 = *(ival_t *) i1p;
+    ival_t i2 = *(ival_t *) i2p;
     if (i1 < i2)
 	return -1;
     if (i1 > i2)
@@ -272,8 +277,8 @@ int int_compare_ilist(const void *i1p, const void *i2p) {
 /*
   Put elements of ilist into ascending order
  */
-void ilist_sort(int *ils) {
-    qsort((void *) ils, ilist_length(ils), sizeof(int), int_compare_ilist);
+void ilist_sort(ival_t *ils) {
+    qsort((void *) ils, ilist_length(ils), sizeof(ival_t), int_compare_ilist);
 }
 
 
@@ -293,7 +298,7 @@ int ilist_print(ilist ils, FILE *out, const char *sep) {
 	return rval;
     }
     for (i = 0; i < ilist_length(ils); i++) {
-	int pval = fprintf(out, "%s%d", space, ils[i]);
+	int pval = fprintf(out, "%s" CLAUSE_ID_FMT, space, ils[i]);
 	if (pval < 0)
 	    return pval;
 	rval += pval;
@@ -315,7 +320,7 @@ int ilist_format(ilist ils, char *out, const char *sep, int maxlen) {
     for (i = 0; i < ilist_length(ils); i++) {
 	if (len >= maxlen)
 	    break;
-	int xlen = snprintf(out+len, maxlen-len, "%s%d", space, ils[i]);
+	int xlen = snprintf(out+len, maxlen-len, "%s" CLAUSE_ID_FMT, space, ils[i]);
 	len += xlen;
 	space = sep;
     }
@@ -48,6 +48,20 @@
 extern "C" {
 #endif
 
+/*
+  Clause IDs are ints, unless compiled with -DCLAUSE_ID64, in which
+  case they are 64 bits, allowing proofs with more than 2^31 clauses.
+*/
+#ifdef CLAUSE_ID64
+typedef long long clause_id_t;
+#define CLAUSE_ID_MAX LLONG_MAX
+#define CLAUSE_ID_FMT "%lld"
+#else
+typedef int clause_id_t;
+#define CLAUSE_ID_MAX INT_MAX
+#define CLAUSE_ID_FMT "%d"
+#endif
+
 /*
   Data type ilist is used to represent clauses and clause id lists.
   These are simply lists of integers, where the value at position -1
@@ -55,8 +69,10 @@ extern "C" {
   maximum list length.  The value at position -2 is positive for
   statically-allocated ilists and negative for ones that can be
   dynamically resized.
+  Elements must be wide enough to hold clause IDs.
 */
-typedef int *ilist;
+typedef clause_id_t ival_t;
+typedef ival_t *ilist;
   
 /*
   Difference between ilist maximum length and number of allocated
@@ -75,11 +91,11 @@ typedef int *ilist;
 #define FALSE_CUBE ((ilist) INT_MIN)
 
 /* 
-   Convert an array of ints to an ilist.  Don't call free_ilist on
+   Convert an array of ival_t's to an ilist.  Don't call free_ilist on
    this one!  The size of the array should be max_length + ILIST_OVHD
    Will be statically sized
 */
-extern ilist ilist_make(int *p, int max_length);
+extern ilist ilist_make(ival_t *p, int max_length);
 
 /* Allocate a new ilist. */
 extern ilist ilist_new(int max_length);
@@ -100,21 +116,21 @@ extern ilist ilist_resize(ilist ils, int nlength);
   Add new value(s) to end of ilist.
   For dynamic ilists, the value of the pointer may change
 */
-extern ilist ilist_push(ilist ils, int val);
+extern ilist ilist_push(ilist ils, ival_t val);
 
 /*
   Populate ilist with 1, 2, 3, or 4 elements.
   For dynamic ilists, the value of the pointer may change
  */
-extern ilist ilist_fill1(ilist ils, int val1);
-extern ilist ilist_fill2(ilist ils, int val1, int val2);
-extern ilist ilist_fill3(ilist ils, int val1, int val2, int val3);
-extern ilist ilist_fill4(ilist ils, int val1, int val2, int val3, int val4);
+extern ilist ilist_fill1(ilist ils, ival_t val1);
+extern ilist ilist_fill2(ilist ils, ival_t val1, ival_t val2);
+extern ilist ilist_fill3(ilist ils, ival_t val1, ival_t val2, ival_t val3);
+extern ilist ilist_fill4(ilist ils, ival_t val1, ival_t val2, ival_t val3, ival_t val4);
 
 /*
   Test whether value is member of list
  */
-extern bool ilist_is_member(ilist ils, int val);
+extern bool ilist_is_member(ilist ils, ival_t val);
 
 /*
   Dynamically allocate ilist and copy from existing one.
@@ -135,12 +151,12 @@ extern ilist ilist_read_file(FILE *infile);
 /*
   Reverse elements in ilist
  */
-extern void ilist_reverse(int *ls);
+extern void ilist_reverse(ival_t *ls);
 
 /*
   Put elements of ilist into ascending order
  */
-extern void ilist_sort(int *ls);
+extern void ilist_sort(ival_t *ls);
 
 /*
   Print elements of an ilist separated by sep.  Return value < 0 if error
@@ -110,45 +110,38 @@ ALSO    {* bddtrue, bdd\_true, bdd\_false *}
 const BDD bddfalse=0;                    /* The constant false bdd */
 
 
-/*=== INTERNAL DEFINITIONS =============================================*/
-
-/* Min. number of nodes (%) that has to be left after a garbage collect
-   unless a resize should be done. */
-static int minfreenodes=20;
-
-
-/*=== GLOBAL KERNEL VARIABLES ==========================================*/
-
-int          bddrunning;            /* Flag - package initialized */
-int          bdderrorcond;          /* Some error condition */
-int          bddnodesize;           /* Number of allocated nodes */
-int          bddmaxnodesize;        /* Maximum allowed number of nodes */
-int          bddmaxnodeincrease;    /* Max. # of nodes used to inc. table */
-BddNode*     bddnodes;          /* All of the bdd nodes */
-int          bddfreepos;        /* First free node */
-int          bddfreenum;        /* Number of free nodes */
-long int     bddproduced;       /* Number of new nodes ever produced */
-int          bddvarnum;         /* Number of defined BDD variables */
-int*         bddrefstack;       /* Internal node reference stack */
-int*         bddrefstacktop;    /* Internal node reference stack top */
-int*         bddvar2level;      /* Variable -> level table */
-int*         bddlevel2var;      /* Level -> variable table */
-jmp_buf      bddexception;      /* Long-jump point for interrupting calc. */
-int          bddresized;        /* Flag indicating a resize of the nodetable */
-
-bddCacheStat bddcachestats;
-
-
 /*=== PRIVATE KERNEL VARIABLES =========================================*/
 
-static BDD*     bddvarset;             /* Set of defined BDD variables */
-static int      gbcollectnum;          /* Number of garbage collections */
-static int      cachesize;             /* Size of the operator caches */
-static long int gbcclock;              /* Clock ticks used in GBC */
-static int      usednodes_nextreorder; /* When to do reorder next time */
-static bddinthandler  err_handler;     /* Error handler */
-static bddgbchandler  gbc_handler;     /* Garbage collection handler */
-static bdd2inthandler resize_handler;  /* Node-table-resize handler */
+   /* Fields of the current manager, see manager.h, where the others
+      are defined.  The names differ from the fields of bddStat */
+#define gbcminfreenodes       (bddmanager->kernel.gbcminfreenodes)
+#define bddvarset             (bddmanager->kernel.bddvarset)
+#define gbcollectnum          (bddmanager->kernel.gbcollectnum)
+#define gbcyoungcollectnum    (bddmanager->kernel.gbcyoungcollectnum)
+#define gbcgenerational       (bddmanager->kernel.gbcgenerational)
+#define youngnodes            (bddmanager->kernel.youngnodes)
+#define youngcount            (bddmanager->kernel.youngcount)
+#define youngalloc            (bddmanager->kernel.youngalloc)
+#define markstack             (bddmanager->kernel.markstack)
+#define markstackalloc        (bddmanager->kernel.markstackalloc)
+#define noderesizenum         (bddmanager->kernel.noderesizenum)
+#define nodetablealloc        (bddmanager->kernel.nodetablealloc)
+
+   /* Too few free nodes left by a garbage collection */
+#define NODESLOW() (bddadaptive ? \
+   (bddfreenum*100) / bddnodesize < 100-ADAPTMAXLIVE : \
+   (bddfreenum*100) / bddnodesize <= gbcminfreenodes)
+
+   /* Push node n on markstack, which always has room (see markstack_reserve) */
+#define MARKPUSH(sp,n) (markstack[(sp)++] = (n))
+#define oldcount              (bddmanager->kernel.oldcount)
+#define oldlimit              (bddmanager->kernel.oldlimit)
+#define opcachesize           (bddmanager->kernel.opcachesize)
+#define gbcclock              (bddmanager->kernel.gbcclock)
+#define usednodes_nextreorder (bddmanager->kernel.usednodes_nextreorder)
+#define err_handler           (bddmanager->kernel.err_handler)
+#define gbc_handler           (bddmanager->kernel.gbc_handler)
+#define resize_handler        (bddmanager->kernel.resize_handler)
 
 
    /* Strings for all error mesages */
@@ -187,6 +180,95 @@ static char *errorstrings[BDD_ERRNUM] =
 
 #define NODEHASH(lvl,l,h) (TRIPLE(lvl,l,h) % bddnodesize)
 
+#ifdef OPEN_UNIQUE
+/*
+  Open-addressing unique table, selected by compiling with -DOPEN_UNIQUE.
+  Slots are probed linearly.  Each slot has a fingerprint byte (0 when
+  empty) held in its own compact array, so that a probe sequence reads
+  few cache lines, and the node itself is only read when the fingerprint
+  matches.  There are at least twice as many slots as nodes.  A full
+  garbage collection rebuilds the table.  A young-generation collection
+  instead removes each freed node with unique_remove, which finds its
+  slot from the hash of the level (without the GC flags), low, and high
+  and moves later entries of the probe sequence back into the gap
+  (backward-shift deletion), so that no tombstones are left.  This
+  relies on the freed node being in the table and still holding its
+  fields when it is removed, and on every other entry being hashed from
+  its current fields, so that its home slot can be recomputed.
+ */
+#define uniquefp   (bddmanager->kernel.uniquefp)
+#define uniquenode (bddmanager->kernel.uniquenode)
+#define uniquebits (bddmanager->kernel.uniquebits)
+#define uniquemask (bddmanager->kernel.uniquemask)
+
+static inline unsigned long long unique_hash(unsigned int lvl, int l, int h)
+{
+   unsigned long long k =
+      (((unsigned long long) (unsigned int) l) << 32) | (unsigned int) h;
+   return ((k ^ lvl) * 0x9E3779B97F4A7C15ULL) ^ ((unsigned long long) lvl << 7);
+}
+
+#define UNIQUESLOT(hv) ((unsigned int) ((hv) >> (64 - uniquebits)))
+#define UNIQUEFP(hv)   ((unsigned char) ((((hv) >> (56 - uniquebits)) & 0xFF) | 0x1))
+
+/* Find first empty slot in probe sequence */
+static inline unsigned int unique_emptyslot(unsigned long long hv)
+{
+   unsigned int slot = UNIQUESLOT(hv);
+   while (uniquefp[slot] != 0)
+      slot = (slot+1) & uniquemask;
+   return slot;
+}
+
+static inline void unique_insert(int n)
+{
+   unsigned long long hv = unique_hash(LEVEL(n), LOW(n), HIGH(n));
+   unsigned int slot = unique_emptyslot(hv);
+   uniquefp[slot] = UNIQUEFP(hv);
+   uniquenode[slot] = n;
+}
+
+static inline void unique_clear(void)
+{
+   memset(uniquefp, 0, (size_t) uniquemask + 1);
+}
+
+/* Remove node, shifting later entries of probe sequence back to fill gap */
+static void unique_remove(int n)
+{
+   unsigned int slot = UNIQUESLOT(unique_hash(LEVEL(n) & MARKOFF, LOW(n), HIGH(n)));
+   unsigned int next;
+
+   while (uniquefp[slot] == 0  ||  uniquenode[slot] != n)
+      slot = (slot+1) & uniquemask;
+
+   for (next = (slot+1) & uniquemask ; uniquefp[next] != 0 ; next = (next+1) & uniquemask)
+   {
+      int m = uniquenode[next];
+      unsigned int home = UNIQUESLOT(unique_hash(LEVEL(m) & MARKOFF, LOW(m), HIGH(m)));
+
+      /* Can move to slot if that lies between home and current position */
+      if (((next - home) & uniquemask) >= ((next - slot) & uniquemask))
+      {
+	 uniquefp[slot] = uniquefp[next];
+	 uniquenode[slot] = m;
+	 slot = next;
+      }
+   }
+   uniquefp[slot] = 0;
+}
+#else
+/* Unlink node from its hash chain */
+static void unique_remove(int n)
+{
+   int *p = &HASHHEAD(NODEHASH(LEVEL(n) & MARKOFF, LOW(n), HIGH(n)));
+
+   while (*p != n)
+      p = &NEXTNODE(*p);
+   *p = NEXTNODE(n);
+}
+#endif /* OPEN_UNIQUE */
+
 // Debugging macros.  Currently disabled
 
 #define CHECKNODE(n) (n)
@@ -211,8 +293,10 @@ static int checkrange(int v) {
     return v;
 }
 
+static int bdd_nodetable_resize(int size);
+static int markstack_reserve(int num);
 #if ENABLE_TBDD
-static int bdd_dclause_p(BddNode *n, dclause_t dtype);
+static clause_id_t bdd_dclause_p(BddNode *n, dclause_t dtype);
 #endif
 
 /*************************************************************************
@@ -250,31 +334,33 @@ int bdd_init(int initnodesize, int cs)
    
    if (bddrunning)
       return bdd_error(BDD_RUNNING);
-   
+
+   if (bddmemlimit > 0  &&  initnodesize > bdd_memnodenum(bddmemlimit))
+      initnodesize = bdd_memnodenum(bddmemlimit);
    bddnodesize = bdd_prime_gte(initnodesize);
    
-   if ((bddnodes=(BddNode*)malloc(sizeof(BddNode)*bddnodesize)) == NULL)
+   if (!bdd_nodetable_resize(bddnodesize))
       return bdd_error(BDD_MEMORY);
 
    bddresized = 0;
    
    for (n=0 ; n<bddnodesize ; n++)
    {
-      bddnodes[n].refcou = 0;
+      REFCOU(n) = 0;
       LOW(n) = -1;
-      bddnodes[n].hash = 0;
+      HASHHEAD(n) = 0;
       LEVEL(n) = 0;
-      bddnodes[n].next = n+1;
+      NEXTNODE(n) = n+1;
    }
-   bddnodes[bddnodesize-1].next = 0;
+   NEXTNODE(bddnodesize-1) = 0;
 
-   bddnodes[0].refcou = bddnodes[1].refcou = MAXREF;
+   REFCOU(0) = REFCOU(1) = MAXREF;
    LEVEL(0) = LEVEL(1) = MAXVAR;
    LOW(0) = HIGH(0) = 0;
    LOW(1) = HIGH(1) = 1;
 #if ENABLE_TBDD
-   XVAR(0) = -TAUTOLOGY;
-   XVAR(1) = TAUTOLOGY;
+   XVAR(0) = -TAUTOLOGY_LIT;
+   XVAR(1) = TAUTOLOGY_LIT;
 #endif
    
    if ((err=bdd_operator_init(cs)) < 0)
@@ -283,13 +369,25 @@ int bdd_init(int initnodesize, int cs)
       return err;
    }
 
+   if (!markstack_reserve(0))
+   {
+      bdd_done();
+      return bdd_error(BDD_MEMORY);
+   }
+
    bddfreepos = 2;
    bddfreenum = CHECKRANGE(bddnodesize-2);
    bddrunning = 1;
    bddvarnum = 0;
    gbcollectnum = 0;
+   gbcyoungcollectnum = 0;
+   noderesizenum = 0;
+   opcacheresizenum = 0;
+   youngcount = 0;
+   oldcount = 0;
+   oldlimit = 0;
    gbcclock = 0;
-   cachesize = cs;
+   opcachesize = cs;
    usednodes_nextreorder = bddnodesize;
    bddmaxnodeincrease = DEFAULTMAXNODEINC;
 
@@ -302,6 +400,9 @@ int bdd_init(int initnodesize, int cs)
    bddcachestats.opHit = 0;
    bddcachestats.opMiss = 0;
    bddcachestats.swapCount = 0;
+   bddcachestats.gbcKept = 0;
+   for (n=0 ; n<BDD_CACHE_NUM ; n++)
+      bddcachestats.cacheHit[n] = bddcachestats.cacheMiss[n] = 0;
  
    bdd_gbc_hook(bdd_default_gbchandler);
    bdd_error_hook(bdd_default_errhandler);
@@ -335,9 +436,9 @@ void bdd_done(void)
    
 #if ENABLE_TBDD
    if (proof_type != PROOF_NONE) {
-       int dbuf[4+ILIST_OVHD];
+       ival_t dbuf[4+ILIST_OVHD];
        ilist dlist;
-       int id;
+       clause_id_t id;
        int n;
 
        print_proof_comment(2, "Delete clauses for all remaining nodes");
@@ -366,17 +467,43 @@ void bdd_done(void)
    }
 #endif
 
-   free(bddnodes);
+   bdd_vm_free(bddnodes, nodetablealloc[NT_NODES]);
+   bdd_vm_free(bddrefcou, nodetablealloc[NT_REFCOU]);
+   bdd_vm_free(bddhash, nodetablealloc[NT_HASH]);
+   bdd_vm_free(bddnext, nodetablealloc[NT_NEXT]);
+#if ENABLE_TBDD
+   bdd_vm_free(bddproof, nodetablealloc[NT_PROOF]);
+#endif
    free(bddrefstack);
    free(bddvarset);
    free(bddvar2level);
    free(bddlevel2var);
    
+   free(youngnodes);
+   youngnodes = NULL;
+   youngcount = youngalloc = 0;
+   free(markstack);
+   markstack = NULL;
+   markstackalloc = 0;
+#ifdef OPEN_UNIQUE
+   bdd_vm_free(uniquefp, nodetablealloc[NT_UNIQUEFP]);
+   bdd_vm_free(uniquenode, nodetablealloc[NT_UNIQUENODE]);
+   uniquefp = NULL;
+   uniquenode = NULL;
+#endif
+   memset(nodetablealloc, 0, sizeof(nodetablealloc));
    bddnodes = NULL;
+   bddrefcou = NULL;
+   bddhash = NULL;
+   bddnext = NULL;
+#if ENABLE_TBDD
+   bddproof = NULL;
+#endif
    bddrefstack = NULL;
    bddvarset = NULL;
 
    bdd_operator_done();
+   bdd_papply_done();
 
    bddrunning = 0;
    bddnodesize = 0;
@@ -508,6 +635,8 @@ int bdd_setvarnum_ordered(int num, int *varlist)
    if (bddrefstack != NULL)
       free(bddrefstack);
    bddrefstack = bddrefstacktop = (int*)malloc(sizeof(int)*(num*2+4));
+   if (bddrefstack == NULL  ||  !markstack_reserve(num))
+      return bdd_error(BDD_MEMORY);
 
    bddvarnum = num;
 
@@ -524,8 +653,8 @@ int bdd_setvarnum_ordered(int num, int *varlist)
 	 return -bdderrorcond;
       }
       
-      bddnodes[bddvarset[bdv*2]].refcou = MAXREF;
-      bddnodes[bddvarset[bdv*2+1]].refcou = MAXREF;
+      REFCOU(bddvarset[bdv*2]) = MAXREF;
+      REFCOU(bddvarset[bdv*2+1]) = MAXREF;
    }
 
    LEVEL(0) = num;
@@ -713,6 +842,143 @@ int bdd_setmaxincrease(int size)
    return old;
 }
 
+/*
+NAME    {* bdd\_sethugepages *}
+SECTION {* kernel *}
+SHORT   {* back large tables with huge pages *}
+PROTO   {* int bdd_sethugepages(int enable) *}
+DESCR   {* On Linux, the node table and the operator caches are mapped
+	   directly once they are large, and the node table then grows
+	   by remapping its pages rather than copying them. With
+	   {\tt enable} nonzero, these tables ask for transparent huge
+	   pages, which reduces the TLB misses of traversing a large
+	   node table. Call this before {\tt bdd\_init} for it to
+	   apply to the initial tables. The default is to use huge
+	   pages. On other systems this has no effect. *}
+RETURN  {* The old setting *}
+ALSO    {* bdd\_init, bdd\_setmaxincrease *}
+*/
+int bdd_sethugepages(int enable)
+{
+   int old = bddhugepages;
+
+   bddhugepages = enable;
+   return old;
+}
+
+/*
+NAME    {* bdd\_setadaptive *}
+SECTION {* kernel *}
+SHORT   {* size the node table and caches from their use *}
+PROTO   {* int bdd_setadaptive(int enable) *}
+DESCR   {* With {\tt enable} nonzero, the node table is grown whenever
+	   more than half of it survives a garbage collection, by as
+	   much as it takes to leave half of it free again, and at
+	   least by a quarter.  The limit set by {\tt bdd\_setmaxincrease}
+	   and the threshold set by {\tt bdd\_setminfreenodes} are then
+	   not used.  At each garbage collection, an operator cache
+	   whose hit rate since it was last checked is at least
+	   30\% is also doubled in size, as long as it remains smaller
+	   than the node table.  The cache then keeps its new ratio to
+	   the node table, as if set by {\tt bdd\_setopcacheratio}.
+	   Growing the caches needs the cache statistics of
+	   {\tt CACHESTATS}.  Both kinds of growth stay within the
+	   limit set by {\tt bdd\_setmemlimit}.  Disabled by default. *}
+RETURN  {* The old setting *}
+ALSO    {* bdd\_setmemlimit, bdd\_setcacheratio, bddStat *}
+*/
+int bdd_setadaptive(int enable)
+{
+   int old = bddadaptive;
+
+   bddadaptive = enable;
+   return old;
+}
+
+/*
+NAME    {* bdd\_setmemlimit *}
+SECTION {* kernel *}
+SHORT   {* set a limit on the memory used by the node table and caches *}
+PROTO   {* int bdd_setmemlimit(int mb) *}
+DESCR   {* Limits the memory taken by the node table together with the
+	   operator caches to {\tt mb} megabytes.  The table is then not
+	   grown beyond what fits, and it is made smaller than asked
+	   for by {\tt bdd\_init} if needed.  Once no nodes are left
+	   within the limit, operations fail with {\tt BDD\_NODENUM} as
+	   for {\tt bdd\_setmaxnodenum}.  A value of 0, the default,
+	   removes the limit.  The memory taken by a node, and the
+	   share of the caches that follow the size of the node table,
+	   is counted as with {\tt bdd\_memnodenum}. *}
+RETURN  {* The old limit on success, otherwise a negative error code. *}
+ALSO    {* bdd\_memnodenum, bdd\_setmaxnodenum, bdd\_setadaptive *}
+*/
+int bdd_setmemlimit(int mb)
+{
+   int old = bddmemlimit;
+
+   if (mb < 0)
+      return bdd_error(BDD_RANGE);
+
+   bddmemlimit = mb;
+   return old;
+}
+
+
+/* Bytes of the node table for each node */
+static double bdd_nodebytes(void)
+{
+   double bytes = sizeof(BddNode) + sizeof(bddrefcount) + 2*sizeof(int);
+
+#if ENABLE_TBDD
+   bytes += sizeof(BddProofInfo);
+#endif
+#ifdef OPEN_UNIQUE
+      /* Between two and four slots for each node */
+   bytes += 3 * (sizeof(unsigned char) + sizeof(int));
+#endif
+   return bytes;
+}
+
+
+/* Whether extra bytes of caches keep within the memory limit */
+int bdd_memroom(size_t extra)
+{
+   double bytes = bddnodesize * bdd_nodebytes() +
+      bdd_operator_cachebytes(bddnodesize) + extra;
+
+   return bddmemlimit == 0  ||  bytes <= (double) bddmemlimit * (1 << 20);
+}
+
+
+/*
+NAME    {* bdd\_memnodenum *}
+SECTION {* kernel *}
+SHORT   {* the number of nodes that fit in a given amount of memory *}
+PROTO   {* int bdd_memnodenum(int mb) *}
+DESCR   {* Finds the largest node table that fits in {\tt mb} megabytes,
+	   together with the operator caches.  Caches that follow the
+	   size of the node table through a cache ratio are counted at
+	   the size they would have, and the others at their present
+	   size. *}
+RETURN  {* The number of nodes *}
+ALSO    {* bdd\_setmemlimit, bdd\_setcacheratio *}
+*/
+int bdd_memnodenum(int mb)
+{
+   const int sample = 1 << 20;
+   double fixed = (double) bdd_operator_cachebytes(0);
+   double pernode = bdd_nodebytes() +
+      ((double) bdd_operator_cachebytes(sample) - fixed) / sample;
+   double num = ((double) mb * (1 << 20) - fixed) / pernode;
+
+   if (num < 0)
+      return 0;
+   if (num > MAXNODENUM)
+      return MAXNODENUM;
+   return (int) num;
+}
+
+
 /*
 NAME    {* bdd\_setmaxnodenum *}
 SECTION {* kernel *}
@@ -763,12 +1029,12 @@ ALSO    {* bdd\_setmaxnodenum, bdd\_setmaxincrease *}
 */
 int bdd_setminfreenodes(int mf)
 {
-   int old = minfreenodes;
+   int old = gbcminfreenodes;
    
    if (mf<0 || mf>100)
       return bdd_error(BDD_RANGE);
 
-   minfreenodes = mf;
+   gbcminfreenodes = mf;
    return old;
 }
 
@@ -869,10 +1135,14 @@ void bdd_stats(bddStat *s)
    s->nodenum = bddnodesize;
    s->maxnodenum = bddmaxnodesize;
    s->freenodes = bddfreenum;
-   s->minfreenodes = minfreenodes;
+   s->minfreenodes = gbcminfreenodes;
    s->varnum = bddvarnum;
-   s->cachesize = cachesize;
+   s->cachesize = opcachesize;
    s->gbcnum = gbcollectnum;
+   s->gbcyoungnum = gbcyoungcollectnum;
+   s->resizenum = noderesizenum;
+   s->cacheresizenum = opcacheresizenum;
+   s->memlimit = bddmemlimit;
 
 }
 
@@ -908,12 +1178,15 @@ DESCR   {* Prints information about the cache performance on standard output
 	   accesses to the unique node table, the number of times a node
 	   was (not) found there and how many times a hash chain had to
 	   traversed. Hit and miss count is also given for the operator
-	   caches. *}
+	   caches, in total and for each cache in use. *}
 ALSO    {* bddCacheStat, bdd\_cachestats *}
 */
 void bdd_fprintstat(FILE *ofile)
 {
+   static const char *cachename[BDD_CACHE_NUM] =
+      { "Apply", "ITE", "Quant", "Replace", "Misc", "Proof" };
    bddCacheStat s;
+   int n;
    bdd_cachestats(&s);
    
    fprintf(ofile, "\nc Cache statistics\n");
@@ -931,7 +1204,16 @@ void bdd_fprintstat(FILE *ofile)
    fprintf(ofile, "c => Hit rate =   %.2f\n",
 	   (s.opHit+s.opMiss > 0) ? 
 	   ((float)s.opHit)/((float)s.opHit+s.opMiss) : 0);
+   for (n=0 ; n<BDD_CACHE_NUM ; n++)
+   {
+      if (s.cacheHit[n]+s.cacheMiss[n] == 0)
+	 continue;
+      fprintf(ofile, "c   %-8s hits: %ld, misses: %ld, hit rate = %.2f\n",
+	      cachename[n], s.cacheHit[n], s.cacheMiss[n],
+	      ((float)s.cacheHit[n])/((float)s.cacheHit[n]+s.cacheMiss[n]));
+   }
    fprintf(ofile, "c Swap count =    %ld\n", s.swapCount);
+   fprintf(ofile, "c GC cache kept:  %ld\n", s.gbcKept);
 }
 
 
@@ -1154,13 +1436,17 @@ NAME    {* bdd\_xvar *}
 SECTION {* info *}
 SHORT   {* gets the extension variable associated with a bdd node *}
 PROTO   {* BDD bdd_xvar(BDD r) *}
-DESCR   {* Gets the extension variable assoicated with bdd node {\tt r} *}
+DESCR   {* Gets the extension variable assoicated with bdd node {\tt r}.
+           When defining clauses are generated lazily, the defining
+	   clauses for {\tt r} and its descendants are generated first,
+	   so that the variable can be used in a proof clause. *}
 RETURN  {* The extension variable *}
 ALSO    {* bdd\_nameid*}
 */
 BDD bdd_xvar(BDD root)
 {
    CHECK(root);
+   bdd_define_node(root);
    return (XVAR(root));
 }
 
@@ -1173,12 +1459,13 @@ DESCR   {* gets id of defining clause {\tt dtype} for node {\tt r} *}
 RETURN  {* The bdd of the true branch *}
 ALSO    {* bdd\_xvar *}
 */
-int bdd_dclause(BDD root, dclause_t dtype)
+clause_id_t bdd_dclause(BDD root, dclause_t dtype)
 {
    CHECK(root);
    if (root < 2)
        return TAUTOLOGY;
-   int result = DCLAUSE(root) + dtype;
+   bdd_define_node(root);
+   clause_id_t result = DCLAUSE(root) + dtype;
    switch (dtype) {
    case DEF_HU:
        return ISZERO(HIGH(root)) ? TAUTOLOGY : result;
@@ -1194,9 +1481,12 @@ int bdd_dclause(BDD root, dclause_t dtype)
    }
 }
 
-static int bdd_dclause_p(BddNode *n, dclause_t dtype)
+static clause_id_t bdd_dclause_p(BddNode *n, dclause_t dtype)
 {
-   int result = DCLAUSEp(n) + dtype;
+   if (DCLAUSEp(n) == 0)
+       /* Defining clauses never generated */
+       return TAUTOLOGY;
+   clause_id_t result = DCLAUSEp(n) + dtype;
    switch (dtype) {
    case DEF_HU:
        return ISZERO(HIGHp(n)) ? TAUTOLOGY : result;
@@ -1241,6 +1531,7 @@ void bdd_default_gbchandler(int pre, bddGbcStat *s)
    {
       printf("c Garbage collection #%d: %d nodes / %d free / %d previously freed ",
 	     s->num, s->nodes, s->freenodes, s->prevfreednodes);
+      printf("/ %d cache entries kept", s->cachekept);
       printf(" / %.1fs / %.1fs total\n",
 	     (float)s->time/(float)(CLOCKS_PER_SEC),
 	     (float)s->sumtime/(float)CLOCKS_PER_SEC);
@@ -1261,15 +1552,19 @@ static void bdd_gbc_rehash(void)
 
       if (LOWp(node) != -1)
       {
+#ifdef OPEN_UNIQUE
+	 unique_insert(n);
+#else
 	 register unsigned int hash;
 
 	 hash = NODEHASH(LEVELp(node), LOWp(node), HIGHp(node));
-	 node->next = bddnodes[hash].hash;
-	 bddnodes[hash].hash = n;
+	 NEXTNODEp(node) = HASHHEAD(hash);
+	 HASHHEAD(hash) = n;
+#endif
       }
       else
       {
-	 node->next = CHECKNODE(bddfreepos);
+	 NEXTNODEp(node) = CHECKNODE(bddfreepos);
 	 bddfreepos = CHECKNODE(n);
 	 CHECKRANGE(bddfreenum++);
       }
@@ -1277,22 +1572,186 @@ static void bdd_gbc_rehash(void)
 }
 
 
-void bdd_gbc(void)
+#if ENABLE_TBDD
+/* Delete defining clauses of node being reclaimed */
+static void bdd_delete_dclauses(BddNode *node)
+{
+   ival_t dbuf[4+ILIST_OVHD];
+   ilist dlist;
+   clause_id_t id;
+
+   if (proof_type != PROOF_NONE) {
+      dlist = ilist_make(dbuf, 4);
+      if ((id = bdd_dclause_p(node, DEF_HU)) != TAUTOLOGY)
+	 ilist_push(dlist, id);
+      if ((id = bdd_dclause_p(node, DEF_LU)) != TAUTOLOGY)
+	 ilist_push(dlist, id);
+      if ((id = bdd_dclause_p(node, DEF_HD)) != TAUTOLOGY)
+	 ilist_push(dlist, id);
+      if ((id = bdd_dclause_p(node, DEF_LD)) != TAUTOLOGY)
+	 ilist_push(dlist, id);
+
+      if (ilist_length(dlist) > 0) {
+	 print_proof_comment(2, "Delete defining clauses for node N%d", XVARp(node));
+      }
+      delete_clauses(dlist);
+   }
+#if DO_TRACE
+   if (XVARp(node) == TRACE_NNAME)
+      printf("TRACE: Deleted node N%d from unique table\n", TRACE_NNAME);
+#endif 	 
+}
+#endif
+
+
+/*
+  Generational collection.  Children are always created before their
+  parents, and nodes are never modified (except by reordering, which ends
+  with a full collection).  So a node that has survived a collection
+  (an old node) can never refer to a node created since (a young node).
+  The young nodes can be collected by marking from the roots into the
+  young nodes only and sweeping just the young nodes.  Survivors become
+  old.  Dead old nodes are reclaimed by a full collection, which is done
+  once the old nodes have grown past oldlimit, or when a young collection
+  doesn't free enough nodes.
+ */
+
+static void bdd_addyoung(int n)
+{
+   if (youngcount >= youngalloc)
+   {
+      int newalloc = youngalloc == 0 ? 1024 : 2*youngalloc;
+      int *newyoung = (int*)realloc(youngnodes, sizeof(int)*newalloc);
+      if (newyoung == NULL)
+      {
+	 /* Fall back to collecting everything */
+	 oldlimit = -1;
+	 return;
+      }
+      youngnodes = newyoung;
+      youngalloc = newalloc;
+   }
+   youngnodes[youngcount++] = n;
+}
+
+
+static void bdd_mark_young(int i)
+{
+   BddNode *node;
+   int sp = 0;
+
+   MARKPUSH(sp, i);
+   while (sp > 0)
+   {
+      i = markstack[--sp];
+      if (i < 2)
+	 continue;
+
+      node = &bddnodes[i];
+      if ((NODEFLAGS(i) & (YOUNGMARK|MARKON)) != YOUNGMARK)
+	 continue;
+
+      SETMARK(i);
+
+      MARKPUSH(sp, HIGHp(node));
+      MARKPUSH(sp, LOWp(node));
+   }
+}
+
+
+static void bdd_gbc_young(void)
 {
    int *r;
-   int n;
+   int i, n;
    long int c2, c1 = clock();
    int freed = 0;
+   int kept;
+
+   if (gbc_handler != NULL)
+   {
+      bddGbcStat s;
+      s.nodes = bddnodesize;
+      s.freenodes = bddfreenum;
+      s.time = 0;
+      s.sumtime = gbcclock;
+      s.num = gbcollectnum;
+      gbc_handler(1, &s);
+   }
+
+   for (i=0 ; i<youngcount ; i++)
+      SETFLAGS(youngnodes[i], YOUNGMARK);
+
+   for (r=bddrefstack ; r<bddrefstacktop ; r++)
+      bdd_mark_young(*r);
+
+   for (i=0 ; i<youngcount ; i++)
+      if (REFCOU(youngnodes[i]) > 0)
+	 bdd_mark_young(youngnodes[i]);
 
 #if ENABLE_TBDD
-   int dbuf[4+ILIST_OVHD];
-   ilist dlist;
-   int id;
+   print_proof_comment(2, "Deleting clauses for young nodes that have been collected");
+#endif
+
+   for (i=youngcount-1 ; i>=0 ; i--)
+   {
+      register BddNode *node;
+
+      n = youngnodes[i];
+      node = &bddnodes[n];
+      if (MARKED(n))
+      {
+	 UNMARK(n);
+	 oldcount++;
+      }
+      else
+      {
+	 UNMARK(n);
+	 freed++;
+#if ENABLE_TBDD
+	 bdd_delete_dclauses(node);
+#endif
+	 unique_remove(n);
+	 LOWp(node) = -1;
+	 NEXTNODEp(node) = CHECKNODE(bddfreepos);
+	 bddfreepos = CHECKNODE(n);
+	 CHECKRANGE(bddfreenum++);
+      }
+   }
+   youngcount = 0;
+
+   kept = bdd_operator_clean();
+
+   c2 = clock();
+   gbcclock += c2-c1;
+   gbcollectnum++;
+   gbcyoungcollectnum++;
+
+   if (gbc_handler != NULL)
+   {
+      bddGbcStat s;
+      s.nodes = bddnodesize;
+      s.freenodes = bddfreenum;
+      s.time = c2-c1;
+      s.sumtime = gbcclock;
+      s.num = gbcollectnum;
+      s.prevfreednodes = freed;
+      s.cachekept = kept;
+      gbc_handler(0, &s);
+   }
+}
+
+
+void bdd_gbc_full(void)
+{
+   int *r;
+   int n;
+   long int c2, c1 = clock();
+   int freed = 0;
+   int kept;
 
 #if DO_TRACE
    printf("Starting GC\n");
 #endif   
-#endif
 
 
    if (gbc_handler != NULL)
@@ -1312,11 +1771,16 @@ void bdd_gbc(void)
 
    for (n=0 ; n<bddnodesize ; n++)
    {
-       if (bddnodes[n].refcou > 0) {
+       if (REFCOU(n) > 0) {
 	   bdd_mark(n);
        }
-      bddnodes[n].hash = 0;
+#ifndef OPEN_UNIQUE
+      HASHHEAD(n) = 0;
+#endif
    }
+#ifdef OPEN_UNIQUE
+   unique_clear();
+#endif
    
    bddfreepos = 0;
    bddfreenum = 0;
@@ -1329,60 +1793,46 @@ void bdd_gbc(void)
    {
       register BddNode *node = &bddnodes[n];
 
-      if ((LEVELp(node) & MARKON)  &&  LOWp(node) != -1)
+      if (MARKED(n)  &&  LOWp(node) != -1)
       {
+	 UNMARK(n);
+#ifdef OPEN_UNIQUE
+	 unique_insert(n);
+#else
 	 register unsigned int hash;
 
-	 LEVELp(node) &= MARKOFF;
 	 hash = NODEHASH(LEVELp(node), LOWp(node), HIGHp(node));
-	 node->next = bddnodes[hash].hash;
-	 bddnodes[hash].hash = n;
+	 NEXTNODEp(node) = HASHHEAD(hash);
+	 HASHHEAD(hash) = n;
+#endif
       }
       else
       {
-#if ENABLE_TBDD	  
-	  if (LOWp(node) != -1) {
-	      freed++;
-	      if (proof_type != PROOF_NONE) {
-		  dlist = ilist_make(dbuf, 4);
-		  /* Delete defining clauses */
-		  if ((id = bdd_dclause_p(node, DEF_HU)) != TAUTOLOGY)
-		      ilist_push(dlist, id);
-		  if ((id = bdd_dclause_p(node, DEF_LU)) != TAUTOLOGY)
-		      ilist_push(dlist, id);
-		  if ((id = bdd_dclause_p(node, DEF_HD)) != TAUTOLOGY)
-		      ilist_push(dlist, id);
-		  if ((id = bdd_dclause_p(node, DEF_LD)) != TAUTOLOGY)
-		      ilist_push(dlist, id);
-
-		  if (ilist_length(dlist) > 0) {
-		      print_proof_comment(2, "Delete defining clauses for node N%d", XVARp(node));
-		  }
-		  delete_clauses(dlist);
-	      }
-#if DO_TRACE && ENABLE_TBDD
-	      if (XVARp(node) == TRACE_NNAME)
-		  printf("TRACE: Deleted node N%d from unique table\n", TRACE_NNAME);
-#endif 	 
-
-	  }
-#else
 	 if (LOWp(node) != -1)
-	     freed++;
+	 {
+	    freed++;
+#if ENABLE_TBDD
+	    bdd_delete_dclauses(node);
 #endif
+	 }
 	 LOWp(node) = -1;
-	 node->next = CHECKNODE(bddfreepos);
+	 NEXTNODEp(node) = CHECKNODE(bddfreepos);
 	 bddfreepos = CHECKNODE(n);
 	 CHECKRANGE(bddfreenum++);
       }
    }
 
+   /* All surviving nodes are now old */
+   youngcount = 0;
+   oldcount = bddnodesize - bddfreenum - 2;
+   oldlimit = MAX(2*oldcount, bddnodesize/4);
+
 #if DO_TRACE
-   printf("Flushing caches\n");
+   printf("Cleaning caches\n");
 #endif   
 
 
-   bdd_operator_reset();
+   kept = bdd_operator_clean();
 
    c2 = clock();
    gbcclock += c2-c1;
@@ -1401,11 +1851,52 @@ void bdd_gbc(void)
       s.sumtime = gbcclock;
       s.num = gbcollectnum;
       s.prevfreednodes = freed;
+      s.cachekept = kept;
       gbc_handler(0, &s);
    }
 }
 
 
+void bdd_gbc(void)
+{
+   if (gbcgenerational  &&  oldcount <= oldlimit)
+   {
+      bdd_gbc_young();
+      if (!NODESLOW()  &&  oldcount <= oldlimit)
+	 return;
+   }
+   bdd_gbc_full();
+
+      /* Grow from the share of nodes that survived */
+   if (bddadaptive  &&  NODESLOW())
+      bdd_noderesize(1);
+}
+
+
+/*
+NAME    {* bdd\_setgenerational *}
+SECTION {* kernel *}
+SHORT   {* enable generational garbage collection *}
+PROTO   {* int bdd_setgenerational(int enable) *}
+DESCR   {* With generational collection, most garbage collections only
+           reclaim nodes created since the previous collection.  Nodes that
+	   survive are only reclaimed by an occasional full collection, done
+	   when the surviving nodes have doubled in number since the last full
+	   collection, or when collecting the new nodes does not free
+	   enough of the node table (see {\tt bdd\_setminfreenodes}).
+	   Disabled by default. *}
+RETURN  {* The previous setting *}
+ALSO    {* bdd\_gbc, bdd\_setminfreenodes *}
+*/
+int bdd_setgenerational(int enable)
+{
+   int old = gbcgenerational;
+   gbcgenerational = enable;
+   youngcount = 0;
+   return old;
+}
+
+
 /*
 NAME    {* bdd\_addref *}
 SECTION {* kernel *}
@@ -1463,98 +1954,157 @@ BDD bdd_delref(BDD root)
 
 /*=== RECURSIVE MARK / UNMARK ==========================================*/
 
+/*
+  The mark routines visit the nodes in the same order as a recursion,
+  low branch first, but keep the pending nodes on markstack.  A BDD
+  can have more levels than the C stack has room for frames.
+
+  Children are only pushed for a node that is newly visited, and the
+  low child is visited next.  The nodes with pending children thus
+  lie along a path, at increasing levels, and only the last of them
+  can have both children pending.  With num variables, the stack
+  never holds more than num+2 nodes.  It is allocated when the number
+  of variables changes, so that marking cannot run out of memory
+  partway through a garbage collection.
+*/
+static int markstack_reserve(int num)
+{
+   int newalloc = num + 2;
+   int *newstack;
+
+   if (newalloc <= markstackalloc)
+      return 1;
+   if ((newstack=(int*)realloc(markstack, sizeof(int)*newalloc)) == NULL)
+      return 0;
+   markstack = newstack;
+   markstackalloc = newalloc;
+   return 1;
+}
+
+
 void bdd_mark(int i)
 {
    BddNode *node;
-   
-   if (i < 2)
-      return;
+   int sp = 0;
 
-   node = &bddnodes[i];
-   if (LEVELp(node) & MARKON  ||  LOWp(node) == -1)
-      return;
-   
-   LEVELp(node) |= MARKON;
-   
-   bdd_mark(LOWp(node));
-   bdd_mark(HIGHp(node));
+   MARKPUSH(sp, i);
+   while (sp > 0)
+   {
+      i = markstack[--sp];
+      if (i < 2)
+	 continue;
+
+      node = &bddnodes[i];
+      if (MARKEDp(node)  ||  LOWp(node) == -1)
+	 continue;
+
+      SETMARKp(node);
+
+      MARKPUSH(sp, HIGHp(node));
+      MARKPUSH(sp, LOWp(node));
+   }
 }
 
 
 void bdd_mark_upto(int i, int level)
 {
-   BddNode *node = &bddnodes[i];
-   
-   if (i < 2)
-      return;
-   
-   if (LEVELp(node) & MARKON  ||  LOWp(node) == -1)
-      return;
-   
-   if (LEVELp(node) > level)
-      return;
+   BddNode *node;
+   int sp = 0;
+
+   MARKPUSH(sp, i);
+   while (sp > 0)
+   {
+      i = markstack[--sp];
+      if (i < 2)
+	 continue;
+
+      node = &bddnodes[i];
+      if (MARKEDp(node)  ||  LOWp(node) == -1)
+	 continue;
 
-   LEVELp(node) |= MARKON;
+      if (LEVELp(node) > level)
+	 continue;
 
-   bdd_mark_upto(LOWp(node), level);
-   bdd_mark_upto(HIGHp(node), level);
+      SETMARKp(node);
+
+      MARKPUSH(sp, HIGHp(node));
+      MARKPUSH(sp, LOWp(node));
+   }
 }
 
 
 void bdd_markcount(int i, int *cou)
 {
    BddNode *node;
-   
-   if (i < 2)
-      return;
+   int sp = 0;
 
-   node = &bddnodes[i];
-   if (MARKEDp(node)  ||  LOWp(node) == -1)
-      return;
-   
-   SETMARKp(node);
-   *cou += 1;
-   
-   bdd_markcount(LOWp(node), cou);
-   bdd_markcount(HIGHp(node), cou);
+   MARKPUSH(sp, i);
+   while (sp > 0)
+   {
+      i = markstack[--sp];
+      if (i < 2)
+	 continue;
+
+      node = &bddnodes[i];
+      if (MARKEDp(node)  ||  LOWp(node) == -1)
+	 continue;
+
+      SETMARKp(node);
+      *cou += 1;
+
+      MARKPUSH(sp, HIGHp(node));
+      MARKPUSH(sp, LOWp(node));
+   }
 }
 
 
 void bdd_unmark(int i)
 {
    BddNode *node;
-   
-   if (i < 2)
-      return;
+   int sp = 0;
 
-   node = &bddnodes[i];
+   MARKPUSH(sp, i);
+   while (sp > 0)
+   {
+      i = markstack[--sp];
+      if (i < 2)
+	 continue;
 
-   if (!MARKEDp(node)  ||  LOWp(node) == -1)
-      return;
-   UNMARKp(node);
-   
-   bdd_unmark(LOWp(node));
-   bdd_unmark(HIGHp(node));
+      node = &bddnodes[i];
+      if (!MARKEDp(node)  ||  LOWp(node) == -1)
+	 continue;
+      UNMARKp(node);
+
+      MARKPUSH(sp, HIGHp(node));
+      MARKPUSH(sp, LOWp(node));
+   }
 }
 
 
 void bdd_unmark_upto(int i, int level)
 {
-   BddNode *node = &bddnodes[i];
+   BddNode *node;
+   int sp = 0;
 
-   if (i < 2)
-      return;
-   
-   if (!(LEVELp(node) & MARKON))
-      return;
-   
-   LEVELp(node) &= MARKOFF;
-   
-   if (LEVELp(node) > level)
-      return;
+   MARKPUSH(sp, i);
+   while (sp > 0)
+   {
+      i = markstack[--sp];
+      if (i < 2)
+	 continue;
+
+      node = &bddnodes[i];
+      if (!MARKEDp(node))
+	 continue;
+
+      UNMARKp(node);
+
+      if (LEVELp(node) > level)
+	 continue;
 
-   bdd_unmark_upto(LOWp(node), level);
-   bdd_unmark_upto(HIGHp(node), level);
+      MARKPUSH(sp, HIGHp(node));
+      MARKPUSH(sp, LOWp(node));
+   }
 }
 
 
@@ -1565,7 +2115,13 @@ void bdd_unmark_upto(int i, int level)
 int bdd_makenode(unsigned int level, int low, int high)
 {
    register BddNode *node;
+#ifdef OPEN_UNIQUE
+   unsigned long long hv;
+   unsigned int slot;
+   unsigned char fp;
+#else
    register unsigned int hash;
+#endif
    register int res;
 
 #ifdef CACHESTATS
@@ -1577,8 +2133,32 @@ int bdd_makenode(unsigned int level, int low, int high)
       return low;
 
       /* Try to find an existing node of this kind */
+#ifdef OPEN_UNIQUE
+   hv = unique_hash(level, low, high);
+   slot = UNIQUESLOT(hv);
+   fp = UNIQUEFP(hv);
+
+   while (uniquefp[slot] != 0)
+   {
+      if (uniquefp[slot] == fp)
+      {
+	 res = uniquenode[slot];
+	 if (LEVEL(res) == level  &&  LOW(res) == low  &&  HIGH(res) == high)
+	 {
+#ifdef CACHESTATS
+	    bddcachestats.uniqueHit++;
+#endif
+	    return res;
+	 }
+      }
+      slot = (slot+1) & uniquemask;
+#ifdef CACHESTATS
+      bddcachestats.uniqueChain++;
+#endif
+   }
+#else
    hash = NODEHASH(level, low, high);
-   res = bddnodes[hash].hash;
+   res = HASHHEAD(hash);
 
    while(res != 0)
    {
@@ -1594,11 +2174,12 @@ int bdd_makenode(unsigned int level, int low, int high)
 #endif 	 
       }
 
-      res = CHECKNODE(bddnodes[res].next);
+      res = CHECKNODE(NEXTNODE(res));
 #ifdef CACHESTATS
       bddcachestats.uniqueChain++;
 #endif
    }
+#endif /* OPEN_UNIQUE */
    
    /* Error checking */
    if (level >= LEVEL(low))
@@ -1628,6 +2209,13 @@ int bdd_makenode(unsigned int level, int low, int high)
       
          /* Try to allocate more nodes */
       bdd_gbc();
+#ifdef OPEN_UNIQUE
+      /* Table has been rebuilt */
+      slot = unique_emptyslot(hv);
+#else
+      /* And may have grown */
+      hash = NODEHASH(level, low, high);
+#endif
 
       if (CHECKRANGE(bddnodesize-bddfreenum) >= usednodes_nextreorder  &&
 	  bdd_reorder_ready())
@@ -1635,10 +2223,14 @@ int bdd_makenode(unsigned int level, int low, int high)
 	 longjmp(bddexception,1);
       }
 
-      if ((bddfreenum*100) / bddnodesize <= minfreenodes)
+      if (NODESLOW())
       {
 	 bdd_noderesize(1);
+#ifdef OPEN_UNIQUE
+	 slot = unique_emptyslot(hv);
+#else
 	 hash = NODEHASH(level, low, high);
+#endif
       }
 
          /* Panic if that is not possible */
@@ -1652,7 +2244,7 @@ int bdd_makenode(unsigned int level, int low, int high)
 
       /* Build new node */
    res = CHECKNODE(bddfreepos);
-   bddfreepos = CHECKNODE(bddnodes[bddfreepos].next);
+   bddfreepos = CHECKNODE(NEXTNODE(bddfreepos));
    CHECKRANGE(bddfreenum--);
    bddproduced++;
    
@@ -1663,38 +2255,28 @@ int bdd_makenode(unsigned int level, int low, int high)
    
    #if ENABLE_TBDD
    if (level > 0) {
+       DCLAUSEp(node) = 0;
        if (proof_type == PROOF_NONE) {
 	   XVARp(node) = res;
-	   DCLAUSEp(node) = 0;
        } else {
-	   int nid = ++(*variable_counter);
-	   int vid = bdd_level2var(level);
-	   int hid = XVAR(high);
-	   int lid = XVAR(low);
-	   int hname = NNAME(high);
-	   int lname = NNAME(low);
-	   int dbuf[3+ILIST_OVHD];
-	   int abuf[2+ILIST_OVHD];
-	   ilist dlist = ilist_make(dbuf, 3);
-	   ilist alist = ilist_make(abuf, 2);
-	   int huid, luid;
-	   XVARp(node) = nid;
-	   DCLAUSEp(node) = *clause_id_counter + 1;
-	   print_proof_comment(2, "Defining clauses for node N%d = ITE(V%d (level=%d), N%d, N%d)", nid, vid, level, hname, lname);
-	   huid = generate_clause(defining_clause(dlist, DEF_HU, nid, vid, hid, lid), alist);
-	   luid = generate_clause(defining_clause(dlist, DEF_LU, nid, vid, hid, lid), alist);
-	   if (huid != TAUTOLOGY)
-	       ilist_push(alist, -huid);
-	   if (luid != TAUTOLOGY)
-	       ilist_push(alist, -luid);
-	   generate_clause(defining_clause(dlist, DEF_HD, nid, vid, hid, lid), alist);              
-	   generate_clause(defining_clause(dlist, DEF_LD, nid, vid, hid, lid), alist);       
+	   /* Extension variable assigned now.  Clauses possibly deferred */
+	   XVARp(node) = ++(*variable_counter);
+	   if (!lazy_defining)
+	       bdd_define_node(res);
        }
    }
    #endif
+   if (gbcgenerational)
+      bdd_addyoung(res);
+
       /* Insert node */
-   node->next = bddnodes[hash].hash;
-   bddnodes[hash].hash = res;
+#ifdef OPEN_UNIQUE
+   uniquefp[slot] = fp;
+   uniquenode[slot] = res;
+#else
+   NEXTNODEp(node) = HASHHEAD(hash);
+   HASHHEAD(hash) = res;
+#endif
 
 #if DO_TRACE && ENABLE_TBDD
 	 if (NNAME(res) == TRACE_NNAME)
@@ -1704,46 +2286,398 @@ int bdd_makenode(unsigned int level, int low, int high)
 }
 
 
-int bdd_noderesize(int doRehash)
+/*
+  Called by the main thread when a parallel operation has run out of
+  nodes.  The operation starts over, and so its partial results are
+  garbage.  Collect them and grow the table.  Returns 0 if the table
+  could not grow.
+*/
+int bdd_morenodes(void)
+{
+   int oldsize = bddnodesize;
+
+   bdd_gbc();
+   bdd_noderesize(1);
+   return bddnodesize > oldsize;
+}
+
+
+#ifndef OPEN_UNIQUE
+/*
+  Node creation for the parallel operations in papply.c.  Several
+  threads may call bdd_makenode_mt at once, but there is no garbage
+  collection, resizing or other node creation in the meantime.  Each
+  thread reserves a batch of nodes from the free list, and pushes new
+  nodes onto their hash chain with a compare-and-swap, searching again
+  whatever was pushed ahead of it.  Returns -1 when there are no free
+  nodes left.
+*/
+
+#define NODEALLOC_BATCH 256
+
+#define freelistlock (bddmanager->kernel.freelistlock)
+
+static int bdd_reservenodes(BddNodeAlloc *alloc)
+{
+   int n, last = 0, count = 0;
+
+   while (__atomic_test_and_set(&freelistlock, __ATOMIC_ACQUIRE))
+      ;
+   for (n=bddfreepos ; n != 0  &&  count < NODEALLOC_BATCH ; n=NEXTNODE(n))
+   {
+      last = n;
+      count++;
+   }
+   if (count > 0)
+   {
+      alloc->freechain = bddfreepos;
+      NEXTNODE(last) = 0;
+      bddfreepos = n;
+      bddfreenum -= count;
+   }
+   __atomic_clear(&freelistlock, __ATOMIC_RELEASE);
+   return count;
+}
+
+
+int bdd_makenode_mt(BddNodeAlloc *alloc, unsigned int level, int low, int high)
+{
+   unsigned int hash;
+   int head, stop = 0;
+   int res, n = 0;
+
+   if (low == high)
+      return low;
+
+   hash = NODEHASH(level, low, high);
+   head = __atomic_load_n(&HASHHEAD(hash), __ATOMIC_ACQUIRE);
+
+   for (;;)
+   {
+	 /* Search the part of the chain not yet seen */
+      for (res=head ; res != stop ; res=NEXTNODE(res))
+      {
+	 if (LEVEL(res) == level  &&  LOW(res) == low  &&  HIGH(res) == high)
+	 {
+	    alloc->uniqueHit++;
+	    if (n != 0)
+	    {
+	       LOW(n) = -1;
+	       NEXTNODE(n) = alloc->freechain;
+	       alloc->freechain = n;
+	    }
+	    return res;
+	 }
+	 alloc->uniqueChain++;
+      }
+
+      if (n == 0)
+      {
+	 if (alloc->freechain == 0  &&  bdd_reservenodes(alloc) == 0)
+	    return -1;
+	 n = alloc->freechain;
+	 alloc->freechain = NEXTNODE(n);
+	 LEVEL(n) = level;
+	 LOW(n) = low;
+	 HIGH(n) = high;
+#if ENABLE_TBDD
+	 if (level > 0)
+	 {
+	    DCLAUSE(n) = 0;
+	    XVAR(n) = n;
+	 }
+#endif
+      }
+
+      NEXTNODE(n) = head;
+      stop = head;
+      if (__atomic_compare_exchange_n(&HASHHEAD(hash), &head, n, 0,
+				      __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+	 break;
+   }
+
+   alloc->uniqueMiss++;
+   if (alloc->createdcount >= alloc->createdalloc)
+   {
+      int newalloc = alloc->createdalloc == 0 ? 1024 : 2*alloc->createdalloc;
+      int *newcreated = (int*)realloc(alloc->created, sizeof(int)*newalloc);
+      if (newcreated == NULL)
+	 alloc->createdlost = 1;
+      else
+      {
+	 alloc->created = newcreated;
+	 alloc->createdalloc = newalloc;
+      }
+   }
+   if (alloc->createdcount < alloc->createdalloc)
+      alloc->created[alloc->createdcount++] = n;
+   return n;
+}
+
+
+/*
+  Called by the main thread once the other threads are done.  Return
+  the unused nodes to the free list, and account for the new ones.
+*/
+void bdd_nodealloc_done(BddNodeAlloc *alloc)
+{
+   int n, last = 0, count = 0;
+
+   for (n=alloc->freechain ; n != 0 ; n=NEXTNODE(n))
+   {
+      last = n;
+      count++;
+   }
+   if (count > 0)
+   {
+      NEXTNODE(last) = bddfreepos;
+      bddfreepos = alloc->freechain;
+      bddfreenum += count;
+   }
+   alloc->freechain = 0;
+
+   bddproduced += alloc->createdcount;
+   if (gbcgenerational)
+      for (n=0 ; n<alloc->createdcount ; n++)
+	 bdd_addyoung(alloc->created[n]);
+   if (alloc->createdlost)
+      /* Fall back to collecting everything */
+      oldlimit = -1;
+   alloc->createdcount = 0;
+   alloc->createdlost = 0;
+
+#ifdef CACHESTATS
+   bddcachestats.uniqueAccess += alloc->uniqueHit + alloc->uniqueMiss;
+   bddcachestats.uniqueHit += alloc->uniqueHit;
+   bddcachestats.uniqueMiss += alloc->uniqueMiss;
+   bddcachestats.uniqueChain += alloc->uniqueChain;
+#endif
+   alloc->uniqueHit = alloc->uniqueMiss = alloc->uniqueChain = 0;
+}
+
+
+/*
+  Look up a node without creating it.  Returns -1 if there is none.
+  Several threads may call this at once while no nodes are created.
+*/
+int bdd_findnode(unsigned int level, int low, int high)
+{
+   int res;
+
+   if (low == high)
+      return low;
+   for (res=HASHHEAD(NODEHASH(level,low,high)) ; res != 0 ; res=NEXTNODE(res))
+      if (LEVEL(res) == level  &&  LOW(res) == low  &&  HIGH(res) == high)
+	 return res;
+   return -1;
+}
+#endif /* OPEN_UNIQUE */
+
+
+#if ENABLE_TBDD
+   /* Node still needs its defining clauses */
+#define UNDEFINED(n) ((n) >= 2  &&  DCLAUSE(n) == 0)
+
+/*
+  Generate defining clauses for node, once those of its children exist
+ */
+static void bdd_define_one(int r)
+{
+   int nid = XVAR(r);
+   int level = LEVEL(r);
+   int vid = bdd_level2var(level);
+   int hid = XVAR(HIGH(r));
+   int lid = XVAR(LOW(r));
+   int hname = NNAME(HIGH(r));
+   int lname = NNAME(LOW(r));
+   ival_t dbuf[3+ILIST_OVHD];
+   ival_t abuf[2+ILIST_OVHD];
+   ilist dlist = ilist_make(dbuf, 3);
+   ilist alist = ilist_make(abuf, 2);
+   clause_id_t huid, luid;
+   DCLAUSE(r) = *clause_id_counter + 1;
+   defined_node_count++;
+   print_proof_comment(2, "Defining clauses for node N%d = ITE(V%d (level=%d), N%d, N%d)", nid, vid, level, hname, lname);
+   huid = generate_clause(defining_clause(dlist, DEF_HU, nid, vid, hid, lid), alist);
+   luid = generate_clause(defining_clause(dlist, DEF_LU, nid, vid, hid, lid), alist);
+   if (huid != TAUTOLOGY)
+       ilist_push(alist, -huid);
+   if (luid != TAUTOLOGY)
+       ilist_push(alist, -luid);
+   generate_clause(defining_clause(dlist, DEF_HD, nid, vid, hid, lid), alist);              
+   generate_clause(defining_clause(dlist, DEF_LD, nid, vid, hid, lid), alist);       
+}
+
+/*
+  Generate defining clauses for node.
+  With lazy generation, this occurs the first time the node's
+  extension variable or one of its defining clauses is used in the proof.
+  The clauses for the node's descendants must be generated first, since
+  the extension variable must not occur in any earlier clause.
+  The undefined nodes are visited in post-order, low branch first, as
+  in a recursion, but with the pending nodes on markstack.  Each is a
+  child of the one below it, and so there are fewer than the number of
+  levels.
+ */
+void bdd_define_node(int r)
+{
+   int sp = 0;
+
+   if (r < 2 || proof_type == PROOF_NONE || DCLAUSE(r) != 0)
+       return;
+   MARKPUSH(sp, r);
+   while (sp > 0)
+   {
+      int n = markstack[sp-1];
+
+      if (UNDEFINED(LOW(n)))
+	 MARKPUSH(sp, LOW(n));
+      else if (UNDEFINED(HIGH(n)))
+	 MARKPUSH(sp, HIGH(n));
+      else
+      {
+	 sp--;
+	 bdd_define_one(n);
+      }
+   }
+}
+#endif
+
+/* Resize array k of the node table to n elements of type t.  Returns
+   NULL, leaving the array and its recorded size unchanged, if out of
+   memory */
+#define NODETABLE_RESIZE(p,k,t,n) \
+   nodetable_resize((p), (k), sizeof(t)*(size_t)(n))
+
+static void *nodetable_resize(void *p, int k, size_t size)
+{
+   void *np = bdd_vm_realloc(p, nodetablealloc[k], size, bddhugepages);
+
+   if (np != NULL)
+      nodetablealloc[k] = size;
+   return np;
+}
+
+/* Reallocate all of the node arrays.  Return 0 if out of memory.
+   Arrays grown before one that could not be may then be larger than
+   the node table, and are freed with the sizes recorded in
+   nodetablealloc */
+static int bdd_nodetable_resize(int size)
 {
    BddNode *newnodes;
+   bddrefcount *newrefcou;
+   int *newhash, *newnext;
+#if ENABLE_TBDD
+   BddProofInfo *newproof;
+#endif
+
+   if ((newnodes=(BddNode*)NODETABLE_RESIZE(bddnodes, NT_NODES, BddNode, size)) == NULL)
+      return 0;
+   bddnodes = newnodes;
+   if ((newrefcou=(bddrefcount*)NODETABLE_RESIZE(bddrefcou, NT_REFCOU, bddrefcount, size)) == NULL)
+      return 0;
+   bddrefcou = newrefcou;
+   if ((newhash=(int*)NODETABLE_RESIZE(bddhash, NT_HASH, int, size)) == NULL)
+      return 0;
+   bddhash = newhash;
+   if ((newnext=(int*)NODETABLE_RESIZE(bddnext, NT_NEXT, int, size)) == NULL)
+      return 0;
+   bddnext = newnext;
+#if ENABLE_TBDD
+   if ((newproof=(BddProofInfo*)NODETABLE_RESIZE(bddproof, NT_PROOF, BddProofInfo, size)) == NULL)
+      return 0;
+   bddproof = newproof;
+#endif
+#ifdef OPEN_UNIQUE
+   {
+      /* Rebuilt by caller */
+      int bits = 1;
+      unsigned char *newfp;
+      int *newnode;
+
+      while ((1LL << bits) < 2LL * size)
+	 bits++;
+      if ((newfp=(unsigned char*)NODETABLE_RESIZE(uniquefp, NT_UNIQUEFP, unsigned char, (size_t) 1 << bits)) == NULL)
+	 return 0;
+      uniquefp = newfp;
+      if ((newnode=(int*)NODETABLE_RESIZE(uniquenode, NT_UNIQUENODE, int, (size_t) 1 << bits)) == NULL)
+	 return 0;
+      uniquenode = newnode;
+      uniquebits = bits;
+      uniquemask = (unsigned int) ((1LL << bits) - 1);
+      unique_clear();
+   }
+#endif
+   return 1;
+}
+
+
+int bdd_noderesize(int doRehash)
+{
    int oldsize = bddnodesize;
    int n;
 
    if (bddnodesize >= bddmaxnodesize  &&  bddmaxnodesize > 0)
       return -1;
+   if (bddnodesize >= MAXNODENUM)
+      return -1;
    
-   bddnodesize = bddnodesize << 1;
+   if (bddadaptive)
+   {
+	 /* Leave half of the table free, growing it by at least a quarter */
+      long long int live = oldsize - bddfreenum;
+      long long int size = MAX(2*live, oldsize + oldsize/4);
 
-   if (bddnodesize > oldsize + bddmaxnodeincrease)
-      bddnodesize = oldsize + bddmaxnodeincrease;
+      bddnodesize = (int) MIN(size, MAXNODENUM);
+   }
+   else
+   {
+      bddnodesize = bddnodesize << 1;
+
+      if (bddnodesize > oldsize + bddmaxnodeincrease)
+	 bddnodesize = oldsize + bddmaxnodeincrease;
+   }
 
    if (bddnodesize > bddmaxnodesize  &&  bddmaxnodesize > 0)
       bddnodesize = bddmaxnodesize;
 
+   if (bddnodesize > MAXNODENUM)
+      bddnodesize = MAXNODENUM;
+
+   if (bddmemlimit > 0  &&  bddnodesize > bdd_memnodenum(bddmemlimit))
+      bddnodesize = bdd_memnodenum(bddmemlimit);
+
    bddnodesize = bdd_prime_lte(bddnodesize);
+   if (bddnodesize <= oldsize)
+   {
+      bddnodesize = oldsize;
+      return -1;
+   }
    
    if (resize_handler != NULL)
       resize_handler(oldsize, bddnodesize);
 
-   newnodes = (BddNode*)realloc(bddnodes, sizeof(BddNode)*bddnodesize);
-   if (newnodes == NULL)
+   if (!bdd_nodetable_resize(bddnodesize))
+   {
+	 /* Arrays already grown keep their new size in nodetablealloc,
+	    and their nodes from oldsize up are not used */
+      bddnodesize = oldsize;
       return bdd_error(BDD_MEMORY);
-   bddnodes = newnodes;
+   }
 
    if (doRehash)
       for (n=0 ; n<oldsize ; n++)
-	 bddnodes[n].hash = 0;
+	 HASHHEAD(n) = 0;
    
    for (n=oldsize ; n<bddnodesize ; n++)
    {
-      bddnodes[n].refcou = 0;
-      bddnodes[n].hash = 0;
+      REFCOU(n) = 0;
+      HASHHEAD(n) = 0;
       LEVEL(n) = 0;
       LOW(n) = -1;
-      bddnodes[n].next = n+1;
+      NEXTNODE(n) = n+1;
    }
-   bddnodes[bddnodesize-1].next = CHECKNODE(bddfreepos);
+   NEXTNODE(bddnodesize-1) = CHECKNODE(bddfreepos);
    bddfreepos = CHECKNODE(oldsize);
    bddfreenum += CHECKRANGE(bddnodesize - oldsize);
 
@@ -1751,6 +2685,7 @@ int bdd_noderesize(int doRehash)
       bdd_gbc_rehash();
 
    bddresized = 1;
+   noderesizenum++;
    return 0;
 }
 
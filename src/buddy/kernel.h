@@ -78,6 +78,7 @@
 
 #include <limits.h>
 #include <setjmp.h>
+#include "vmem.h"
 
 #if ENABLE_TBDD
 #include "tbdd.h"
@@ -136,75 +137,80 @@
 
 /*=== SEMI-INTERNAL TYPES ==============================================*/
 
+/*
+   The node table is split into several arrays indexed by node number.
+   BddNode holds the fields read when traversing BDDs.  Reference counts,
+   hash chains, and proof information are kept in separate arrays, so
+   that operations such as apply touch only 12 bytes per node.
+ */
 typedef struct s_BddNode /* Node table entry */
 {
-   unsigned int refcou : 10;
-   unsigned int level  : 22;
+   unsigned int level;   /* Includes GC flags in the top two bits */
    int low;
    int high;
-   int hash;
-   int next;
+} BddNode;
+
 #if ENABLE_TBDD
+typedef struct s_BddProofInfo /* Proof information for node */
+{
    int xvar;     /* Associated extension variable */
-   int dclause;  /* Base index of defining clause */
+   clause_id_t dclause;  /* Base index of defining clause */
+} BddProofInfo;
 #endif /* ENABLE_TBDD */
-} BddNode;
 
 
 /*=== KERNEL VARIABLES =================================================*/
 
-#ifdef CPLUSPLUS
-extern "C" {
-#endif
-
-extern int       bddrunning;         /* Flag - package initialized */
-extern int       bdderrorcond;       /* Some error condition was met */
-extern int       bddnodesize;        /* Number of allocated nodes */
-extern int       bddmaxnodesize;     /* Maximum allowed number of nodes */
-extern int       bddmaxnodeincrease; /* Max. # of nodes used to inc. table */
-extern BddNode*  bddnodes;           /* All of the bdd nodes */
-extern int       bddvarnum;          /* Number of defined BDD variables */
-extern int*      bddrefstack;        /* Internal node reference stack */
-extern int*      bddrefstacktop;     /* Internal node reference stack top */
-extern int*      bddvar2level;
-extern int*      bddlevel2var;
-extern jmp_buf   bddexception;
-extern int       bddreorderdisabled;
-extern int       bddresized;
-extern bddCacheStat bddcachestats;
-
-#ifdef CPLUSPLUS
-}
-#endif
+   /* The kernel variables, such as bddnodes, are fields of the current
+      manager.  See manager.h, included at the end of this file */
 
 
 /*=== KERNEL DEFINITIONS ===============================================*/
 
-/* 
-   Note: Although have 22 bits allocated for variable, upper bit
-   required for mark bit used in GC.  That leaves 21 bits available
-   for actual level number
- */
-#define MAXVAR 0x1FFFFF
+   /* The top two bits of the level hold the GC flags, see MARKON */
+#define MAXVAR 0x3FFFFFFF
+#ifdef WIDE_NODES
+   /* Full 32-bit reference counts, which saturate only in pathological cases */
+#define MAXREF 0xFFFFFFFF
+typedef unsigned int bddrefcount;
+#else
 #define MAXREF 0x3FF
+typedef unsigned short bddrefcount;
+#endif
+#define MAXNODENUM 0x3FFFFFFF  /* Leaves two bits free in cache entries */
+
+   /* Access to fields kept outside of BddNode */
+#define NODEINDEX(p)  ((int) ((p) - bddnodes))
+#define REFCOU(n)     (bddrefcou[n])
+#define HASHHEAD(n)   (bddhash[n])
+#define NEXTNODE(n)   (bddnext[n])
+#define REFCOUp(p)    (bddrefcou[NODEINDEX(p)])
+#define HASHHEADp(p)  (bddhash[NODEINDEX(p)])
+#define NEXTNODEp(p)  (bddnext[NODEINDEX(p)])
 
    /* Reference counting */
-#define DECREF(n) if (bddnodes[n].refcou!=MAXREF && bddnodes[n].refcou>0) bddnodes[n].refcou--
-#define INCREF(n) if (bddnodes[n].refcou<MAXREF) bddnodes[n].refcou++
-#define DECREFp(n) if (n->refcou!=MAXREF && n->refcou>0) n->refcou--
-#define INCREFp(n) if (n->refcou<MAXREF) n->refcou++
-#define HASREF(n) (bddnodes[n].refcou > 0)
+#define DECREF(n) if (REFCOU(n)!=MAXREF && REFCOU(n)>0) REFCOU(n)--
+#define INCREF(n) if (REFCOU(n)<MAXREF) REFCOU(n)++
+#define DECREFp(n) if (REFCOUp(n)!=MAXREF && REFCOUp(n)>0) REFCOUp(n)--
+#define INCREFp(n) if (REFCOUp(n)<MAXREF) REFCOUp(n)++
+#define HASREF(n) (REFCOU(n) > 0)
+
+   /* Node flags used by the garbage collector and by traversals */
+#define MARKON    0x80000000    /* Bit used to mark a node (1) */
+#define YOUNGMARK 0x40000000    /* Node is young during a young collection */
+#define MARKOFF   0x3FFFFFFF    /* - unmark */
+#define MARKHIDE  0x3FFFFFFF
+#define NODEFLAGS(n)  (bddnodes[n].level & ~MARKHIDE)
+#define SETFLAGS(n,f) (bddnodes[n].level |= (f))
+#define CLEARFLAGS(n) (bddnodes[n].level &= MARKOFF)
 
    /* Marking BDD nodes */
-#define MARKON   0x200000    /* Bit used to mark a node (1) */
-#define MARKOFF  0x1FFFFF    /* - unmark */
-#define MARKHIDE 0x1FFFFF
-#define SETMARK(n)  (bddnodes[n].level |= MARKON)
-#define UNMARK(n)   (bddnodes[n].level &= MARKOFF)
-#define MARKED(n)   (bddnodes[n].level & MARKON)
-#define SETMARKp(p) (node->level |= MARKON)
-#define UNMARKp(p)  (node->level &= MARKOFF)
-#define MARKEDp(p)  (node->level & MARKON)
+#define SETMARK(n)  SETFLAGS(n, MARKON)
+#define UNMARK(n)   CLEARFLAGS(n)
+#define MARKED(n)   (NODEFLAGS(n) & MARKON)
+#define SETMARKp(p) SETMARK(NODEINDEX(p))
+#define UNMARKp(p)  UNMARK(NODEINDEX(p))
+#define MARKEDp(p)  MARKED(NODEINDEX(p))
 
    /* Hashfunctions */
 
@@ -224,10 +230,10 @@ extern bddCacheStat bddcachestats;
 #define HIGHp(p)    ((p)->high)
 
 #if ENABLE_TBDD
-#define XVAR(a)      (bddnodes[a].xvar)
-#define DCLAUSE(a)   (bddnodes[a].dclause)
-#define XVARp(p)     ((p)->xvar)
-#define DCLAUSEp(p)  ((p)->dclause)
+#define XVAR(a)      (bddproof[a].xvar)
+#define DCLAUSE(a)   (bddproof[a].dclause)
+#define XVARp(p)     (bddproof[NODEINDEX(p)].xvar)
+#define DCLAUSEp(p)  (bddproof[NODEINDEX(p)].dclause)
 #define NNAME(a) ((a) < 2?(a):XVAR(a))
 #endif /* ENABLE_TBDD */
 
@@ -252,11 +258,35 @@ extern bddCacheStat bddcachestats;
 
 #define DEFAULTMAXNODEINC 50000
 
+   /* With adaptive sizing, grow the node table when more than this
+      percentage of it survives a garbage collection */
+#define ADAPTMAXLIVE 50
+
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 #define ABS(a) ((a)<0?-(a):(a))
 #define NEW(t,n) ( (t*)malloc(sizeof(t)*(n)) )
 
+   /* Large tables, see vmem.c */
+#define VMRESIZE(p,t,oldn,n) \
+   bdd_vm_realloc((p), sizeof(t)*(size_t)(oldn), sizeof(t)*(size_t)(n), bddhugepages)
+#define VMFREE(p,t,n) bdd_vm_free((p), sizeof(t)*(size_t)(n))
+
+#ifndef OPEN_UNIQUE
+   /* Node creation by one of several threads, for papply.c */
+typedef struct s_BddNodeAlloc
+{
+   int freechain;       /* Free nodes reserved by the thread */
+   int *created;        /* Nodes created by the thread */
+   int createdcount;
+   int createdalloc;
+   int createdlost;     /* Some were not recorded */
+   long unsigned int uniqueHit;
+   long unsigned int uniqueMiss;
+   long unsigned int uniqueChain;
+} BddNodeAlloc;
+#endif
+
 
 /*=== KERNEL PROTOTYPES ================================================*/
 
@@ -267,12 +297,20 @@ extern "C" {
 extern int    bdd_error(int);
 extern int    bdd_makenode(unsigned int, int, int);
 extern int    bdd_noderesize(int);
+extern void   bdd_gbc_full(void);
+extern int    bdd_morenodes(void);
+#ifndef OPEN_UNIQUE
+extern int    bdd_makenode_mt(BddNodeAlloc*, unsigned int, int, int);
+extern void   bdd_nodealloc_done(BddNodeAlloc*);
+extern int    bdd_findnode(unsigned int, int, int);
+#endif
 extern void   bdd_checkreorder(void);
 extern void   bdd_mark(int);
 extern void   bdd_mark_upto(int, int);
 extern void   bdd_markcount(int, int*);
 extern void   bdd_unmark(int);
 extern void   bdd_unmark_upto(int, int);
+extern int    bdd_memroom(size_t);
 extern void   bdd_register_pair(bddPair*);
 extern int   *fdddec2bin(int, int);
 
@@ -280,6 +318,13 @@ extern int    bdd_operator_init(int);
 extern void   bdd_operator_done(void);
 extern void   bdd_operator_varresize(void);
 extern void   bdd_operator_reset(void);
+extern int    bdd_operator_clean(void);
+extern size_t bdd_operator_cachebytes(int);
+
+extern void   bdd_papply_reset(void);
+extern void   bdd_papply_done(void);
+extern int    bdd_papply(BDD, BDD, int, BDD*);
+extern int    bdd_apply_terminal(int, BDD, BDD);
 
 extern void   bdd_pairs_init(void);
 extern void   bdd_pairs_done(void);
@@ -308,22 +353,88 @@ extern void   bdd_cpp_init(void);
 /* Data type for proof-generating operations */
 typedef struct {
     BDD root;
-    int clause_id;
+    clause_id_t clause_id;
 } pcbdd;
 
+/* In file kernel.c */
+/* Make sure defining clauses of node and its descendants have been generated */
+extern void bdd_define_node(int r);
+
 /* In file prover.c */
 /* Complete proof of apply operation */
 /* Absolute of returned value indicates the ID of the justifying proof step */
 /* Value will be < 0 when previous clause ID also used as intermediate step */
-extern int justify_apply(int op, BDD l, BDD r, int splitVar, pcbdd tresl, pcbdd tresh, BDD res);
+extern clause_id_t justify_apply(int op, BDD l, BDD r, int splitVar, pcbdd tresl, pcbdd tresh, BDD res);
+
+/*
+  Proof steps of one task in a parallel operation.  Clause IDs above
+  first_id are provisional, two for each step: step_id+1 for an
+  intermediate clause, and step_id+2 for the justifying one.  Once the
+  tasks are done, pbuffer_emit writes their steps in order, recording
+  the final IDs in final_ids, and PBUFFER_ID gives the final ID of a
+  provisional one already written.  Helper threads must not write the
+  proof or call bdd_error, so a task's errors are deferred: the first
+  is recorded, with step_id left at the failed step, for the calling
+  thread to raise.
+*/
+typedef struct {
+    ival_t *data;       /* Records of added and deleted clauses */
+    int count;
+    int alloc;
+    clause_id_t first_id;
+    clause_id_t step_id;        /* Set before each step */
+    clause_id_t *final_ids;     /* Indexed by provisional ID - first_id - 1 */
+    void *hints;        /* Working state of justify_apply */
+    int step_count;     /* Steps justified, and those split in two */
+    int split_count;
+    int defer;          /* Record errors in error rather than raising them */
+    int error;          /* Error of a failed step, or 0.  Set when deferred */
+} pbuffer;
+
+#define PBUFFER_ID(pb,id) ((id) != TAUTOLOGY && (id) > (pb)->first_id ? (pb)->final_ids[(id)-(pb)->first_id-1] : (id))
+
+extern int  pbuffer_init(pbuffer *pb);
+extern void pbuffer_reset(pbuffer *pb, clause_id_t first_id, clause_id_t *final_ids);
+extern void pbuffer_emit(pbuffer *pb);
+extern void pbuffer_free(pbuffer *pb);
+/* Same as justify_apply, but the steps go to the buffer */
+extern clause_id_t justify_apply_buffer(pbuffer *pb, int op, BDD l, BDD r, int splitVar, pcbdd tresl, pcbdd tresh, BDD res);
 
 /* In file bddop.c */
 /* Low-level functions to implement operations on TBDDs */
 pcbdd      bdd_and_justify(BDD, BDD);    
 pcbdd      bdd_imptst_justify(BDD, BDD);    
 pcbdd      bdd_and_imptst_justify(BDD, BDD, BDD);    
+extern int  bdd_proofcache_find(BDD, BDD, pcbdd*);
+extern void bdd_proofcache_insert(BDD, BDD, pcbdd);
+
+/* In file papply.c */
+/* Parallel proof of conjunction.  The result must already have been built */
+extern int  bdd_pjustify_ready(BDD, BDD);
+extern void bdd_pjustify(BDD, BDD);
+
+#endif
 
+   /* Pending subproblem of apply_rec, quant_rec, applyj_rec,
+      apply_aij_rec or pjustify_list.  These recurse as deep as the
+      BDDs, which can be more than the C stack holds, so they keep
+      their subproblems on explicit stacks of frames.  A frame is
+      visited once to solve its low branch and once for its high
+      branch.  Each routine has its own stack, since none of them is
+      entered again while it runs */
+typedef struct s_BddFrame
+{
+   BDD l, r, t;          /* Operands */
+   int high;             /* Set once the low branch is solved */
+#if ENABLE_TBDD
+   pcbdd tresl;          /* Result of the low branch */
 #endif
+} BddFrame;
+
+   /* In file bddop.c */
+extern int    bdd_framestack_reserve(BddFrame **, int *, int);
+
+#include "manager.h"
 
 #endif /* _KERNEL_H */
 
@@ -0,0 +1,175 @@
+/*========================================================================
+  Copyright (c) 2022 Randal E. Bryant, Carnegie Mellon University
+  
+  This code was not included in the original BuDDy distribution and is
+  therefore not subject to any of its licensing terms.
+
+  Permission is hereby granted, free of
+  charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+========================================================================*/
+
+/*************************************************************************
+  FILE:  manager.c
+  DESCR: BDD managers.  All state of the package is held in a manager
+	 (see manager.h), and each thread works with its current one.
+	 Threads start out with the default manager, so that programs
+	 using a single manager need not know about them.
+*************************************************************************/
+#include <stdlib.h>
+#include "kernel.h"
+
+   /* Initial state of a manager.  Fields not listed start out as 0 */
+#if ENABLE_TBDD
+#define MANAGER_INIT_TBDD \
+   .prover = { .vars = { PROOF_FRAT, 1 },  /* proof_type, verbosity_level */ \
+	       .empty_clause_id = TAUTOLOGY },
+#else
+#define MANAGER_INIT_TBDD
+#endif
+
+#define MANAGER_INIT \
+{ \
+   .kernel = { .gbcminfreenodes = 20, .hugepages = 1 }, \
+   .papply = { .papplythreads = 1, \
+	       .poollock = PTHREAD_MUTEX_INITIALIZER, \
+	       .poolcond = PTHREAD_COND_INITIALIZER }, \
+   MANAGER_INIT_TBDD \
+}
+
+static BddManager bdddefaultmanager = MANAGER_INIT;
+static const BddManager bddmanagerinit = MANAGER_INIT;
+
+__thread BddManager *bddmanager = &bdddefaultmanager;
+#if ENABLE_TBDD
+__thread prover_vars_t *prover_vars = &bdddefaultmanager.prover.vars;
+#endif
+
+
+/*
+NAME    {* bdd\_newmanager *}
+SECTION {* kernel *}
+SHORT   {* creates a BDD manager *}
+PROTO   {* BddManager* bdd_newmanager(void) *}
+DESCR   {* Creates a manager with a state of its own: node table,
+	   caches, variables, and, when generating proofs, the proof
+	   file and clause counters.  The new manager is not selected.
+	   Once selected with {\tt bdd\_setmanager}, it is started with
+	   {\tt bdd\_init} or {\tt tbdd\_init} like the default one.
+	   Managers are independent, so separate threads can each solve a
+	   problem with their own, but a manager must only be used by one
+	   thread at a time. *}
+RETURN  {* The new manager, or NULL if out of memory. *}
+ALSO    {* bdd\_setmanager, bdd\_deletemanager *}
+*/
+BddManager *bdd_newmanager(void)
+{
+   BddManager *m = NEW(BddManager,1);
+
+   if (m == NULL)
+      return NULL;
+   *m = bddmanagerinit;
+   pthread_mutex_init(&m->papply.poollock, NULL);
+   pthread_cond_init(&m->papply.poolcond, NULL);
+   return m;
+}
+
+
+/*
+NAME    {* bdd\_deletemanager *}
+SECTION {* kernel *}
+SHORT   {* deletes a BDD manager *}
+PROTO   {* void bdd_deletemanager(BddManager *m) *}
+DESCR   {* Calls {\tt bdd\_done} for the manager, if still running, and
+	   frees it.  When generating a proof, call {\tt tbdd\_done} with
+	   the manager selected first.  The manager must not be the
+	   current one of another thread.  If it is the current one of
+	   the calling thread, the thread goes back to the default
+	   manager.  The default manager cannot be deleted. *}
+ALSO    {* bdd\_newmanager, bdd\_done *}
+*/
+void bdd_deletemanager(BddManager *m)
+{
+   BddManager *old;
+
+   if (m == NULL  ||  m == &bdddefaultmanager)
+      return;
+
+   old = bdd_setmanager(m);
+   if (bddrunning)
+      bdd_done();
+   bdd_setmanager(old == m ? NULL : old);
+
+   pthread_mutex_destroy(&m->papply.poollock);
+   pthread_cond_destroy(&m->papply.poolcond);
+   free(m);
+}
+
+
+/*
+NAME    {* bdd\_setmanager *}
+SECTION {* kernel *}
+SHORT   {* selects the manager of the calling thread *}
+PROTO   {* BddManager* bdd_setmanager(BddManager *m) *}
+DESCR   {* All further calls to the package by the calling thread work
+	   with manager {\tt m}, or with the default manager when
+	   {\tt m} is NULL.  This includes the variables exported by
+	   the prover, such as {\tt verbosity\_level}. *}
+RETURN  {* The previous manager of the thread. *}
+ALSO    {* bdd\_newmanager, bdd\_getmanager *}
+*/
+BddManager *bdd_setmanager(BddManager *m)
+{
+   BddManager *old = bddmanager;
+
+   if (m == NULL)
+      m = &bdddefaultmanager;
+   bddmanager = m;
+#if ENABLE_TBDD
+   prover_vars = &m->prover.vars;
+#endif
+   return old;
+}
+
+
+/*
+NAME    {* bdd\_getmanager *}
+SECTION {* kernel *}
+SHORT   {* returns the manager of the calling thread *}
+PROTO   {* BddManager* bdd_getmanager(void) *}
+DESCR   {* Returns the manager used by the calling thread. *}
+ALSO    {* bdd\_setmanager *}
+*/
+BddManager *bdd_getmanager(void)
+{
+   return bddmanager;
+}
+
+
+#if ENABLE_TBDD
+/* Variables exported by the prover, for the manager of the calling thread */
+prover_vars_t *tbdd_prover_vars(void)
+{
+   return prover_vars;
+}
+#endif
+
+
+/* EOF */
@@ -0,0 +1,422 @@
+/*========================================================================
+  Copyright (c) 2022 Randal E. Bryant, Carnegie Mellon University
+  
+  This code was not included in the original BuDDy distribution and is
+  therefore not subject to any of its licensing terms.
+
+  Permission is hereby granted, free of
+  charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+========================================================================*/
+
+/*
+  State of a BDD manager.  Everything that the kernel, the operators,
+  the prover, and the TBDD layer used to keep in global variables is
+  held in one of these, so that independent problems can be solved at
+  the same time on separate threads.  Each thread works with its
+  current manager, given by bddmanager.  A thread starts out with the
+  default manager, so programs that never create a manager see the
+  same package as before.
+
+  Each module refers to its own part of the state through macros with
+  the names of the former variables, defined in its source file.  The
+  kernel variables, and those exported by the prover, are defined at
+  the end of this file.  These macros are private to the package.
+*/
+
+#ifndef _MANAGER_H
+#define _MANAGER_H
+
+#include <pthread.h>
+#include "cache.h"
+#if ENABLE_TBDD
+#include "pwriter.h"
+#endif
+
+/* Arrays of the node table, indexing their allocated sizes */
+enum { NT_NODES, NT_REFCOU, NT_HASH, NT_NEXT, NT_PROOF,
+       NT_UNIQUEFP, NT_UNIQUENODE, NT_NUM };
+
+/* Kernel (kernel.c) */
+typedef struct s_BddKernelState
+{
+   int          bddrunning;         /* Flag - package initialized */
+   int          bdderrorcond;       /* Some error condition */
+   int          bddnodesize;        /* Number of allocated nodes */
+   int          bddmaxnodesize;     /* Maximum allowed number of nodes */
+   int          bddmaxnodeincrease; /* Max. # of nodes used to inc. table */
+   int          hugepages;          /* Back large tables with huge pages */
+   int          adaptive;           /* Size node table and caches from use */
+   int          memlimit;           /* Memory budget in megabytes, or 0 */
+   int          noderesizenum;      /* Number of node table resizes */
+   int          opcacheresizenum;   /* Number of caches grown from hit rates */
+   BddNode*     bddnodes;           /* All of the bdd nodes */
+   bddrefcount* bddrefcou;          /* Reference count of each node */
+   int*         bddhash;            /* Head of hash chain for each bucket */
+   int*         bddnext;            /* Next node in hash chain or free list */
+#if ENABLE_TBDD
+   BddProofInfo* bddproof;          /* Proof information for each node */
+#endif
+   size_t       nodetablealloc[NT_NUM]; /* Bytes allocated for each array */
+   int          bddfreepos;         /* First free node */
+   int          bddfreenum;         /* Number of free nodes */
+   long int     bddproduced;        /* Number of new nodes ever produced */
+   int          bddvarnum;          /* Number of defined BDD variables */
+   int*         bddrefstack;        /* Internal node reference stack */
+   int*         bddrefstacktop;     /* Internal node reference stack top */
+   int*         bddvar2level;       /* Variable -> level table */
+   int*         bddlevel2var;       /* Level -> variable table */
+   jmp_buf      bddexception;       /* Long-jump point for interrupting calc. */
+   int          bddresized;         /* Flag indicating a resize of the nodetable */
+   bddCacheStat bddcachestats;
+
+   int          gbcminfreenodes;    /* Min. % of nodes free after a GBC */
+   BDD*         bddvarset;          /* Set of defined BDD variables */
+   int          gbcollectnum;       /* Number of garbage collections */
+   int          gbcyoungcollectnum; /* Number of young-only collections */
+   int          gbcgenerational;    /* Use generational collection */
+   int*         youngnodes;         /* Nodes created since last collection */
+   int          youngcount;
+   int          youngalloc;
+   int*         markstack;          /* Pending nodes of the mark routines */
+   int          markstackalloc;
+   int          oldcount;           /* Nodes that survived a collection */
+   int          oldlimit;           /* Do full collection beyond this */
+   int          opcachesize;        /* Size of the operator caches */
+   long int     gbcclock;           /* Clock ticks used in GBC */
+   int          usednodes_nextreorder; /* When to do reorder next time */
+   bddinthandler  err_handler;      /* Error handler */
+   bddgbchandler  gbc_handler;      /* Garbage collection handler */
+   bdd2inthandler resize_handler;   /* Node-table-resize handler */
+#ifdef OPEN_UNIQUE
+   unsigned char* uniquefp;         /* Fingerprint in each slot */
+   int*         uniquenode;         /* Node in each slot */
+   int          uniquebits;         /* log2 of number of slots */
+   unsigned int uniquemask;         /* Number of slots - 1 */
+#else
+   char         freelistlock;       /* Held while taking nodes in parallel */
+#endif
+} BddKernelState;
+
+/* Operators (bddop.c) */
+typedef struct s_BddOpState
+{
+   int applyop;                     /* Current operator for apply */
+   int appexop;                     /* Current operator for appex */
+   int appexid;                     /* Current cache id for appex */
+   int quantid;                     /* Current cache id for quantifications */
+   int *quantvarset;                /* Current variable set for quant. */
+   int quantvarsetID;               /* Current id used in quantvarset */
+   int quantlast;                   /* Current last variable to be quant. */
+   int replaceid;                   /* Current cache id for replace */
+   int *replacepair;                /* Current replace pair */
+   int replacelast;                 /* Current last var. level to replace */
+   int composelevel;                /* Current variable used for compose */
+   int miscid;                      /* Current cache id for other results */
+   int *varprofile;                 /* Current variable profile */
+   int supportID;                   /* Current ID (true value) for support */
+   int supportMin;                  /* Min. used level in support calc. */
+   int supportMax;                  /* Max. used level in support calc. */
+   int* supportSet;                 /* The found support set */
+   int supportSize;                 /* Allocated size of supportSet */
+   BddCache opcache[BDD_CACHE_NUM]; /* Caches for the operations */
+   int cacheratio;
+   int opcacheratio[BDD_CACHE_NUM]; /* Per cache ratio, or 0 to scale
+				       cacheratio by opcachescale */
+   long unsigned int adapthit[BDD_CACHE_NUM];  /* Cache statistics at the */
+   long unsigned int adaptmiss[BDD_CACHE_NUM]; /* last adaptive resize check */
+   BDD satPolarity;
+   int firstReorder;                /* Used instead of local variable in order
+				       to avoid compiler warning about 'first'
+				       being clobbered by setjmp */
+   char*            allsatProfile;  /* Variable profile for bdd_allsat() */
+   bddallsathandler allsatHandler;  /* Callback handler for bdd_allsat() */
+   struct s_BddFrame *applystack;   /* Explicit recursion stacks */
+   int applystackalloc;
+   struct s_BddFrame *quantstack;
+   int quantstackalloc;
+   struct s_BddFrame *jstack;
+   int jstackalloc;
+   struct s_BddFrame *aijstack;
+   int aijstackalloc;
+} BddOpState;
+
+/* Variable reordering (reorder.c) */
+typedef struct s_BddReorderState
+{
+   int bddreordermethod;            /* Current auto reord. method */
+   int bddreordertimes;             /* Number of automatic reorderings left */
+   int reorderdisabled;             /* Reordering disabled temporarily */
+   struct s_BddTree *vartree;       /* Variable relationships */
+   int blockid;
+   int *extroots;                   /* Ref.cou. of the external roots */
+   int extrootsize;
+   struct _levelData *levels;       /* Indexed by variable! */
+   struct _imatrix *iactmtx;        /* Interaction matrix */
+   int verbose;                     /* Information for the user */
+   bddinthandler reorder_handler;
+   bddfilehandler reorder_filehandler;
+   bddsizehandler reorder_nodenum;
+   long reorderclock;               /* Start of reordering, for verbose */
+   int usednum_before;              /* Live nodes before reordering */
+   int usednum_after;               /* Live nodes after reordering */
+   int resizedInMakenode;           /* Node table resized by reorder_makenode */
+} BddReorderState;
+
+/* Finite domain blocks (fdd.c) */
+typedef struct s_BddFddState
+{
+   int firstbddvar;
+   int fdvaralloc;                  /* Number of allocated domains */
+   int fdvarnum;                    /* Number of defined domains */
+   struct s_Domain *domain;         /* Table of domain sizes */
+   bddfilehandler filehandler;
+} BddFddState;
+
+/* Saving and loading (bddio.c) */
+typedef struct s_BddIoState
+{
+   bddfilehandler filehandler;
+   struct s_LoadHash *lh_table;
+   int lh_freepos;
+   int lh_nodenum;
+   int *loadvar2level;
+} BddIoState;
+
+/* Replacement pairs (pairs.c) */
+typedef struct s_BddPairsState
+{
+   int pairsid;                     /* Pair identifier */
+   bddPair* pairs;                  /* List of all replacement pairs in use */
+} BddPairsState;
+
+/* Parallel apply (papply.c) */
+typedef struct s_BddPapplyState
+{
+   int papplythreads;               /* Number of threads, including the caller */
+   struct s_PapplyCacheData *pcache;
+   int pcachesize;
+   int workernum;                   /* Number of workers set up */
+   struct s_PapplyWorker *workers;
+   pthread_mutex_t poollock;
+   pthread_cond_t poolcond;
+   int jobnum;                      /* Incremented for each operation */
+   int jobactive;                   /* Helpers keep stealing while set */
+   int jobbusy;                     /* Number of helpers in the current job */
+   void (*jobfun)(struct s_PapplyWorker *);  /* Run by each helper */
+   int poolshutdown;
+   int papplyop;
+   int papplyabort;                 /* Out of nodes */
+#if ENABLE_TBDD
+   struct s_PjustifyStep *pjsteps;
+   int pjstepnum;
+   int pjstepalloc;
+   int *pjindex;                    /* Open addressing table of steps */
+   int pjindexsize;                 /* Power of 2 */
+   clause_id_t *pjfinal;            /* Final clause IDs, two per step */
+   pbuffer *pjchunks;
+   int pjchunkalloc;                /* Chunks with a proof buffer */
+   int pjchunknum;
+   int pjchunknext;                 /* Next chunk to justify */
+   clause_id_t pjfirstid;           /* Last clause ID before the steps */
+   int pjfailed;
+   struct s_BddFrame *pjstack;      /* Explicit recursion stack of pjustify_list */
+   int pjstackalloc;
+#endif
+} BddPapplyState;
+
+#if ENABLE_TBDD
+/* Proof generation (prover.c) */
+typedef struct s_BddProverState
+{
+   prover_vars_t vars;              /* Exported through prover.h */
+   FILE *proof_file;
+   bool do_binary;
+   ilist clause_buf;                /* Clause retrieved for deletion */
+   ilist input_buf;                 /* Clause returned by get_input_clause */
+   clause_id_t live_clause_count;
+   ilist deferred_deletion_list;
+   clause_id_t empty_clause_id;
+   bool empty_clause_finalized;
+   pwriter pwrite;                  /* Buffered output for proof file */
+} BddProverState;
+
+/* Proof trimming (ptrim.c) */
+typedef struct s_BddTrimState
+{
+   int input_clause_limit;
+   size_t *clause_offset;           /* Position of each clause in store */
+   clause_id_t alloc_id_count;
+   unsigned char *store;            /* Recorded clauses */
+   size_t store_count;
+   size_t store_alloc;
+   clause_id_t last_id;             /* Last recorded clause */
+   unsigned char *dstore;           /* Recorded deletions */
+   size_t dstore_count;
+   size_t dstore_alloc;
+} BddTrimState;
+
+/* Clause store (cstore.c) */
+typedef struct s_BddCstoreState
+{
+   clause_id_t base_id;             /* First clause ID in index */
+   size_t *clause_offset;           /* Position of each clause in arena */
+   clause_id_t index_count;
+   clause_id_t index_alloc;
+   unsigned char *arena;            /* Recorded clauses */
+   size_t arena_count;
+   size_t arena_alloc;
+   size_t dead_count;               /* Bytes of deleted clauses */
+} BddCstoreState;
+
+#define TBDD_BUFLEN 2048
+#define TBDD_FUN_MAX 10
+
+/* Trusted BDDs (tbdd.c) */
+typedef struct s_BddTbddState
+{
+   char ibuf[TBDD_BUFLEN];          /* For formatting information */
+   tbdd_info_fun ifuns[TBDD_FUN_MAX];
+   int ifun_count;
+   tbdd_done_fun dfuns[TBDD_FUN_MAX];
+   int dfun_count;
+   int last_variable;
+   clause_id_t last_clause_id;
+   ilist created_unit_clauses;      /* Unit clauses that have not been deleted */
+   ilist dead_unit_clauses;         /* Unit clauses that (should) have been deleted */
+   int *rc_table;                   /* Reference counts of TBDDs */
+   int rc_allocated_count;
+   int rc_freepos;                  /* Head of free list */
+} BddTbddState;
+
+/* Pseudo-Boolean constraints (pseudoboolean.cxx) */
+typedef struct s_BddPseudoState
+{
+   char ibuf[TBDD_BUFLEN];          /* For formatting information */
+   int pseudo_xor_created;
+   int pseudo_xor_unique;
+   int pseudo_total_length;
+   int pseudo_plus_computed;
+   bool initialized;
+} BddPseudoState;
+#endif /* ENABLE_TBDD */
+
+struct s_BddManager
+{
+   BddKernelState kernel;
+   BddOpState op;
+   BddReorderState reorder;
+   BddFddState fdd;
+   BddIoState io;
+   BddPairsState pairlist;
+   BddPapplyState papply;
+#if ENABLE_TBDD
+   BddProverState prover;
+   BddTrimState trim;
+   BddCstoreState cstore;
+   BddTbddState tbdd;
+   BddPseudoState pseudo;
+#endif
+};
+
+#ifdef CPLUSPLUS
+extern "C" {
+#endif
+
+   /* Current manager of the calling thread */
+extern __thread BddManager *bddmanager __attribute__((tls_model("initial-exec")));
+
+#ifdef CPLUSPLUS
+}
+#endif
+
+
+#if ENABLE_TBDD
+/*=== PROVER VARIABLES =================================================*/
+
+#ifdef CPLUSPLUS
+extern "C" {
+#endif
+
+   /* Those of the current manager of the calling thread */
+extern __thread prover_vars_t *prover_vars __attribute__((tls_model("initial-exec")));
+
+#ifdef CPLUSPLUS
+}
+#endif
+
+#define proof_type             (prover_vars->proof_type)
+#define verbosity_level        (prover_vars->verbosity_level)
+#define variable_counter       (prover_vars->variable_counter)
+#define clause_id_counter      (prover_vars->clause_id_counter)
+#define total_clause_count     (prover_vars->total_clause_count)
+#define input_variable_count   (prover_vars->input_variable_count)
+#define input_clause_count     (prover_vars->input_clause_count)
+#define max_live_clause_count  (prover_vars->max_live_clause_count)
+#define deleted_clause_count   (prover_vars->deleted_clause_count)
+#define lazy_defining          (prover_vars->lazy_defining)
+#define defined_node_count     (prover_vars->defined_node_count)
+#define trim_proof             (prover_vars->trim_proof)
+#define trimmed_clause_count   (prover_vars->trimmed_clause_count)
+#define async_proof            (prover_vars->async_proof)
+#define parallel_justify       (prover_vars->parallel_justify)
+#define proof_stall_count      (prover_vars->proof_stall_count)
+#define proof_stall_seconds    (prover_vars->proof_stall_seconds)
+#define apply_step_count       (prover_vars->apply_step_count)
+#define apply_split_count      (prover_vars->apply_split_count)
+#define time_justify           (prover_vars->time_justify)
+#define timed_step_count       (prover_vars->timed_step_count)
+#define timed_step_seconds     (prover_vars->timed_step_seconds)
+#define checker_add_clause     (prover_vars->checker_add_clause)
+#define checker_delete_clauses (prover_vars->checker_delete_clauses)
+#endif /* ENABLE_TBDD */
+
+
+/*=== KERNEL VARIABLES =================================================*/
+
+#define bddrunning         (bddmanager->kernel.bddrunning)
+#define bdderrorcond       (bddmanager->kernel.bdderrorcond)
+#define bddnodesize        (bddmanager->kernel.bddnodesize)
+#define bddmaxnodesize     (bddmanager->kernel.bddmaxnodesize)
+#define bddmaxnodeincrease (bddmanager->kernel.bddmaxnodeincrease)
+#define bddhugepages       (bddmanager->kernel.hugepages)
+#define bddadaptive        (bddmanager->kernel.adaptive)
+#define bddmemlimit        (bddmanager->kernel.memlimit)
+#define opcacheresizenum   (bddmanager->kernel.opcacheresizenum)
+#define bddnodes           (bddmanager->kernel.bddnodes)
+#define bddrefcou          (bddmanager->kernel.bddrefcou)
+#define bddhash            (bddmanager->kernel.bddhash)
+#define bddnext            (bddmanager->kernel.bddnext)
+#if ENABLE_TBDD
+#define bddproof           (bddmanager->kernel.bddproof)
+#endif
+#define bddfreepos         (bddmanager->kernel.bddfreepos)
+#define bddfreenum         (bddmanager->kernel.bddfreenum)
+#define bddproduced        (bddmanager->kernel.bddproduced)
+#define bddvarnum          (bddmanager->kernel.bddvarnum)
+#define bddrefstack        (bddmanager->kernel.bddrefstack)
+#define bddrefstacktop     (bddmanager->kernel.bddrefstacktop)
+#define bddvar2level       (bddmanager->kernel.bddvar2level)
+#define bddlevel2var       (bddmanager->kernel.bddlevel2var)
+#define bddexception       (bddmanager->kernel.bddexception)
+#define bddresized         (bddmanager->kernel.bddresized)
+#define bddcachestats      (bddmanager->kernel.bddcachestats)
+
+#endif /* _MANAGER_H */
@@ -40,8 +40,9 @@
 
 /*======================================================================*/
 
-static int      pairsid;            /* Pair identifier */
-static bddPair* pairs;              /* List of all replacement pairs in use */
+   /* Pairs of the current manager, see manager.h */
+#define pairsid (bddmanager->pairlist.pairsid)
+#define pairs   (bddmanager->pairlist.pairs)
 
 
 /*************************************************************************
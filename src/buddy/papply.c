@@ -0,0 +1,976 @@
+/*========================================================================
+  Copyright (c) 2022 Randal E. Bryant, Carnegie Mellon University
+  
+  This code was not included in the original BuDDy distribution and is
+  therefore not subject to any of its licensing terms.
+
+  Permission is hereby granted, free of
+  charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+========================================================================*/
+
+/*************************************************************************
+  FILE:  papply.c
+  DESCR: Parallel apply for BDDs that carry no proof.
+	 The recursion of apply_rec is split among a pool of threads by
+	 work stealing.  Each thread has a deque of spawned subproblems.
+	 The owner pushes and pops at the bottom, and idle threads steal
+	 from the top, so a thief gets the largest remaining subproblem.
+	 New nodes are created with bdd_makenode_mt, and results are
+	 shared through a cache protected by a sequence count per entry.
+	 There is no garbage collection while the threads run: if they
+	 run out of nodes, the operation starts over once the table has
+	 grown.
+	 The same pool justifies conjunctions in a proof.  The recursion
+	 steps are listed in a fixed order, and each thread writes the
+	 clauses for a chunk of steps into a buffer using provisional
+	 clause IDs.  The buffers are emitted in list order, so the proof
+	 does not depend on how the work was divided among the threads.
+*************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "kernel.h"
+#include "prime.h"
+
+   /* Only spawn subproblems this close to the root */
+#define SPAWNDEPTH 20
+#define DEQUESIZE (4*SPAWNDEPTH)
+
+   /* Ratio of nodes to entries in the shared cache */
+#define PCACHERATIO 4
+
+typedef struct s_PapplyTask
+{
+   int l, r;
+   int depth;
+   int result;
+   int done;        /* Set once result is valid */
+} PapplyTask;
+
+typedef struct s_PapplyWorker
+{
+   int id;
+   BddManager *manager;       /* Of the thread that set up the pool */
+   pthread_t thread;
+   pthread_mutex_t lock;      /* Protects top and bottom */
+   PapplyTask deque[DEQUESIZE];
+   int top;                   /* Next task to steal */
+   int bottom;                /* Next free slot */
+   unsigned int seed;
+#ifndef OPEN_UNIQUE
+   BddNodeAlloc alloc;
+#endif
+   long unsigned int opHit;
+   long unsigned int opMiss;
+} PapplyWorker;
+
+typedef struct s_PapplyCacheData
+{
+   unsigned int seq;          /* Odd while the entry is being written */
+   int a, b, c;
+   int res;
+} PapplyCacheData;
+
+   /* Thread pool of the current manager, see manager.h */
+#define papplythreads (bddmanager->papply.papplythreads)
+#define pcache        (bddmanager->papply.pcache)
+#define pcachesize    (bddmanager->papply.pcachesize)
+#define workernum     (bddmanager->papply.workernum)
+#define workers       (bddmanager->papply.workers)
+#define poollock      (bddmanager->papply.poollock)
+#define poolcond      (bddmanager->papply.poolcond)
+#define jobnum        (bddmanager->papply.jobnum)
+#define jobactive     (bddmanager->papply.jobactive)
+#define jobbusy       (bddmanager->papply.jobbusy)
+#define jobfun        (bddmanager->papply.jobfun)
+#define poolshutdown  (bddmanager->papply.poolshutdown)
+#define papplyop      (bddmanager->papply.papplyop)
+#define papplyabort   (bddmanager->papply.papplyabort)
+
+#ifndef OPEN_UNIQUE
+
+
+/*************************************************************************
+  Shared cache
+*************************************************************************/
+
+static int papply_cache_lookup(int l, int r, int *res)
+{
+   PapplyCacheData *entry = &pcache[TRIPLE(l,r,papplyop) % pcachesize];
+   unsigned int seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+   int a, b, c, x;
+
+   if (seq & 1)
+      return 0;
+   a = __atomic_load_n(&entry->a, __ATOMIC_RELAXED);
+   b = __atomic_load_n(&entry->b, __ATOMIC_RELAXED);
+   c = __atomic_load_n(&entry->c, __ATOMIC_RELAXED);
+   x = __atomic_load_n(&entry->res, __ATOMIC_RELAXED);
+   __atomic_thread_fence(__ATOMIC_ACQUIRE);
+   if (__atomic_load_n(&entry->seq, __ATOMIC_RELAXED) != seq)
+      return 0;
+   if (a != l  ||  b != r  ||  c != papplyop)
+      return 0;
+   *res = x;
+   return 1;
+}
+
+
+   /* Skipped if another thread is writing the entry */
+static void papply_cache_insert(int l, int r, int res)
+{
+   PapplyCacheData *entry = &pcache[TRIPLE(l,r,papplyop) % pcachesize];
+   unsigned int seq = __atomic_load_n(&entry->seq, __ATOMIC_RELAXED);
+
+   if (seq & 1)
+      return;
+   if (!__atomic_compare_exchange_n(&entry->seq, &seq, seq+1, 0,
+				    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+      return;
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+   __atomic_store_n(&entry->a, l, __ATOMIC_RELAXED);
+   __atomic_store_n(&entry->b, r, __ATOMIC_RELAXED);
+   __atomic_store_n(&entry->c, papplyop, __ATOMIC_RELAXED);
+   __atomic_store_n(&entry->res, res, __ATOMIC_RELAXED);
+   __atomic_store_n(&entry->seq, seq+2, __ATOMIC_RELEASE);
+}
+
+
+static int papply_cache_resize(void)
+{
+   int n, size = bdd_prime_gte(bddnodesize / PCACHERATIO);
+
+   if (size == pcachesize)
+      return 1;
+   free(pcache);
+   if ((pcache=NEW(PapplyCacheData,size)) == NULL)
+   {
+      pcachesize = 0;
+      return 0;
+   }
+   for (n=0 ; n<size ; n++)
+   {
+      pcache[n].seq = 0;
+      pcache[n].a = -1;
+   }
+   pcachesize = size;
+   return 1;
+}
+
+#endif /* OPEN_UNIQUE */
+
+
+   /* Called from bdd_operator_reset and after garbage collection */
+void bdd_papply_reset(void)
+{
+   int n;
+
+   for (n=0 ; n<pcachesize ; n++)
+      pcache[n].a = -1;
+}
+
+
+#ifndef OPEN_UNIQUE
+
+/*************************************************************************
+  Work stealing
+*************************************************************************/
+
+static int papply_rec(PapplyWorker *, int, int, int);
+
+   /* Run the oldest task of another worker that fits in our deque */
+static int papply_steal(PapplyWorker *w)
+{
+   int i, v;
+   PapplyTask *task;
+
+   for (i=1 ; i<workernum ; i++)
+   {
+      PapplyWorker *victim;
+
+      v = (w->id + i + rand_r(&w->seed) % workernum) % workernum;
+      if (v == w->id)
+	 continue;
+      victim = &workers[v];
+      if (__atomic_load_n(&victim->top, __ATOMIC_RELAXED) >=
+	  __atomic_load_n(&victim->bottom, __ATOMIC_RELAXED))
+	 continue;
+
+      task = NULL;
+      pthread_mutex_lock(&victim->lock);
+      if (victim->top < victim->bottom  &&
+	  w->bottom + SPAWNDEPTH - victim->deque[victim->top].depth <= DEQUESIZE)
+	 task = &victim->deque[victim->top++];
+      pthread_mutex_unlock(&victim->lock);
+
+      if (task != NULL)
+      {
+	 int res = papply_rec(w, task->l, task->r, task->depth);
+	 task->result = res;
+	 __atomic_store_n(&task->done, 1, __ATOMIC_RELEASE);
+	 return 1;
+      }
+   }
+   return 0;
+}
+
+
+static PapplyTask *papply_push(PapplyWorker *w, int l, int r, int depth)
+{
+   PapplyTask *task;
+
+   pthread_mutex_lock(&w->lock);
+   task = &w->deque[w->bottom];
+   task->l = l;
+   task->r = r;
+   task->depth = depth;
+   task->done = 0;
+   w->bottom++;
+   pthread_mutex_unlock(&w->lock);
+   return task;
+}
+
+
+/*
+  Take back the task last pushed.  Returns 0 if it was stolen, in which
+  case its slot stays reserved until papply_release, since the thief
+  will store the result there.
+*/
+static int papply_pop(PapplyWorker *w)
+{
+   int ok;
+
+   pthread_mutex_lock(&w->lock);
+   ok = w->bottom-1 >= w->top;
+   if (ok)
+      w->bottom--;
+   else
+      w->top = w->bottom;
+   pthread_mutex_unlock(&w->lock);
+   return ok;
+}
+
+
+static void papply_release(PapplyWorker *w)
+{
+   pthread_mutex_lock(&w->lock);
+   w->bottom--;
+   w->top = w->bottom;
+   pthread_mutex_unlock(&w->lock);
+}
+
+
+   /* Cofactors of the operands for the top variable.  Returns its level */
+static int papply_split(int l, int r, int *ll, int *lh, int *rl, int *rh)
+{
+   if (LEVEL(l) == LEVEL(r))
+   {
+      *ll = LOW(l); *lh = HIGH(l);
+      *rl = LOW(r); *rh = HIGH(r);
+      return LEVEL(l);
+   }
+   if (LEVEL(l) < LEVEL(r))
+   {
+      *ll = LOW(l); *lh = HIGH(l);
+      *rl = *rh = r;
+      return LEVEL(l);
+   }
+   *ll = *lh = l;
+   *rl = LOW(r); *rh = HIGH(r);
+   return LEVEL(r);
+}
+
+
+static int papply_rec(PapplyWorker *w, int l, int r, int depth)
+{
+   int res, low, high, level;
+   int ll, lh, rl, rh;
+
+   if ((res=bdd_apply_terminal(papplyop, l, r)) >= 0)
+      return res;
+   if (__atomic_load_n(&papplyabort, __ATOMIC_RELAXED))
+      return 0;
+
+   if (papply_cache_lookup(l, r, &res))
+   {
+      w->opHit++;
+      return res;
+   }
+   w->opMiss++;
+
+   level = papply_split(l, r, &ll, &lh, &rl, &rh);
+
+   if (depth < SPAWNDEPTH  &&  workernum > 1)
+   {
+      PapplyTask *task = papply_push(w, lh, rh, depth+1);
+
+      low = papply_rec(w, ll, rl, depth+1);
+      if (papply_pop(w))
+	 high = papply_rec(w, lh, rh, depth+1);
+      else
+      {
+	 while (!__atomic_load_n(&task->done, __ATOMIC_ACQUIRE))
+	    if (!papply_steal(w))
+	       sched_yield();
+	 high = task->result;
+	 papply_release(w);
+      }
+   }
+   else
+   {
+      low = papply_rec(w, ll, rl, depth+1);
+      high = papply_rec(w, lh, rh, depth+1);
+   }
+
+   if (__atomic_load_n(&papplyabort, __ATOMIC_RELAXED))
+      return 0;
+   res = bdd_makenode_mt(&w->alloc, level, low, high);
+   if (res < 0)
+   {
+      __atomic_store_n(&papplyabort, 1, __ATOMIC_RELAXED);
+      return 0;
+   }
+
+   papply_cache_insert(l, r, res);
+   return res;
+}
+
+
+static void *papply_helper(void *arg)
+{
+   PapplyWorker *w = (PapplyWorker*)arg;
+   void (*fun)(PapplyWorker *);
+   int seen = 0;
+
+   bdd_setmanager(w->manager);
+   for (;;)
+   {
+      pthread_mutex_lock(&poollock);
+      while (jobnum == seen  &&  !poolshutdown)
+	 pthread_cond_wait(&poolcond, &poollock);
+      seen = jobnum;
+      if (poolshutdown)
+      {
+	 pthread_mutex_unlock(&poollock);
+	 break;
+      }
+      if (!jobactive)
+      {
+	 pthread_mutex_unlock(&poollock);
+	 continue;
+      }
+      jobbusy++;
+      fun = jobfun;
+      pthread_mutex_unlock(&poollock);
+
+      fun(w);
+
+      __atomic_sub_fetch(&jobbusy, 1, __ATOMIC_RELEASE);
+   }
+   return NULL;
+}
+
+
+   /* Wake the helpers to run fun alongside the calling thread */
+static void papply_job_begin(void (*fun)(PapplyWorker *))
+{
+   pthread_mutex_lock(&poollock);
+   jobfun = fun;
+   jobnum++;
+   jobactive = 1;
+   pthread_cond_broadcast(&poolcond);
+   pthread_mutex_unlock(&poollock);
+}
+
+
+   /* Wait until no helper is still running the job */
+static void papply_job_end(void)
+{
+   pthread_mutex_lock(&poollock);
+   jobactive = 0;
+   pthread_mutex_unlock(&poollock);
+   while (__atomic_load_n(&jobbusy, __ATOMIC_ACQUIRE) > 0)
+      sched_yield();
+}
+
+
+static void papply_help(PapplyWorker *w)
+{
+   while (__atomic_load_n(&jobactive, __ATOMIC_ACQUIRE))
+      if (!papply_steal(w))
+	 sched_yield();
+}
+
+
+static int papply_start(void)
+{
+   int n;
+
+   if (workernum == papplythreads)
+      return 1;
+   bdd_papply_done();
+
+   if ((workers=NEW(PapplyWorker,papplythreads)) == NULL)
+      return 0;
+   memset(workers, 0, sizeof(PapplyWorker)*papplythreads);
+   poolshutdown = 0;
+   for (n=0 ; n<papplythreads ; n++)
+   {
+      workers[n].id = n;
+      workers[n].manager = bddmanager;
+      workers[n].seed = n+1;
+      pthread_mutex_init(&workers[n].lock, NULL);
+   }
+   workernum = 1;
+   for (n=1 ; n<papplythreads ; n++)
+   {
+      if (pthread_create(&workers[n].thread, NULL, papply_helper, &workers[n]) != 0)
+	 break;
+      workernum++;
+   }
+   return workernum > 1;
+}
+
+
+#if ENABLE_TBDD
+
+/*************************************************************************
+  Parallel proof of conjunction
+*************************************************************************/
+
+/*
+  Once the result has been built, the distinct subproblems of the
+  recursion of applyj_rec that are not in the proof cache are listed,
+  each after its own subproblems.  The list is cut into chunks, which
+  the threads justify independently, each into its own proof buffer.
+  A step refers to the clauses of earlier steps by provisional IDs,
+  derived from their position in the list.  The buffers are then
+  written in order, which numbers the clauses, and the results go into
+  the proof cache, where applyj_rec finds the one at the top.  The
+  proof does not depend on the number of threads nor on the order in
+  which the chunks were done.
+*/
+
+   /* Fewer subproblems than this are left to applyj_rec */
+#define PJUSTIFY_MIN 1024
+#define PJUSTIFY_CHUNK 1024
+
+typedef struct s_PjustifyStep
+{
+   int l, r;
+   int root;
+   clause_id_t clause_id;   /* Provisional */
+} PjustifyStep;
+
+   /* Steps of the current manager, see manager.h.  Entries of pjindex
+      are -1 when empty */
+#define pjsteps      (bddmanager->papply.pjsteps)
+#define pjstepnum    (bddmanager->papply.pjstepnum)
+#define pjstepalloc  (bddmanager->papply.pjstepalloc)
+#define pjindex      (bddmanager->papply.pjindex)
+#define pjindexsize  (bddmanager->papply.pjindexsize)
+#define pjfinal      (bddmanager->papply.pjfinal)
+#define pjchunks     (bddmanager->papply.pjchunks)
+#define pjchunkalloc (bddmanager->papply.pjchunkalloc)
+#define pjchunknum   (bddmanager->papply.pjchunknum)
+#define pjchunknext  (bddmanager->papply.pjchunknext)
+#define pjfirstid    (bddmanager->papply.pjfirstid)
+#define pjfailed     (bddmanager->papply.pjfailed)
+#define pjstack      (bddmanager->papply.pjstack)
+#define pjstackalloc (bddmanager->papply.pjstackalloc)
+
+
+static int pjustify_find(int l, int r)
+{
+   int mask = pjindexsize-1;
+   int n, k;
+
+   if (pjindexsize == 0)
+      return -1;
+   for (n=PAIR(l,r) & mask ; (k=pjindex[n]) != -1 ; n=(n+1) & mask)
+      if (pjsteps[k].l == l  &&  pjsteps[k].r == r)
+	 return k;
+   return -1;
+}
+
+
+static void pjustify_put(int k)
+{
+   int mask = pjindexsize-1;
+   int n;
+
+   for (n=PAIR(pjsteps[k].l,pjsteps[k].r) & mask ; pjindex[n] != -1 ; n=(n+1) & mask)
+      ;
+   pjindex[n] = k;
+}
+
+
+   /* Empty the table for the next operation, in time proportional to the steps */
+static void pjustify_clear(void)
+{
+   int mask = pjindexsize-1;
+   int n, k;
+
+   for (k=0 ; k<pjstepnum ; k++)
+   {
+      for (n=PAIR(pjsteps[k].l,pjsteps[k].r) & mask ; pjindex[n] != k ; n=(n+1) & mask)
+	 ;
+      pjindex[n] = -1;
+   }
+   pjstepnum = 0;
+}
+
+
+static int pjustify_addstep(int l, int r, int root)
+{
+   int n;
+
+   if (pjstepnum >= pjstepalloc)
+   {
+      int newalloc = pjstepalloc == 0 ? 4*PJUSTIFY_MIN : 2*pjstepalloc;
+      PjustifyStep *newsteps = (PjustifyStep*)realloc(pjsteps, sizeof(PjustifyStep)*newalloc);
+      if (newsteps == NULL)
+	 return 0;
+      pjsteps = newsteps;
+      pjstepalloc = newalloc;
+   }
+   if (2*(pjstepnum+1) > pjindexsize)
+   {
+      int newsize = pjindexsize == 0 ? 8*PJUSTIFY_MIN : 2*pjindexsize;
+      int *newindex = NEW(int,newsize);
+      if (newindex == NULL)
+	 return 0;
+      free(pjindex);
+      pjindex = newindex;
+      pjindexsize = newsize;
+      for (n=0 ; n<newsize ; n++)
+	 pjindex[n] = -1;
+      for (n=0 ; n<pjstepnum ; n++)
+	 pjustify_put(n);
+   }
+   pjsteps[pjstepnum].l = l;
+   pjsteps[pjstepnum].r = r;
+   pjsteps[pjstepnum].root = root;
+   pjustify_put(pjstepnum);
+   pjstepnum++;
+   return 1;
+}
+
+
+/*
+  Result of a subproblem that is a terminal case, in the proof cache,
+  or an earlier step.  The clause of a step is referred to by its
+  provisional ID.
+*/
+static int pjustify_result(int l, int r, pcbdd *res)
+{
+   int k;
+
+   res->clause_id = TAUTOLOGY;
+   if (l == r)
+      { res->root = l; return 1; }
+   if (ISZERO(l)  ||  ISZERO(r))
+      { res->root = 0; return 1; }
+   if (ISONE(l))
+      { res->root = r; return 1; }
+   if (ISONE(r))
+      { res->root = l; return 1; }
+   if (bdd_proofcache_find(l, r, res))
+      return 1;
+   if ((k=pjustify_find(l, r)) >= 0)
+   {
+      res->root = pjsteps[k].root;
+      res->clause_id = pjfirstid + 2*k + 2;
+      return 1;
+   }
+   return 0;
+}
+
+
+/*
+  List the subproblems, each after its own.  Returns the result node.
+  Uses the explicit stack pjstack, visiting subproblems in the same
+  order as a recursion, low branch first.  The result of the low
+  branch is kept in the frame's t.
+*/
+static int pjustify_list(int l, int r)
+{
+   BddFrame *f;
+   pcbdd res;
+   int level, ll, lh, rl, rh;
+   int root;
+   int sp = 0;
+
+   for (;;)
+   {
+	 /* Descend along low branches to a known result */
+      while (!pjustify_result(l, r, &res))
+      {
+	 if (!bdd_framestack_reserve(&pjstack, &pjstackalloc, sp))
+	 {
+	    pjfailed = 1;
+	    return 0;
+	 }
+	 f = &pjstack[sp++];
+	 f->l = l;
+	 f->r = r;
+	 f->high = 0;
+	 papply_split(l, r, &ll, &lh, &rl, &rh);
+	 l = ll;
+	 r = rl;
+      }
+      root = res.root;
+
+	 /* Finish the frames whose high branch is now listed */
+      for (;;)
+      {
+	 if (sp == 0)
+	    return root;
+	 f = &pjstack[sp-1];
+	 if (!f->high)
+	    break;
+	 level = papply_split(f->l, f->r, &ll, &lh, &rl, &rh);
+	 root = bdd_findnode(level, f->t, root);
+	 if (root < 0  ||  !pjustify_addstep(f->l, f->r, root))
+	 {
+	    pjfailed = 1;
+	    return 0;
+	 }
+	 sp--;
+      }
+
+      f->t = root;
+      f->high = 1;
+      papply_split(f->l, f->r, &ll, &lh, &rl, &rh);
+      l = lh;
+      r = rh;
+   }
+}
+
+
+   /* Justify step k into the buffer of its chunk */
+static void pjustify_step(pbuffer *pb, int k)
+{
+   PjustifyStep *step = &pjsteps[k];
+   pcbdd tresl, tresh;
+   int level, ll, lh, rl, rh;
+
+   level = papply_split(step->l, step->r, &ll, &lh, &rl, &rh);
+   pjustify_result(ll, rl, &tresl);
+   pjustify_result(lh, rh, &tresh);
+   pb->step_id = pjfirstid + 2*k;
+   step->clause_id = justify_apply_buffer(pb, bddop_andj, step->l, step->r,
+					  bdd_level2var(level), tresl, tresh, step->root);
+}
+
+
+   /* Chunks are done by all threads.  A chunk stops at a failed step */
+static void pjustify_help(PapplyWorker *w)
+{
+   int c, k;
+
+   (void) w;
+   while ((c=__atomic_fetch_add(&pjchunknext, 1, __ATOMIC_RELAXED)) < pjchunknum)
+   {
+      pbuffer *pb = &pjchunks[c];
+      int last = MIN((c+1)*PJUSTIFY_CHUNK, pjstepnum);
+
+      pbuffer_reset(pb, pjfirstid, pjfinal);
+      pb->defer = 1;
+      for (k=c*PJUSTIFY_CHUNK ; k<last  &&  pb->error == 0 ; k++)
+	 pjustify_step(pb, k);
+   }
+}
+
+
+/*
+  Raise the error of a failed chunk on the calling thread.  A step
+  whose check failed is done again, so that the failure is reported
+  as it would be without threads
+*/
+static void pjustify_raise(pbuffer *pb)
+{
+   int err = pb->error;
+
+   pb->defer = 0;
+   pb->error = 0;
+   if (err == TBDD_PROOF)
+	 /* Reports the failure and raises the error */
+      pjustify_step(pb, (int) ((pb->step_id - pjfirstid) / 2));
+   else
+      bdd_error(err);
+}
+
+
+static int pjustify_setup(void)
+{
+   int c, n = (pjstepnum + PJUSTIFY_CHUNK - 1) / PJUSTIFY_CHUNK;
+
+   if (n > pjchunkalloc)
+   {
+      pbuffer *newchunks = (pbuffer*)realloc(pjchunks, sizeof(pbuffer)*n);
+      if (newchunks == NULL)
+	 return 0;
+      pjchunks = newchunks;
+      for (c=pjchunkalloc ; c<n ; c++)
+      {
+	 if (pbuffer_init(&pjchunks[c]) != 0)
+	    return 0;
+	 pjchunkalloc++;
+      }
+   }
+   pjchunknum = n;
+
+   free(pjfinal);
+   if ((pjfinal=NEW(clause_id_t,2*pjstepnum)) == NULL)
+      return 0;
+   memset(pjfinal, 0, sizeof(clause_id_t)*2*pjstepnum);
+   return 1;
+}
+
+
+static void pjustify_free(void)
+{
+   int c;
+
+   for (c=0 ; c<pjchunkalloc ; c++)
+      pbuffer_free(&pjchunks[c]);
+   free(pjchunks);
+   free(pjsteps);
+   free(pjindex);
+   free(pjfinal);
+   free(pjstack);
+   pjchunks = NULL;
+   pjsteps = NULL;
+   pjindex = NULL;
+   pjfinal = NULL;
+   pjstack = NULL;
+   pjchunkalloc = pjstepalloc = pjindexsize = pjstackalloc = 0;
+   pjstepnum = pjchunknum = 0;
+}
+
+#endif /* ENABLE_TBDD */
+
+#endif /* OPEN_UNIQUE */
+
+
+void bdd_papply_done(void)
+{
+#ifndef OPEN_UNIQUE
+   int n;
+
+   if (workers != NULL)
+   {
+      pthread_mutex_lock(&poollock);
+      poolshutdown = 1;
+      pthread_cond_broadcast(&poolcond);
+      pthread_mutex_unlock(&poollock);
+      for (n=1 ; n<workernum ; n++)
+	 pthread_join(workers[n].thread, NULL);
+      for (n=0 ; n<papplythreads  &&  n<workernum ; n++)
+      {
+	 pthread_mutex_destroy(&workers[n].lock);
+	 free(workers[n].alloc.created);
+      }
+      free(workers);
+      workers = NULL;
+   }
+   workernum = 0;
+#if ENABLE_TBDD
+   pjustify_free();
+#endif
+#endif
+   free(pcache);
+   pcache = NULL;
+   pcachesize = 0;
+}
+
+
+/*************************************************************************
+  Entry point
+*************************************************************************/
+
+/*
+  Called from bdd_apply.  Returns 0 if the operation should be done by
+  apply_rec instead: when running single threaded, when generating a
+  proof, or when the node table cannot grow enough.
+*/
+int bdd_papply(BDD l, BDD r, int op, BDD *res)
+{
+#ifdef OPEN_UNIQUE
+   return 0;
+#else
+   int n, root;
+
+   if (papplythreads <= 1  ||  ISCONST(l)  ||  ISCONST(r))
+      return 0;
+#if ENABLE_TBDD
+   if (proof_type != PROOF_NONE)
+      return 0;
+#endif
+   if (!papply_start()  ||  !papply_cache_resize())
+      return 0;
+
+   for (;;)
+   {
+      papplyop = op;
+      papplyabort = 0;
+
+      papply_job_begin(papply_help);
+      root = papply_rec(&workers[0], l, r, 0);
+      papply_job_end();
+
+      for (n=0 ; n<workernum ; n++)
+      {
+	 PapplyWorker *w = &workers[n];
+	 bdd_nodealloc_done(&w->alloc);
+#ifdef CACHESTATS
+	 bddcachestats.opHit += w->opHit;
+	 bddcachestats.opMiss += w->opMiss;
+	 bddcachestats.cacheHit[bddcache_apply] += w->opHit;
+	 bddcachestats.cacheMiss[bddcache_apply] += w->opMiss;
+#endif
+	 w->opHit = w->opMiss = 0;
+      }
+
+      if (!papplyabort)
+      {
+	 *res = root;
+	 return 1;
+      }
+
+	 /* Out of nodes.  Start over once the table has grown */
+      if (!bdd_morenodes()  ||  !papply_cache_resize())
+	 return 0;
+   }
+#endif /* OPEN_UNIQUE */
+}
+
+
+#if ENABLE_TBDD
+/*
+  Called from bdd_applyj for a conjunction.  Returns 1 if the proof
+  should be done in parallel, once the result has been built.  This
+  must be enabled with tbdd_set_parallel_justify, and requires clauses
+  defining the nodes to be generated with the nodes, and no comments
+  in the proof, since these refer to clause IDs.
+*/
+int bdd_pjustify_ready(BDD l, BDD r)
+{
+#ifdef OPEN_UNIQUE
+   return 0;
+#else
+   if (papplythreads <= 1  ||  ISCONST(l)  ||  ISCONST(r))
+      return 0;
+   if (!parallel_justify  ||  lazy_defining  ||  print_ok(2))
+      return 0;
+   return papply_start();
+#endif
+}
+
+
+/*
+  Prove the conjunction, once built, and put the results in the proof
+  cache.  Leaves the operation to applyj_rec if it is small.
+*/
+void bdd_pjustify(BDD l, BDD r)
+{
+#ifndef OPEN_UNIQUE
+   int c, k;
+
+      /* Steps left by an operation that raised an error */
+   pjustify_clear();
+   pjfailed = 0;
+   pjfirstid = *clause_id_counter;
+   pjustify_list(l, r);
+   if (pjfailed  ||  pjstepnum < PJUSTIFY_MIN  ||
+       pjstepnum > (CLAUSE_ID_MAX - pjfirstid) / 2 - 1  ||  !pjustify_setup())
+   {
+      pjustify_clear();
+      return;
+   }
+
+   pjchunknext = 0;
+   papply_job_begin(pjustify_help);
+   pjustify_help(&workers[0]);
+   papply_job_end();
+
+   for (c=0 ; c<pjchunknum ; c++)
+      if (pjchunks[c].error != 0)
+      {
+	 pjustify_raise(&pjchunks[c]);
+	 pjustify_clear();
+	 return;
+      }
+   for (c=0 ; c<pjchunknum ; c++)
+      pbuffer_emit(&pjchunks[c]);
+   for (k=0 ; k<pjstepnum ; k++)
+   {
+      PjustifyStep *step = &pjsteps[k];
+      pcbdd res;
+
+      res.root = step->root;
+      res.clause_id = PBUFFER_ID(&pjchunks[0], step->clause_id);
+      bdd_proofcache_insert(step->l, step->r, res);
+   }
+#ifdef CACHESTATS
+   bddcachestats.opMiss += pjstepnum;
+   bddcachestats.cacheMiss[bddcache_proof] += pjstepnum;
+#endif
+   pjustify_clear();
+#endif
+}
+#endif /* ENABLE_TBDD */
+
+
+/*
+NAME    {* bdd\_setapplythreads *}
+SECTION {* kernel *}
+SHORT   {* Sets the number of threads used by bdd\_apply *}
+PROTO   {* int bdd_setapplythreads(int n) *}
+DESCR   {* With more than one thread, {\tt bdd\_apply} splits its
+	   recursion among a pool of {\tt n} threads, including the
+	   calling one, by work stealing.  Results are the same as with a
+	   single thread.  While generating a proof, {\tt bdd\_apply}
+	   runs on one thread.  If enabled with
+	   {\tt tbdd\_set\_parallel\_justify}, the proof of a conjunction
+	   by {\tt bdd\_and\_justify} is split into tasks that the
+	   threads share.  This proof is the same for any number of
+	   threads above one, but differs from the one generated by a
+	   single thread.  Neither is done in parallel when the unique table is
+	   built with {\tt OPEN\_UNIQUE}.  The default is a single
+	   thread. *}
+RETURN  {* The previous number of threads, or a negative number on error. *}
+ALSO    {* bdd\_apply, bdd\_and\_justify *}
+*/
+int bdd_setapplythreads(int n)
+{
+   int old = papplythreads;
+
+   if (n < 1)
+      return bdd_error(BDD_RANGE);
+   papplythreads = n;
+   return old;
+}
+
+
+/* EOF */
@@ -29,70 +29,62 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
 #include "tbdd.h"
 #include "prover.h"
 #include "kernel.h"
+#include "pwriter.h"
+#include "ptrim.h"
+#include "cstore.h"
 
 
-/* Global variables exported by prover */
-proof_type_t proof_type = PROOF_FRAT;
-int verbosity_level = 1;
-int *variable_counter = NULL;
-int *clause_id_counter = NULL;
-int total_clause_count = 0;
-int input_clause_count = 0;
-int input_variable_count = 0;
-int max_live_clause_count = 0;
-int deleted_clause_count = 0;
-
-/* Global variables used by prover */
-static FILE *proof_file = NULL;
+/*
+  Variables used by prover.  Those exported through prover.h and the
+  ones below are fields of the current manager, see manager.h
+*/
+#define proof_file             (bddmanager->prover.proof_file)
+#define do_binary              (bddmanager->prover.do_binary)
 /* 
+   Clauses are kept in the clause store.
    For LRAT, only need to keep dictionary of input clauses.
    For DRAT & FRAT, need dictionary of all clauses in order to delete them.
 */
-
-static bool do_binary = false;
-static ilist *all_clauses = NULL;
-static int alloc_clause_count = 0;
-static int live_clause_count = 0;
-static ilist deferred_deletion_list = NULL;
+#define clause_buf             (bddmanager->prover.clause_buf)
+#define input_buf              (bddmanager->prover.input_buf)
+#define live_clause_count      (bddmanager->prover.live_clause_count)
+#define deferred_deletion_list (bddmanager->prover.deferred_deletion_list)
 /* Track empty clause to:
    1) Know if it has been generated
    2) Finalize it for FRAT proof
    3) Make sure it only gets finalized once
 */
-static int empty_clause_id = TAUTOLOGY;
-static bool empty_clause_finalized = false;
-
+#define empty_clause_id        (bddmanager->prover.empty_clause_id)
+#define empty_clause_finalized (bddmanager->prover.empty_clause_finalized)
 
-// Buffer used when generating binary files
-static unsigned char *dest_buf = NULL;
-static size_t dest_buf_len = 0;
+// Buffered output for proof file
+#define pwrite                 (bddmanager->prover.pwrite)
 
 // Parameters
-// Cutoff betweeen large and small allocations (in terms of clauses)
+// The node table starts with BUDDY_NODES_PER_CLAUSE nodes for each input clause,
+// but at least BUDDY_NODES_MIN and at most a 1/BUDDY_MEMORY_SHARE share of the
+// available memory.  It then grows adaptively (see bdd_setadaptive)
 
 // Optionally increase level of garbage collection to stress test code
 #define STRESS 0
 
 #if STRESS
-#define BUDDY_THRESHOLD 10
-#define BUDDY_NODES_LARGE (1000)
-#define BUDDY_NODES_SMALL (100)
+#define BUDDY_NODES_PER_CLAUSE 1
+#define BUDDY_NODES_MIN (100)
 #define BUDDY_CACHE_RATIO 8
-#define BUDDY_INCREASE_LARGE (1000)
-#define BUDDY_INCREASE_SMALL (100)
+#define BUDDY_INCREASE (100)
 #else
-#define BUDDY_THRESHOLD 1000
-//#define BUDDY_THRESHOLD 10
-#define BUDDY_NODES_LARGE (2*1000*1000)
-//#define BUDDY_NODES_LARGE (1000)
-#define BUDDY_NODES_SMALL (2* 100*1000)
-#define BUDDY_CACHE_RATIO 8
-#define BUDDY_INCREASE_LARGE (4*1000*1000)
-#define BUDDY_INCREASE_SMALL (1* 100*1000)
+#define BUDDY_NODES_PER_CLAUSE 50
+#define BUDDY_NODES_MIN (100*1000)
+#define BUDDY_CACHE_RATIO 4
 #endif
+#define BUDDY_MEMORY_SHARE 16
 
 // How many clauses should allocated for clauses
 #define INITIAL_CLAUSE_COUNT 1000
@@ -100,19 +92,44 @@ static size_t dest_buf_len = 0;
 
 /* Useful static functions */
 
+/* Physical memory not in use, in megabytes, or 0 if unknown */
+static int available_memory() {
+#ifdef _SC_AVPHYS_PAGES
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0)
+	return (int) ((double) pages * page_size / (1 << 20));
+#endif
+    return 0;
+}
+
+/* Initial size of node table */
+static int initial_node_count() {
+    long long nodes = (long long) input_clause_count * BUDDY_NODES_PER_CLAUSE;
+    int avail = available_memory();
+    if (avail > 0)
+	nodes = MIN(nodes, bdd_memnodenum(avail / BUDDY_MEMORY_SHARE));
+    nodes = MAX(nodes, BUDDY_NODES_MIN);
+    if (verbosity_level >= 1)
+	printf("c Sizing node table for %d clauses with %d MB available\n",
+	       input_clause_count, avail);
+    return (int) nodes;
+}
+
 
 /* API functions */
-int prover_init(FILE *pfile, int *var_counter, int *cls_counter, ilist *input_clauses, ilist variable_ordering, proof_type_t ptype, bool binary) {
+int prover_init(FILE *pfile, int *var_counter, clause_id_t *cls_counter, ilist *input_clauses, ilist variable_ordering, proof_type_t ptype, bool binary) {
     empty_clause_id = TAUTOLOGY;
     proof_type = ptype;
     do_binary = binary;
-    if (do_binary) {
-	dest_buf_len = 100;
-	dest_buf = malloc(dest_buf_len);
-	if (!dest_buf)
+    proof_file = pfile;
+    /* Without a proof file, output is discarded.  Clauses can still go to a checker */
+    if (proof_type != PROOF_NONE) {
+	if (pw_init(&pwrite, proof_file, PW_BUFSIZE) != 0)
+	    return bdd_error(BDD_MEMORY);
+	if (async_proof && pw_start_async(&pwrite, PW_RING_SLOTS) != 0)
 	    return bdd_error(BDD_MEMORY);
     }
-    proof_file = pfile;
 
     variable_counter = var_counter;
     input_variable_count = *variable_counter;
@@ -130,41 +147,45 @@ int prover_init(FILE *pfile, int *var_counter, int *cls_counter, ilist *input_cl
     }
 
     deleted_clause_count = 0;
+    if (trim_proof && proof_type != PROOF_LRAT) {
+	fprintf(ERROUT, "c WARNING: Proof trimming requires LRAT proof.  Proof will not be trimmed\n");
+	trim_proof = false;
+    }
+    if (trim_proof && trim_init(input_clause_count) != 0)
+	return bdd_error(BDD_MEMORY);
     if (proof_type == PROOF_NONE && input_clauses) {
-	all_clauses = calloc(input_clause_count, sizeof(ilist));
-	if (all_clauses == NULL)
+	if (cstore_init(input_clause_count) != 0)
 	    return bdd_error(BDD_MEMORY);
 	int cid;
 	for (cid = 0; cid < input_clause_count; cid++)
-	    all_clauses[cid] = ilist_copy(input_clauses[cid]);
+	    cstore_add(cid+1, input_clauses[cid]);
     } else if (proof_type != PROOF_NONE) {
-    	alloc_clause_count = input_clause_count + INITIAL_CLAUSE_COUNT;
-	all_clauses = calloc(alloc_clause_count, sizeof(ilist));
-	if (all_clauses == NULL)
+	if (cstore_init(input_clause_count + INITIAL_CLAUSE_COUNT) != 0)
 	    return bdd_error(BDD_MEMORY);
 	print_proof_comment(1, "Proof of CNF file with %d variables and %d clauses", input_variable_count, input_clause_count);
 	int cid;
-	for (cid = 0; cid < alloc_clause_count; cid++)
-		all_clauses[cid] = TAUTOLOGY_CLAUSE;
 	if (input_clauses) {
 	    for (cid = 0; cid < input_clause_count; cid++) {
-		all_clauses[cid] = ilist_copy(input_clauses[cid]);
+		cstore_add(cid+1, input_clauses[cid]);
 		if (print_ok(2)) {
-		    fprintf(proof_file, "c Input Clause #%d: ", cid+1);
-		    ilist_print(all_clauses[cid], proof_file, " ");
-		    fprintf(proof_file, " 0\n");
+		    pw_printf(&pwrite, "c Input Clause #%d: ", cid+1);
+		    pw_ilist(&pwrite, input_clauses[cid], " ");
+		    pw_string(&pwrite, " 0\n");
 		}
 	    }
 	}
     }
+    clause_buf = ilist_new(10);
+    input_buf = ilist_new(10);
 
     deferred_deletion_list = ilist_new(100);
 
 
-    int bnodes = input_clause_count < BUDDY_THRESHOLD ? BUDDY_NODES_SMALL : BUDDY_NODES_LARGE;
+    int bnodes = initial_node_count();
     int bcache = bnodes/BUDDY_CACHE_RATIO;
-    int bincrease = input_clause_count < BUDDY_THRESHOLD ? BUDDY_INCREASE_SMALL : BUDDY_INCREASE_LARGE;
     int rval = bdd_init(bnodes, bcache);
+    if (rval == 0 && verbosity_level >= 1)
+	printf("c Initial node table: %d nodes\n", bdd_getallocnum());
 
     int *varlist = NULL;
     if (variable_ordering != NULL) {
@@ -185,16 +206,19 @@ int prover_init(FILE *pfile, int *var_counter, int *cls_counter, ilist *input_cl
     }
 
     bdd_setcacheratio(BUDDY_CACHE_RATIO);
-    bdd_setmaxincrease(bincrease);
+#if STRESS
+    bdd_setmaxincrease(BUDDY_INCREASE);
+#else
+    bdd_setadaptive(1);
+#endif
     bdd_setvarnum_ordered(input_variable_count+1, varlist);
     bdd_disable_reorder();
     return rval;
 }
 
 void prover_done() {
-    free(dest_buf);
     if (proof_type == PROOF_FRAT) {
-	int ebuf[ILIST_OVHD];
+	ival_t ebuf[ILIST_OVHD];
 	ilist elist = ilist_make(ebuf, 0);
 	/* Do final garbage collection to delete remaining clauses */
 	//	bdd_gbc();
@@ -204,9 +228,25 @@ void prover_done() {
 	    insert_frat_clause(proof_file, 'f', empty_clause_id, elist, do_binary);
 	}
     }
+    int trim_err = 0;
+    if (trim_proof) {
+	trim_err = trim_finish(&pwrite, empty_clause_id, do_binary, &trimmed_clause_count);
+	trim_done();
+    }
+    if (proof_type != PROOF_NONE) {
+	pw_done(&pwrite);
+	proof_stall_count = pwrite.stall_count;
+	proof_stall_seconds = pwrite.stall_seconds;
+    }
+    cstore_done();
+    ilist_free(clause_buf);
+    ilist_free(input_buf);
+    clause_buf = input_buf = NULL;
     
     //    if (deferred_deletion_list)
     //	ilist_free(deferred_deletion_list);
+    if (trim_err != 0)
+	bdd_error(trim_err);
 }
 
 
@@ -220,9 +260,9 @@ void print_clause(FILE *out, ilist clause) {
     char *bstring = "[";
     for (i = 0; i < ilist_length(clause); i++) {
 	int lit = clause[i];
-	if (lit == TAUTOLOGY) 
+	if (lit == TAUTOLOGY_LIT) 
 	    fprintf(out, "%sTRUE", bstring);
-	else if (lit == -TAUTOLOGY)
+	else if (lit == -TAUTOLOGY_LIT)
 	    fprintf(out, "%sFALSE", bstring);
 	else
 	    fprintf(out, "%s%d", bstring, lit);
@@ -231,20 +271,90 @@ void print_clause(FILE *out, ilist clause) {
     fprintf(out, "]");
 }
 
-/* Helper function for clause cleaning.  Sort literals to put variables in descending order */
-int literal_compare(const void *l1p, const void *l2p) {
-     int bvn = bdd_varnum();
-     int l1 = *(int *) l1p;
-     int l2 = *(int *) l2p;
-     int v1 = l1 < 0 ? -l1 : l1;
-     int v2 = l2 < 0 ? -l2 : l2;
-     int x1 = v1 < bvn ? bdd_var2level(v1) : v1;
-     int x2 = v2 < bvn ? bdd_var2level(v2) : v2;
-     if (x2 > x1)
-	 return 1;
-     if (x2 < x1)
-	 return -1;
-     return 0;
+/*
+  Helper functions for clause cleaning.  Sort literals to put variables
+  in descending order of level.  Extension variables (numbered beyond
+  the BDD variables) are ordered by variable number.  Nearly all
+  clauses generated by apply steps and node definitions have at most 4
+  literals, and so these are sorted by insertion with precomputed keys.
+  Long clauses (e.g., from clause validation) use a radix sort, or
+  insertion when there is no memory for it.  All sorts are stable.
+*/
+
+#define SHORT_CLAUSE 16
+
+static inline unsigned literal_key(ival_t lit, int bvn) {
+    int var = lit < 0 ? -lit : lit;
+    return var < bvn ? (unsigned) bddvar2level[var] : (unsigned) var;
+}
+
+static void literal_sort_short(ilist clause, int len, int bvn) {
+    unsigned key[SHORT_CLAUSE];
+    int i, j;
+    for (i = 0; i < len; i++) {
+	ival_t lit = clause[i];
+	unsigned k = literal_key(lit, bvn);
+	for (j = i; j > 0 && key[j-1] < k; j--) {
+	    key[j] = key[j-1];
+	    clause[j] = clause[j-1];
+	}
+	key[j] = k;
+	clause[j] = lit;
+    }
+}
+
+typedef struct {
+    unsigned key;
+    ival_t lit;
+} literal_entry_t;
+
+/* Same order as literal_sort_short, without a key array.  Quadratic */
+static void literal_sort_insert(ilist clause, int len, int bvn) {
+    int i, j;
+    for (i = 1; i < len; i++) {
+	ival_t lit = clause[i];
+	unsigned k = literal_key(lit, bvn);
+	for (j = i; j > 0 && literal_key(clause[j-1], bvn) < k; j--)
+	    clause[j] = clause[j-1];
+	clause[j] = lit;
+    }
+}
+
+/* Radix sort, or insertion sort when out of memory */
+static void literal_sort_long(ilist clause, int len, int bvn) {
+    literal_entry_t *src = malloc(2 * len * sizeof(literal_entry_t));
+    if (src == NULL) {
+	literal_sort_insert(clause, len, bvn);
+	return;
+    }
+    literal_entry_t *dst = src + len;
+    literal_entry_t *buf = src;
+    int i, shift;
+    /* Complement keys so that ascending radix sort gives descending levels */
+    for (i = 0; i < len; i++) {
+	src[i].key = ~literal_key(clause[i], bvn);
+	src[i].lit = clause[i];
+    }
+    for (shift = 0; shift < 32; shift += 8) {
+	int count[256];
+	memset(count, 0, sizeof(count));
+	for (i = 0; i < len; i++)
+	    count[(src[i].key >> shift) & 0xFF]++;
+	if (count[(src[0].key >> shift) & 0xFF] == len)
+	    continue;
+	int pos = 0;
+	for (i = 0; i < 256; i++) {
+	    int c = count[i];
+	    count[i] = pos;
+	    pos += c;
+	}
+	for (i = 0; i < len; i++)
+	    dst[count[(src[i].key >> shift) & 0xFF]++] = src[i];
+	literal_entry_t *t = src; src = dst; dst = t;
+    }
+    for (i = 0; i < len; i++)
+	clause[i] = src[i].lit;
+    free(buf);
 }
 
 ilist clean_clause(ilist clause) {
@@ -256,20 +366,25 @@ ilist clean_clause(ilist clause) {
     //    printf("Cleaning clause [");
     //    ilist_print(clause, stdout, " ");
     /* Sort the literals */
-    qsort((void *) clause, ilist_length(clause), sizeof(int), literal_compare);
+    int bvn = bdd_varnum();
+    if (len <= SHORT_CLAUSE)
+	literal_sort_short(clause, len, bvn);
+    else
+	literal_sort_long(clause, len, bvn);
     int geti = 0;
     int puti = 0;
     int plit = 0;
     while (geti < len) {
 	int lit = clause[geti++];
-	if (lit == TAUTOLOGY)
+	if (lit == TAUTOLOGY_LIT)
 	    return TAUTOLOGY_CLAUSE;
-	if (lit == -TAUTOLOGY)
+	if (lit == -TAUTOLOGY_LIT)
 	    continue;
 	if (lit == 0) {
-	    fprintf(proof_file, "c ERROR.  Encountered literal 0 cleaning clause [");
-	    ilist_print(clause, proof_file, " ");
-	    fprintf(proof_file, "].\n");
+	    pw_string(&pwrite, "c ERROR.  Encountered literal 0 cleaning clause [");
+	    pw_ilist(&pwrite, clause, " ");
+	    pw_string(&pwrite, "].\n");
+	    pw_flush(&pwrite);
 
 	    fprintf(ERROUT, "c ERROR.  Encountered literal 0 cleaning clause [");
 	    ilist_print(clause, ERROUT, " ");
@@ -292,15 +407,15 @@ ilist clean_clause(ilist clause) {
 
 #if DO_TRACE
 /* Look for specified ID  among clause or hints */
-static void trace_list(ilist list, int step_id, char *msg) {
+static void trace_list(ilist list, clause_id_t step_id, char *msg) {
     int i;
     if (list == TAUTOLOGY_CLAUSE)
 	return;
     int len = ilist_length(list);
     for (i = 0; i < len; i++) {
-	int id = list[i];
+	clause_id_t id = list[i];
 	if (id == TRACE_CLAUSE) {
-	    printf("TRACE.  Found %d on step #%d: %s [", TRACE_CLAUSE, step_id, msg);
+	    printf("TRACE.  Found %d on step #" CLAUSE_ID_FMT ": %s [", TRACE_CLAUSE, step_id, msg);
 	    ilist_print(list, stdout, " ");
 	    printf("]\n");
 	}
@@ -314,72 +429,95 @@ static ilist clean_hints(ilist hints) {
     int geti = 0;
     int puti = 0;
     while (geti < len) {
-	int lit = hints[geti++];
-	if (lit != TAUTOLOGY)
-	    hints[puti++] = lit;
+	clause_id_t hint = hints[geti++];
+	if (hint != TAUTOLOGY)
+	    hints[puti++] = hint;
     }
     hints = ilist_resize(hints, puti);
     return hints;
 }
 
 
-/*
-  Compress integer list into byte sequence.
-  Unsigned char array passed in to fill.
-  Should be 5x longer than number of int's
- */
-static int check_buffer(int icount) {
-    size_t len = 5*icount;
-    if (len > dest_buf_len) {
-	dest_buf_len = len;
-	dest_buf = realloc(dest_buf, len);
-	if (dest_buf == NULL) 
-	    return bdd_error(BDD_MEMORY);
+/* Write FRAT clause line.  Clause has already been cleaned */
+static void write_frat_clause(pwriter *pw, char cmd, clause_id_t clause_id, ilist clause, bool binary) {
+    if (binary) {
+	pw_bint(pw, cmd);
+	pw_bint(pw, clause_id);
+	pw_bilist(pw, clause);
+	pw_bint(pw, 0);
+    } else {
+	pw_char(pw, cmd);
+	pw_char(pw, ' ');
+	pw_int(pw, clause_id);
+	pw_char(pw, ' ');
+	pw_ilist(pw, clause, " ");
+	pw_string(pw, " 0\n");
     }
-    return 0;
 }
 
-/* Convert integer into byte sequence.  Return number of bytes */
-static int int_byte_pack(int x, unsigned char *dest) {
-    unsigned char *d = dest;
-    unsigned u = x < 0 ? 2*(-x)+1 : 2*x;
-    while (u >= 128) {
-	unsigned char b = u & 0x7F;
-	u >>= 7;
-	*d++ =  b+128;
+/* Write clause and account for it.  Clause and hints have already been cleaned */
+static void add_clause(clause_id_t cid, ilist clause, ilist hints) {
+    if (checker_add_clause && empty_clause_id == TAUTOLOGY)
+	checker_add_clause(cid, clause, hints);
+    if (trim_proof) {
+	if (empty_clause_id == TAUTOLOGY)
+	    trim_add(cid, clause, hints);
+    } else if (empty_clause_id == TAUTOLOGY) {
+	if (do_binary) {
+	    pw_char(&pwrite, 'a');
+	    if (proof_type == PROOF_LRAT || proof_type == PROOF_FRAT)
+		pw_bint(&pwrite, cid);
+	    pw_bilist(&pwrite, clause);
+	    pw_bint(&pwrite, 0);
+	    if (proof_type == PROOF_FRAT)
+		pw_char(&pwrite, 'l');
+	    if (proof_type == PROOF_LRAT || proof_type == PROOF_FRAT) {
+		pw_bilist(&pwrite, hints);
+		pw_bint(&pwrite, 0);
+	    }
+	} else {
+	    if (proof_type == PROOF_FRAT)
+		pw_string(&pwrite, "a ");
+	    if (proof_type == PROOF_LRAT || proof_type == PROOF_FRAT) {
+		pw_int(&pwrite, cid);
+		pw_char(&pwrite, ' ');
+	    }
+	    pw_ilist(&pwrite, clause, " ");
+	    if (proof_type == PROOF_LRAT) {
+		pw_string(&pwrite, " 0 ");
+		pw_ilist(&pwrite, hints, " ");
+	    }
+	    if (proof_type == PROOF_FRAT) {
+		pw_string(&pwrite, " 0 l ");
+		pw_ilist(&pwrite, hints, " ");
+	    }
+	    pw_string(&pwrite, " 0\n");
+	}
     }
-    *d++ = u;
-    return d - dest;
-}
-
-/* Convert integer list into byte sequence.  Return number of bytes */
-static int ilist_byte_pack(ilist src_list, unsigned char *dest) {
-    int i;
-    unsigned char *d = dest;
-    for (i = 0; i < ilist_length(src_list); i++) {
-	d += int_byte_pack(src_list[i], d);
+    total_clause_count++;
+    live_clause_count++;
+    max_live_clause_count = MAX(max_live_clause_count, live_clause_count);
+    
+    if (proof_type == PROOF_DRAT || proof_type == PROOF_FRAT) {
+	/* Must store copy of clause */
+	cstore_add(cid, clause);
     }
-    return d - dest;
+    if (ilist_length(clause) == 0)
+	empty_clause_id = cid;
 }
 
 /* Return clause ID */
 /* For DRAT proof, hints can be NULL */
-int generate_clause(ilist literals, ilist hints) {
+clause_id_t generate_clause(ilist literals, ilist hints) {
     if (proof_type == PROOF_NONE)
 	return TAUTOLOGY;
     ilist clause = clean_clause(literals);
-    int cid = ++(*clause_id_counter);
+    clause_id_t cid = ++(*clause_id_counter);
     if (cid < 0) {
 	fprintf(ERROUT, "ERROR: Overflowed clause counter\n");
 	bdd_error(TBDD_PROOF);
     }
-    int rval = 0;
     hints = clean_hints(hints);
-    unsigned char *d = dest_buf;
-    if (do_binary) {
-	check_buffer(ilist_length(literals) + ilist_length(hints) + 4);
-	d = dest_buf;
-    }
 
 #if DO_TRACE
     trace_list(clause, cid, "Generated clause");
@@ -388,93 +526,13 @@ int generate_clause(ilist literals, ilist hints) {
 
     if (clause == TAUTOLOGY_CLAUSE)
 	return TAUTOLOGY;
-    if (empty_clause_id == TAUTOLOGY) {
-	if (do_binary)
-	    *d++ = 'a';
-	else if (proof_type == PROOF_FRAT)
-	    fprintf(proof_file, "a ");
-	if (proof_type == PROOF_LRAT || proof_type == PROOF_FRAT) {
-	    if (do_binary) {
-		d += int_byte_pack(cid, d);
-	    } else {
-		rval = fprintf(proof_file, "%d ", cid);
-		if (rval < 0)
-		    bdd_error(BDD_FILE);
-	    }
-	}
-	if (do_binary) {
-	    d += ilist_byte_pack(clause, d);
-	} else
-	    ilist_print(clause, proof_file, " ");
-
-	if (proof_type == PROOF_LRAT) {
-	    if (do_binary) {
-		d += int_byte_pack(0, d);
-		d += ilist_byte_pack(hints, d);
-	    } else {
-		rval = fprintf(proof_file, " 0 ");
-		if (rval < 0) 
-		    bdd_error(BDD_FILE);
-		rval = ilist_print(hints, proof_file, " ");
-		if (rval < 0) 
-		    bdd_error(BDD_FILE);
-	    }
-	}
-	if (proof_type == PROOF_FRAT) {
-	    if (do_binary) {
-		d += int_byte_pack(0, d);
-		*d++ = 'l';
-		d += ilist_byte_pack(hints, d);
-	    } else {
-		rval = fprintf(proof_file, " 0 l ");
-		if (rval < 0) 
-		    bdd_error(BDD_FILE);
-		rval = ilist_print(hints, proof_file, " ");
-		if (rval < 0) 
-		    bdd_error(BDD_FILE);
-	    }
-	}
-	if (do_binary) {
-	    d += int_byte_pack(0, d);
-	    rval = fwrite(dest_buf, 1, d - dest_buf, proof_file);
-	    if (rval < 0)
-		bdd_error(BDD_FILE);
-	} else {
-	    rval = fprintf(proof_file, " 0\n");
-	    if (rval < 0) 
-		bdd_error(BDD_FILE);
-	}
-    }
-    total_clause_count++;
-    live_clause_count++;
-    max_live_clause_count = MAX(max_live_clause_count, live_clause_count);
-    
-    if (proof_type == PROOF_DRAT || proof_type == PROOF_FRAT) {
-	/* Must store copy of clause */
-	if (cid >= alloc_clause_count) {
-	    /* must expand */
-	    int new_alloc_clause_count = alloc_clause_count * 2;
-	    int i;
-	    all_clauses = realloc(all_clauses, new_alloc_clause_count * sizeof(ilist));
-	    if (all_clauses == NULL)
-		bdd_error(BDD_MEMORY);
-	    for (i = alloc_clause_count; i < new_alloc_clause_count; i++) 
-		all_clauses[i] = TAUTOLOGY_CLAUSE;
-	    alloc_clause_count = new_alloc_clause_count;
-	}
-	all_clauses[cid-1] = ilist_copy(clause);
-    }
-    if (ilist_length(clause) == 0)
-	empty_clause_id = cid;
-
+    add_clause(cid, clause, hints);
     return cid;
 }
 
 /* For FRAT, have special clauses */
-extern void insert_frat_clause(FILE *pfile, char cmd, int clause_id, ilist literals, bool binary) {
+extern void insert_frat_clause(FILE *pfile, char cmd, clause_id_t clause_id, ilist literals, bool binary) {
     ilist clause = clean_clause(literals);
-    int rval = 0;
-    unsigned char *d = dest_buf;
 
     // Make sure empty clause only finalized once
     if (cmd == 'f' && empty_clause_id != TAUTOLOGY && ilist_length(literals) == 0) {
@@ -484,41 +542,34 @@ extern void insert_frat_clause(FILE *pfile, char cmd, int clause_id, ilist liter
 	    empty_clause_finalized = true;
     }
 
-    if (binary) {
-	check_buffer(ilist_length(clause) + 3);
-	d = dest_buf;
-	d += int_byte_pack(cmd, d);
-	d += int_byte_pack(clause_id, d);
-	d += ilist_byte_pack(clause, d);
-	d += int_byte_pack(0, d);
-	rval = fwrite(dest_buf, 1, d - dest_buf, pfile);
-	if (rval < 0)
-	    bdd_error(BDD_FILE);
-    } else {
-	rval = fprintf(pfile, "%c %d ", cmd, clause_id);
-	if (rval < 0)
-	    bdd_error(BDD_FILE);
-	rval = ilist_print(clause, pfile, " ");
-	if (rval < 0) 
-	    bdd_error(BDD_FILE);
-	rval = fprintf(pfile, " 0\n");
-	if (rval < 0) 
-	    bdd_error(BDD_FILE);
-    }
+    if (pfile != proof_file) {
+	/* Some other file.  Use buffered writer local to this call */
+	pwriter pw;
+	if (pw_init(&pw, pfile, PW_SMALL_BUFSIZE) != 0)
+	    return;
+	write_frat_clause(&pw, cmd, clause_id, clause, binary);
+	pw_done(&pw);
+    } else
+	write_frat_clause(&pwrite, cmd, clause_id, clause, binary);
 }
 
 void delete_clauses(ilist clause_ids) {
-    int rval;
-    unsigned char *d = dest_buf;
-
     clause_ids = clean_hints(clause_ids);
 
     int dlen = ilist_length(clause_ids);
     live_clause_count -= dlen;
     deleted_clause_count += dlen;
 
+    if (checker_delete_clauses && empty_clause_id == TAUTOLOGY)
+	checker_delete_clauses(clause_ids);
+
     if (empty_clause_id != TAUTOLOGY && proof_type != PROOF_FRAT)
 	return;
+    if (trim_proof) {
+	/* Written with the trimmed proof */
+	trim_delete(clause_ids);
+	return;
+    }
 
 #if DO_TRACE
     trace_list(clause_ids, *clause_id_counter, "Deleted clauses");
@@ -526,29 +577,21 @@ void delete_clauses(ilist clause_ids) {
 
     if (proof_type == PROOF_LRAT) {
 	if (do_binary) {
-	    check_buffer(ilist_length(clause_ids) + 3);
-	    d = dest_buf;
-	    *d++ = 'd';
-	    d += ilist_byte_pack(clause_ids, d);
-	    d += int_byte_pack(0, d);
-	    rval = fwrite(dest_buf, 1, d - dest_buf, proof_file);
-	    if (rval < 0)
-		bdd_error(BDD_FILE);
+	    pw_char(&pwrite, 'd');
+	    pw_bilist(&pwrite, clause_ids);
+	    pw_bint(&pwrite, 0);
 	} else {
-	    rval = fprintf(proof_file, "%d d ", *clause_id_counter);
-	    if (rval < 0)
-		bdd_error(BDD_FILE);
-	    ilist_print(clause_ids, proof_file, " ");
-	    rval = fprintf(proof_file, " 0\n");
-	    if (rval < 0) 
-		bdd_error(BDD_FILE);
+	    pw_int(&pwrite, *clause_id_counter);
+	    pw_string(&pwrite, " d ");
+	    pw_ilist(&pwrite, clause_ids, " ");
+	    pw_string(&pwrite, " 0\n");
 	}
     } else {
 	// DRAT or FRAT
 	int i;
 	for (i = 0; i < ilist_length(clause_ids); i++) {
-	    int cid = clause_ids[i];
-	    ilist clause = all_clauses[cid-1];
+	    clause_id_t cid = clause_ids[i];
+	    ilist clause = cstore_get(cid, &clause_buf);
 	    if (clause == TAUTOLOGY_CLAUSE)
 		continue;
 	    if (cid == empty_clause_id)
@@ -558,40 +601,27 @@ void delete_clauses(ilist clause_ids) {
 		// Don't delete unit clauses in DRAT
 		continue;
 	    if (do_binary) {
-		check_buffer(ilist_length(clause) + 3);
-		d = dest_buf;
-		*d++ = 'd';
+		pw_char(&pwrite, 'd');
 		if (proof_type == PROOF_FRAT)
-		    d += int_byte_pack(cid, d);
-		d += ilist_byte_pack(clause, d);
-		d += int_byte_pack(0, d);
-		rval = fwrite(dest_buf, 1, d - dest_buf, proof_file);
-		if (rval < 0)
-		    bdd_error(BDD_FILE);
+		    pw_bint(&pwrite, cid);
+		pw_bilist(&pwrite, clause);
+		pw_bint(&pwrite, 0);
 	    } else {
-		rval = fprintf(proof_file, "d ");
-		if (rval < 0) 
-		    bdd_error(BDD_FILE);
+		pw_string(&pwrite, "d ");
 		if (proof_type == PROOF_FRAT) {
-		    rval = fprintf(proof_file, "%d ", cid);
-		    if (rval < 0)
-			bdd_error(BDD_FILE);
+		    pw_int(&pwrite, cid);
+		    pw_char(&pwrite, ' ');
 		}
-		rval = ilist_print(clause, proof_file, " ");
-		if (rval < 0) 
-		    bdd_error(BDD_FILE);
-		rval = fprintf(proof_file, " 0\n");
-		if (rval < 0) 
-		    bdd_error(BDD_FILE);
+		pw_ilist(&pwrite, clause, " ");
+		pw_string(&pwrite, " 0\n");
 	    }
-	    ilist_free(clause);
-	    all_clauses[cid-1] = TAUTOLOGY_CLAUSE;
+	    cstore_delete(cid);
 	}
     }
 }
 
 /* Some deletions must be deferred until top-level apply completes */
-void defer_delete_clause(int clause_id) {
+void defer_delete_clause(clause_id_t clause_id) {
     deferred_deletion_list = ilist_push(deferred_deletion_list, clause_id);
 }
 
@@ -608,12 +638,15 @@ void process_deferred_deletions() {
 ilist get_input_clause(int id) {
     if (id > input_clause_count)
 	return NULL;
-    return all_clauses[id-1];
+    return cstore_get(id, &input_buf);
 }
 
 bool print_ok(int vlevel) {
     if (proof_type == PROOF_NONE)
 	return false;
+    /* Comments refer to clause IDs that get renumbered */
+    if (trim_proof)
+	return false;
     if (do_binary)
 	return false;
     if (verbosity_level < vlevel+1)
@@ -624,20 +657,13 @@ bool print_ok(int vlevel) {
 }
 
 void print_proof_comment(int vlevel, const char *fmt, ...) {
-    int rval;
     if (print_ok(vlevel)) {
 	va_list vlist;
-	rval = fprintf(proof_file, "c ");
-	if (rval < 0) 
-	    bdd_error(BDD_FILE);
+	pw_string(&pwrite, "c ");
 	va_start(vlist, fmt);
-	rval = vfprintf(proof_file, fmt, vlist);
-	if (rval < 0) 
-	    bdd_error(BDD_FILE);
+	pw_vprintf(&pwrite, fmt, vlist);
 	va_end(vlist);
-	rval = fprintf(proof_file, "\n");
-	if (rval < 0) 
-	    bdd_error(BDD_FILE);
+	pw_char(&pwrite, '\n');
     }
 }
 
@@ -686,13 +712,29 @@ typedef enum { HINT_RESHU, HINT_ARG1HD, HINT_ARG2HD, HINT_OPH, HINT_RESLU, HINT_
 const char *hint_name[HINT_COUNT+1] = {"RESHU", "ARG1HD", "ARG2HD", "OPH", "RESLU", "ARG1LD", "ARG2LD", "OPL", "EXTRA"};
 
 /*
-  Data structures used during proof generation
+  Data structures used during proof generation.
+  Each task of a parallel operation has its own set.
  */
 
-static int hint_id[HINT_COUNT+1];
-static int hint_buf[HINT_COUNT+1][MAX_CLAUSE+ILIST_OVHD];
-static ilist hint_clause[HINT_COUNT+1];
-static bool hint_used[HINT_COUNT+1];
+/*
+  Each hint clause is also encoded as a pair of bit masks, giving its
+  positive and negative literals.  Bit i stands for variable
+  hint_var[i].  The arguments, result and their children at the split
+  level give at most 10 distinct variables.
+*/
+#define MAX_HINT_VAR 32
+
+typedef struct {
+    clause_id_t hint_id[HINT_COUNT+1];
+    ival_t hint_buf[HINT_COUNT+1][MAX_CLAUSE+ILIST_OVHD];
+    ilist hint_clause[HINT_COUNT+1];
+    bool hint_used[HINT_COUNT+1];
+    ival_t hint_var[MAX_HINT_VAR];
+    int hint_var_count;
+    bool hint_encoded;  /* Set when all hints have been encoded */
+    unsigned hint_pos[HINT_COUNT+1];
+    unsigned hint_neg[HINT_COUNT+1];
+} jhints;
 
 static jtype_t hint_hl_order[HINT_COUNT] = 
     { HINT_RESHU, HINT_ARG1HD, HINT_ARG2HD, HINT_OPH, HINT_RESLU, HINT_ARG1LD, HINT_ARG2LD, HINT_OPL };
@@ -710,34 +752,72 @@ static jtype_t hint_l_order[HINT_COUNT/2+1] =
 
 static char hstring[1024];
 
-static void initialize_hints() {
+static void initialize_hints(jhints *jh) {
     jtype_t hi;
     for (hi = (jtype_t) 0; hi < HINT_COUNT+1; hi++) {
-	hint_id[hi] = TAUTOLOGY;
-	hint_clause[hi] = ilist_make(hint_buf[hi], 3);
+	jh->hint_id[hi] = TAUTOLOGY;
+	jh->hint_clause[hi] = ilist_make(jh->hint_buf[hi], 3);
+    }
+}
+
+/* Encode clause as bit masks.  Return false if there are too many variables */
+static bool encode_clause(jhints *jh, ilist clause, unsigned *pos, unsigned *neg) {
+    int li, vi;
+    *pos = *neg = 0;
+    for (li = 0; li < ilist_length(clause); li++) {
+	ival_t lit = clause[li];
+	ival_t var = lit < 0 ? -lit : lit;
+	for (vi = 0; vi < jh->hint_var_count; vi++)
+	    if (jh->hint_var[vi] == var)
+		break;
+	if (vi == jh->hint_var_count) {
+	    if (vi == MAX_HINT_VAR)
+		return false;
+	    jh->hint_var[jh->hint_var_count++] = var;
+	}
+	if (lit < 0)
+	    *neg |= 1u << vi;
+	else
+	    *pos |= 1u << vi;
     }
+    return true;
+}
+
+static void encode_hint(jhints *jh, jtype_t hi) {
+    if (jh->hint_encoded && jh->hint_id[hi] != TAUTOLOGY)
+	jh->hint_encoded = encode_clause(jh, jh->hint_clause[hi], &jh->hint_pos[hi], &jh->hint_neg[hi]);
 }
 
-static void complete_hints() {
+static void complete_hints(jhints *jh) {
     jtype_t hi;
+    jh->hint_var_count = 0;
+    jh->hint_encoded = true;
     for (hi = (jtype_t) 0; hi < HINT_COUNT+1; hi++) {
-	if (hint_id[hi] == TAUTOLOGY)
-	    hint_clause[hi] = TAUTOLOGY_CLAUSE;
+	if (jh->hint_id[hi] == TAUTOLOGY)
+	    jh->hint_clause[hi] = TAUTOLOGY_CLAUSE;
 	else {
-	    hint_clause[hi] = clean_clause(hint_clause[hi]);
-	    if (hint_clause[hi] == TAUTOLOGY_CLAUSE)
-		hint_id[hi] = TAUTOLOGY;
+	    jh->hint_clause[hi] = clean_clause(jh->hint_clause[hi]);
+	    if (jh->hint_clause[hi] == TAUTOLOGY_CLAUSE)
+		jh->hint_id[hi] = TAUTOLOGY;
 	}
+	encode_hint(jh, hi);
     }
 }
 
-static void show_hints(FILE *outfile) {
+/* Show hints on outfile, or in proof when outfile is NULL */
+static void show_hints(jhints *jh, FILE *outfile) {
     jtype_t hi;
     for (hi = (jtype_t) 0; hi < HINT_COUNT+1; hi++) {
-	if (hint_id[hi] != TAUTOLOGY) {
-	    fprintf(outfile, "c    %s: #%d = [", hint_name[hi], hint_id[hi]);
-	    ilist_print(hint_clause[hi], outfile, " ");
-	    fprintf(outfile, "]\n");
+	if (jh->hint_id[hi] != TAUTOLOGY) {
+	    if (outfile == NULL) {
+		pw_printf(&pwrite, "c    %s: #" CLAUSE_ID_FMT " = [", hint_name[hi], jh->hint_id[hi]);
+		pw_ilist(&pwrite, jh->hint_clause[hi], " ");
+		pw_string(&pwrite, "]\n");
+	    } else {
+		fprintf(outfile, "c    %s: #" CLAUSE_ID_FMT " = [", hint_name[hi], jh->hint_id[hi]);
+		ilist_print(jh->hint_clause[hi], outfile, " ");
+		fprintf(outfile, "]\n");
+	    }
 	}
     }
 }
@@ -752,41 +832,85 @@ static ilist target_imply(ilist ils, BDD l, BDD r) {
 }
 	
 
-static bool rup_check(ilist target_clause, jtype_t *horder, int hcount) {
-    int ubuf[8+ILIST_OVHD];
+/*
+  RUP check on the encoded hints.  The units are never contradictory,
+  and so a hint clause stops the check when one of its literals is a
+  unit, gives a conflict when all of them are falsified, and gives a
+  new unit when all but one are.  This matches rup_check, without
+  copying the clauses or searching the units.
+*/
+static bool rup_check_encoded(jhints *jh, ilist target_clause, jtype_t *horder, int hcount) {
+    unsigned upos, uneg;
+    int oi;
+    /* Units are the negated literals of the target */
+    if (!encode_clause(jh, target_clause, &uneg, &upos))
+	return false;
+    for (oi = 0; oi < hcount; oi++) {
+	jtype_t hi = horder[oi];
+	if (jh->hint_id[hi] == TAUTOLOGY)
+	    continue;
+	unsigned pos = jh->hint_pos[hi];
+	unsigned neg = jh->hint_neg[hi];
+	if ((pos & upos) || (neg & uneg))
+	    return false;
+	unsigned rpos = pos & ~uneg;
+	unsigned rneg = neg & ~upos;
+	if ((rpos | rneg) == 0) {
+	    if (pos | neg) {
+		/* Conflict detected */
+		jh->hint_used[hi] = true;
+		return true;
+	    }
+	} else if (rneg == 0 && (rpos & (rpos-1)) == 0) {
+	    upos |= rpos;
+	    jh->hint_used[hi] = true;
+	} else if (rpos == 0 && (rneg & (rneg-1)) == 0) {
+	    uneg |= rneg;
+	    jh->hint_used[hi] = true;
+	}
+    }
+    return false;
+}
+
+static bool rup_check(jhints *jh, ilist target_clause, jtype_t *horder, int hcount) {
+    int hi;
+    for (hi = 0; hi < HINT_COUNT+1; hi++) 
+	jh->hint_used[hi] = false;
+    /* Steps are only traced by the generic version */
+    if (jh->hint_encoded && !print_ok(4))
+	return rup_check_encoded(jh, target_clause, horder, hcount);
+    ival_t ubuf[8+ILIST_OVHD];
     ilist ulist = ilist_make(ubuf, 8);
-    int cbuf[MAX_CLAUSE+ILIST_OVHD];
+    ival_t cbuf[MAX_CLAUSE+ILIST_OVHD];
     ilist cclause = ilist_make(cbuf, MAX_CLAUSE);
-    int oi, hi, li, ui;
+    int oi, li, ui;
     for (ui = 0; ui < ilist_length(target_clause); ui++)
 	ilist_push(ulist, -target_clause[ui]);
     if (print_ok(4)) {
-	fprintf(proof_file, "c RUP start.  Target = [");
-	ilist_print(target_clause, proof_file, " ");
-	fprintf(proof_file, "]\n");
+	pw_string(&pwrite, "c RUP start.  Target = [");
+	pw_ilist(&pwrite, target_clause, " ");
+	pw_string(&pwrite, "]\n");
     }
-    for (hi = 0; hi < HINT_COUNT; hi++) 
-	hint_used[hi] = false;
     for (oi = 0; oi < hcount; oi++) {
 	jtype_t hi = horder[oi];
-	if (hint_id[hi] != TAUTOLOGY) {
-	    ilist clause = hint_clause[hi];
+	if (jh->hint_id[hi] != TAUTOLOGY) {
+	    ilist clause = jh->hint_clause[hi];
 	    /* Operate on copy of clause so that can manipulate */
 	    ilist_resize(cclause, 0);
 	    for (li = 0; li < ilist_length(clause); li++)
 		ilist_push(cclause, clause[li]);
 	    if (print_ok(4)) {
-		fprintf(proof_file, "c   RUP step.  Units = [");
-		ilist_print(ulist, proof_file, " ");
-		fprintf(proof_file, "] Clause = %s\n", hint_name[hi]);
+		pw_string(&pwrite, "c   RUP step.  Units = [");
+		pw_ilist(&pwrite, ulist, " ");
+		pw_printf(&pwrite, "] Clause = %s\n", hint_name[hi]);
 	    }
 	    li = 0;
 	    while (li < ilist_length(cclause)) {
 		int lit = cclause[li];
 		if (print_ok(5)) {
-		    fprintf(proof_file, "c     cclause = [");
-		    ilist_print(cclause, proof_file, " ");
-		    fprintf(proof_file, "]  ");
+		    pw_string(&pwrite, "c     cclause = [");
+		    pw_ilist(&pwrite, cclause, " ");
+		    pw_string(&pwrite, "]  ");
 		}
 		bool found = false;
 		for (ui = 0; ui < ilist_length(ulist); ui++) {
@@ -796,17 +920,17 @@ static bool rup_check(ilist target_clause, jtype_t *horder, int hcount) {
 		    }
 		    if (lit == ulist[ui]) {
 			if (print_ok(5))
-			    fprintf(proof_file, "c Unit %d Found.  Creates tautology\n", -lit);
+			    pw_printf(&pwrite, "c Unit %d Found.  Creates tautology\n", -lit);
 			return false;
 		    }
 		}
 		if (found) { 
 		    if (print_ok(5))
-			fprintf(proof_file, "c Unit %d found.  Deleting %d\n", -lit, lit);
+			pw_printf(&pwrite, "c Unit %d found.  Deleting %d\n", -lit, lit);
 		    if (ilist_length(cclause) == 1) {
 			print_proof_comment(4, "c   Conflict detected");
 			/* Conflict detected */
-			hint_used[hi] = true;
+			jh->hint_used[hi] = true;
 			return true;
 		    } else {
 			/* Remove lit from cclause by swapping with last one */
@@ -816,15 +940,15 @@ static bool rup_check(ilist target_clause, jtype_t *horder, int hcount) {
 		    }
 		} else {
 		    if (print_ok(5))
-			fprintf(proof_file, "c Unit %d NOT found.  Keeping %d\n", -lit, lit);
+			pw_printf(&pwrite, "c Unit %d NOT found.  Keeping %d\n", -lit, lit);
 		    li++;
 		}
 	    }
 	    if (ilist_length(cclause) == 1) {
 		/* Unit propagation */
-		print_proof_comment(5, "  Unit propagation of %d", cclause[0]);
+		print_proof_comment(5, "  Unit propagation of %d", (int) cclause[0]);
 		ilist_push(ulist, cclause[0]);
-		hint_used[hi] = true;
+		jh->hint_used[hi] = true;
 	    }
 	}
     }
@@ -835,19 +959,195 @@ static bool rup_check(ilist target_clause, jtype_t *horder, int hcount) {
 
 
 
-int justify_apply(int op, BDD l, BDD r, int splitVar, pcbdd tresl, pcbdd tresh, BDD res) {
-    int tbuf[MAX_CLAUSE+ILIST_OVHD];
+/******* Proof buffers for parallel operations *****/
+
+/*
+  A task records its steps as a sequence of integers:
+     PB_ADD, ID, clause length, literals, hint count, hints
+     PB_DELETE, count, IDs
+*/
+#define PB_ADD 1
+#define PB_DELETE 2
+
+/* Longest clause or hint list in a step */
+#define PB_MAX_LIST 16
+
+/* Raise error, or record it for the calling thread when deferred */
+static void pbuffer_error(pbuffer *pb, int e) {
+    if (!pb->defer)
+	bdd_error(e);
+    else if (pb->error == 0)
+	pb->error = e;
+}
+
+/* Room for len more integers.  Returns NULL if out of memory */
+static ival_t *pbuffer_reserve(pbuffer *pb, int len) {
+    if (pb->count + len > pb->alloc) {
+	int nalloc = 2 * (pb->count + len);
+	ival_t *ndata = realloc(pb->data, nalloc * sizeof(ival_t));
+	if (ndata == NULL) {
+	    pbuffer_error(pb, BDD_MEMORY);
+	    return NULL;
+	}
+	pb->data = ndata;
+	pb->alloc = nalloc;
+    }
+    return pb->data + pb->count;
+}
+
+/* Counterpart of generate_clause, with the provisional ID given */
+static clause_id_t buffer_clause(pbuffer *pb, ilist literals, ilist hints, clause_id_t cid) {
+    ilist clause = clean_clause(literals);
+    int i;
+    hints = clean_hints(hints);
+    if (clause == TAUTOLOGY_CLAUSE)
+	return TAUTOLOGY;
+    int clen = ilist_length(clause);
+    int hlen = ilist_length(hints);
+    ival_t *rec = pbuffer_reserve(pb, 4 + clen + hlen);
+    if (rec == NULL)
+	return TAUTOLOGY;
+    *rec++ = PB_ADD;
+    *rec++ = cid;
+    *rec++ = clen;
+    for (i = 0; i < clen; i++)
+	*rec++ = clause[i];
+    *rec++ = hlen;
+    for (i = 0; i < hlen; i++)
+	*rec++ = hints[i];
+    pb->count += 4 + clen + hlen;
+    return cid;
+}
+
+/* Counterpart of delete_clauses */
+static void buffer_delete(pbuffer *pb, ilist clause_ids) {
+    int dlen = ilist_length(clause_ids);
+    ival_t *rec = pbuffer_reserve(pb, 2 + dlen);
+    int i;
+    if (rec == NULL)
+	return;
+    *rec++ = PB_DELETE;
+    *rec++ = dlen;
+    for (i = 0; i < dlen; i++)
+	*rec++ = clause_ids[i];
+    pb->count += 2 + dlen;
+}
+
+int pbuffer_init(pbuffer *pb) {
+    pb->alloc = 1024;
+    pb->data = malloc(pb->alloc * sizeof(ival_t));
+    pb->hints = malloc(sizeof(jhints));
+    if (pb->data == NULL || pb->hints == NULL) {
+	free(pb->data);
+	free(pb->hints);
+	pb->data = NULL;
+	pb->hints = NULL;
+	return bdd_error(BDD_MEMORY);
+    }
+    pbuffer_reset(pb, 0, NULL);
+    return 0;
+}
+
+void pbuffer_reset(pbuffer *pb, clause_id_t first_id, clause_id_t *final_ids) {
+    pb->count = 0;
+    pb->first_id = first_id;
+    pb->step_id = first_id;
+    pb->final_ids = final_ids;
+    pb->step_count = 0;
+    pb->split_count = 0;
+    pb->defer = 0;
+    pb->error = 0;
+}
+
+/* Final ID for one in a step.  Its clause must already have been written */
+static clause_id_t pbuffer_final(pbuffer *pb, clause_id_t id) {
+    clause_id_t fid = PBUFFER_ID(pb, id);
+    if (fid == 0) {
+	fprintf(ERROUT, "c ERROR.  Provisional clause ID " CLAUSE_ID_FMT " used before its clause was written\n", id);
+	bdd_error(TBDD_PROOF);
+    }
+    return fid;
+}
+
+/* Write steps, numbering their clauses after the ones generated so far */
+void pbuffer_emit(pbuffer *pb) {
+    ival_t cbuf[PB_MAX_LIST+ILIST_OVHD];
+    ival_t hbuf[PB_MAX_LIST+ILIST_OVHD];
+    int i = 0;
+    int k, len;
+    while (i < pb->count) {
+	if (pb->data[i++] == PB_ADD) {
+	    clause_id_t pid = pb->data[i++];
+	    ilist clause = ilist_make(cbuf, PB_MAX_LIST);
+	    len = pb->data[i++];
+	    for (k = 0; k < len; k++)
+		clause = ilist_push(clause, pb->data[i++]);
+	    ilist hints = ilist_make(hbuf, PB_MAX_LIST);
+	    len = pb->data[i++];
+	    for (k = 0; k < len; k++)
+		hints = ilist_push(hints, pbuffer_final(pb, pb->data[i++]));
+	    clause_id_t cid = ++(*clause_id_counter);
+	    if (cid < 0) {
+		fprintf(ERROUT, "ERROR: Overflowed clause counter\n");
+		bdd_error(TBDD_PROOF);
+	    }
+	    pb->final_ids[pid - pb->first_id - 1] = cid;
+	    add_clause(cid, clause, hints);
+	} else {
+	    ilist ids = ilist_make(hbuf, PB_MAX_LIST);
+	    len = pb->data[i++];
+	    for (k = 0; k < len; k++)
+		ids = ilist_push(ids, pbuffer_final(pb, pb->data[i++]));
+	    delete_clauses(ids);
+	}
+    }
+    apply_step_count += pb->step_count;
+    apply_split_count += pb->split_count;
+}
+
+void pbuffer_free(pbuffer *pb) {
+    free(pb->data);
+    free(pb->hints);
+    pb->data = NULL;
+    pb->hints = NULL;
+}
+
+/* A step of a parallel operation goes to its buffer.  Its intermediate
+   clause has provisional ID step_id+1, and its final one step_id+2 */
+static clause_id_t jgenerate(pbuffer *pb, ilist literals, ilist hints, int step) {
+    if (pb == NULL)
+	return generate_clause(literals, hints);
+    return buffer_clause(pb, literals, hints, pb->step_id + step);
+}
+
+/* Count justified step.  Those of a parallel operation are counted once emitted */
+static void count_step(pbuffer *pb, bool split) {
+    if (pb == NULL) {
+	apply_step_count++;
+	apply_split_count += split;
+    } else {
+	pb->step_count++;
+	pb->split_count += split;
+    }
+}
+
+static clause_id_t justify_apply_to(pbuffer *pb, jhints *jh, int op, BDD l, BDD r, int splitVar, pcbdd tresl, pcbdd tresh, BDD res) {
+    ival_t tbuf[MAX_CLAUSE+ILIST_OVHD];
     ilist targ = ilist_make(tbuf, MAX_CLAUSE);
-    int itbuf[MAX_CLAUSE+ILIST_OVHD];
+    ival_t itbuf[MAX_CLAUSE+ILIST_OVHD];
     ilist itarg = ilist_make(itbuf, MAX_CLAUSE);
-    int abuf[8+ILIST_OVHD];
+    ival_t abuf[8+ILIST_OVHD];
     ilist ant = ilist_make(abuf, 8);
-    int dbuf[1+ILIST_OVHD];
+    ival_t dbuf[1+ILIST_OVHD];
     ilist del = ilist_make(dbuf, 1);
     int oi, hi, li;
     int splitLevel = bdd_var2level(splitVar);
 
-    int jid = 0;
+    clause_id_t jid = 0;
+    /* Extension variables of arguments and result occur in target clause */
+    bdd_define_node(l);
+    bdd_define_node(r);
+    bdd_define_node(res);
     if (op == bddop_andj) {
 	targ = clean_clause(target_and(targ, l, r, res));
 	print_proof_comment(2, "Generating proof that N%d & N%d --> N%d", bdd_nameid(l), bdd_nameid(r), bdd_nameid(res));
@@ -862,20 +1162,20 @@ int justify_apply(int op, BDD l, BDD r, int splitVar, pcbdd tresl, pcbdd tresh,
 	return TAUTOLOGY;
     }
     if (print_ok(3)) {
-	fprintf(proof_file, "c Target clause = [");
-	ilist_print(targ, proof_file, " ");
-	fprintf(proof_file, "]\n");
+	pw_string(&pwrite, "c Target clause = [");
+	pw_ilist(&pwrite, targ, " ");
+	pw_string(&pwrite, "]\n");
     }
     
 
     /* Prepare the candidates */
-    initialize_hints();
+    initialize_hints(jh);
 
     if (LEVEL(l) == splitLevel) {
-	hint_id[HINT_ARG1LD] = bdd_dclause(l, DEF_LD);
-	hint_clause[HINT_ARG1LD] = defining_clause(hint_clause[HINT_ARG1LD], DEF_LD, XVAR(l), splitVar, XVAR(HIGH(l)), XVAR(LOW(l)));
-	hint_id[HINT_ARG1HD] = bdd_dclause(l, DEF_HD);
-	hint_clause[HINT_ARG1HD] = defining_clause(hint_clause[HINT_ARG1HD], DEF_HD, XVAR(l), splitVar, XVAR(HIGH(l)), XVAR(LOW(l)));
+	jh->hint_id[HINT_ARG1LD] = bdd_dclause(l, DEF_LD);
+	jh->hint_clause[HINT_ARG1LD] = defining_clause(jh->hint_clause[HINT_ARG1LD], DEF_LD, XVAR(l), splitVar, XVAR(HIGH(l)), XVAR(LOW(l)));
+	jh->hint_id[HINT_ARG1HD] = bdd_dclause(l, DEF_HD);
+	jh->hint_clause[HINT_ARG1HD] = defining_clause(jh->hint_clause[HINT_ARG1HD], DEF_HD, XVAR(l), splitVar, XVAR(HIGH(l)), XVAR(LOW(l)));
     }
 
     BDD ll = LEVEL(l) == splitLevel ? LOW(l) : l;
@@ -887,63 +1187,65 @@ int justify_apply(int op, BDD l, BDD r, int splitVar, pcbdd tresl, pcbdd tresh,
 
     if (op == bddop_imptstj) {
 	if (LEVEL(r) == splitLevel) {
-	    hint_id[HINT_RESLU] = bdd_dclause(r, DEF_LU);
-	    hint_clause[HINT_RESLU] = defining_clause(hint_clause[HINT_RESLU], DEF_LU, XVAR(r), splitVar, XVAR(HIGH(r)), XVAR(LOW(r)));
-	    hint_id[HINT_RESHU] = bdd_dclause(r, DEF_HU);
-	    hint_clause[HINT_RESHU] = defining_clause(hint_clause[HINT_RESHU], DEF_HU, XVAR(r), splitVar, XVAR(HIGH(r)), XVAR(LOW(r)));
+	    jh->hint_id[HINT_RESLU] = bdd_dclause(r, DEF_LU);
+	    jh->hint_clause[HINT_RESLU] = defining_clause(jh->hint_clause[HINT_RESLU], DEF_LU, XVAR(r), splitVar, XVAR(HIGH(r)), XVAR(LOW(r)));
+	    jh->hint_id[HINT_RESHU] = bdd_dclause(r, DEF_HU);
+	    jh->hint_clause[HINT_RESHU] = defining_clause(jh->hint_clause[HINT_RESHU], DEF_HU, XVAR(r), splitVar, XVAR(HIGH(r)), XVAR(LOW(r)));
 	}
-	hint_id[HINT_OPL] = tresl.clause_id;
-	hint_clause[HINT_OPL] = target_imply(hint_clause[HINT_OPL], ll, rl);
-	hint_id[HINT_OPH] = tresh.clause_id;
-	hint_clause[HINT_OPH] = target_imply(hint_clause[HINT_OPH], lh, rh);
+	jh->hint_id[HINT_OPL] = tresl.clause_id;
+	jh->hint_clause[HINT_OPL] = target_imply(jh->hint_clause[HINT_OPL], ll, rl);
+	jh->hint_id[HINT_OPH] = tresh.clause_id;
+	jh->hint_clause[HINT_OPH] = target_imply(jh->hint_clause[HINT_OPH], lh, rh);
     } else {
 	if (LEVEL(r) == splitLevel) {
-	    hint_id[HINT_ARG2LD] = bdd_dclause(r, DEF_LD);
-	    hint_clause[HINT_ARG2LD] = defining_clause(hint_clause[HINT_ARG2LD], DEF_LD, XVAR(r), splitVar, XVAR(HIGH(r)), XVAR(LOW(r)));
-	    hint_id[HINT_ARG2HD] = bdd_dclause(r, DEF_HD);
-	    hint_clause[HINT_ARG2HD] = defining_clause(hint_clause[HINT_ARG2HD], DEF_HD, XVAR(r), splitVar, XVAR(HIGH(r)), XVAR(LOW(r)));
+	    jh->hint_id[HINT_ARG2LD] = bdd_dclause(r, DEF_LD);
+	    jh->hint_clause[HINT_ARG2LD] = defining_clause(jh->hint_clause[HINT_ARG2LD], DEF_LD, XVAR(r), splitVar, XVAR(HIGH(r)), XVAR(LOW(r)));
+	    jh->hint_id[HINT_ARG2HD] = bdd_dclause(r, DEF_HD);
+	    jh->hint_clause[HINT_ARG2HD] = defining_clause(jh->hint_clause[HINT_ARG2HD], DEF_HD, XVAR(r), splitVar, XVAR(HIGH(r)), XVAR(LOW(r)));
 	}
 	if (LEVEL(res) == splitLevel) { // Test was: tresl.root != tresh.root
-	    hint_id[HINT_RESLU] = bdd_dclause(res, DEF_LU);
-	    hint_clause[HINT_RESLU] = defining_clause(hint_clause[HINT_RESLU], DEF_LU, XVAR(res), splitVar, XVAR(HIGH(res)), XVAR(LOW(res)));
-	    hint_id[HINT_RESHU] = bdd_dclause(res, DEF_HU);
-	    hint_clause[HINT_RESHU] = defining_clause(hint_clause[HINT_RESHU], DEF_HU, XVAR(res), splitVar, XVAR(HIGH(res)), XVAR(LOW(res)));
+	    jh->hint_id[HINT_RESLU] = bdd_dclause(res, DEF_LU);
+	    jh->hint_clause[HINT_RESLU] = defining_clause(jh->hint_clause[HINT_RESLU], DEF_LU, XVAR(res), splitVar, XVAR(HIGH(res)), XVAR(LOW(res)));
+	    jh->hint_id[HINT_RESHU] = bdd_dclause(res, DEF_HU);
+	    jh->hint_clause[HINT_RESHU] = defining_clause(jh->hint_clause[HINT_RESHU], DEF_HU, XVAR(res), splitVar, XVAR(HIGH(res)), XVAR(LOW(res)));
 	}
-	hint_id[HINT_OPL] = tresl.clause_id;
-	hint_clause[HINT_OPL] = target_and(hint_clause[HINT_OPL], ll, rl, resl); // Was tresl.root
-	hint_id[HINT_OPH] = tresh.clause_id;
-	hint_clause[HINT_OPH] = target_and(hint_clause[HINT_OPH], lh, rh, resh); // Was tresh.root
+	jh->hint_id[HINT_OPL] = tresl.clause_id;
+	jh->hint_clause[HINT_OPL] = target_and(jh->hint_clause[HINT_OPL], ll, rl, resl); // Was tresl.root
+	jh->hint_id[HINT_OPH] = tresh.clause_id;
+	jh->hint_clause[HINT_OPH] = target_and(jh->hint_clause[HINT_OPH], lh, rh, resh); // Was tresh.root
     }
 
-    complete_hints();
+    complete_hints(jh);
     if (print_ok(3)) {
 	print_proof_comment(3, "Hints:");
-	show_hints(proof_file);
+	show_hints(jh, NULL);
     }
 
     bool checked = false;
-    if (hint_id[HINT_OPH] == TAUTOLOGY) {
+    if (jh->hint_id[HINT_OPH] == TAUTOLOGY) {
 	/* Try for single clause proof */
-	if (rup_check(targ, hint_hl_order, HINT_COUNT)) {
+	if (rup_check(jh, targ, hint_hl_order, HINT_COUNT)) {
 	    checked = true;
 	    for (oi = 0; oi < HINT_COUNT; oi++) {
 		hi = hint_hl_order[oi];
-		if (hint_used[hi])
-		    ilist_push(ant, hint_id[hi]);
+		if (jh->hint_used[hi])
+		    ilist_push(ant, jh->hint_id[hi]);
 	    }
-	    jid = generate_clause(targ, ant);
+	    jid = jgenerate(pb, targ, ant, 2);
+	    count_step(pb, false);
 	}
 
     }
-    if (!checked && hint_id[HINT_OPL] == TAUTOLOGY) {
-	if (rup_check(targ, hint_lh_order, HINT_COUNT)) {
+    if (!checked && jh->hint_id[HINT_OPL] == TAUTOLOGY) {
+	if (rup_check(jh, targ, hint_lh_order, HINT_COUNT)) {
 	    checked = true;
 	    for (oi = 0; oi < HINT_COUNT; oi++) {
 		hi = hint_lh_order[oi];
-		if (hint_used[hi])
-		    ilist_push(ant, hint_id[hi]);
+		if (jh->hint_used[hi])
+		    ilist_push(ant, jh->hint_id[hi]);
 	    }
-	    jid = generate_clause(targ, ant);
+	    jid = jgenerate(pb, targ, ant, 2);
+	    count_step(pb, false);
 	}
     }
     if (!checked) {
@@ -951,54 +1253,91 @@ int justify_apply(int op, BDD l, BDD r, int splitVar, pcbdd tresl, pcbdd tresh,
 	for (li = 0; li < ilist_length(targ); li++)
 	    ilist_push(itarg, targ[li]);
 	itarg = clean_clause(itarg);
-	if (!rup_check(itarg, hint_h_order, HINT_COUNT/2)) {
-	    fprintf(proof_file, "c ERROR.  RUP check failed in first half of proof.  Target = [");
-	    ilist_print(itarg, proof_file, " ");
-	    fprintf(proof_file, "].\n");
+	if (!rup_check(jh, itarg, hint_h_order, HINT_COUNT/2)) {
+	    if (pb != NULL && pb->defer) {
+		pbuffer_error(pb, TBDD_PROOF);
+		return TAUTOLOGY;
+	    }
+	    pw_string(&pwrite, "c ERROR.  RUP check failed in first half of proof.  Target = [");
+	    pw_ilist(&pwrite, itarg, " ");
+	    pw_string(&pwrite, "].\n");
 	    print_proof_comment(3, "  Candidate hints:");
-	    show_hints(proof_file);
+	    show_hints(jh, NULL);
+	    pw_flush(&pwrite);
 
 	    fprintf(ERROUT, "c ERROR.  RUP check failed in first half of proof.  Target = [");
 	    ilist_print(itarg, ERROUT, " ");
 	    fprintf(ERROUT, "].\n");
 	    fprintf(ERROUT, "c   Candidate hints:");
-	    show_hints(ERROUT);
+	    show_hints(jh, ERROUT);
 	    bdd_error(TBDD_PROOF);
 	}
 	for (oi = 0; oi < HINT_COUNT/2; oi++) {
 	    hi = hint_h_order[oi];
-	    if (hint_used[hi])
-		ilist_push(ant, hint_id[hi]);
+	    if (jh->hint_used[hi])
+		ilist_push(ant, jh->hint_id[hi]);
 	}
-	int iid = generate_clause(itarg, ant);
-	hint_id[HINT_EXTRA] = iid;
-	hint_clause[HINT_EXTRA] = itarg;
-	if (!rup_check(targ, hint_l_order, HINT_COUNT/2+1)) {
-	    fprintf(proof_file, "c Uh-Oh.  RUP check failed in second half of proof.  Target = [");
-	    ilist_print(targ, proof_file, " ");
-	    fprintf(proof_file, "].\n");
+	clause_id_t iid = jgenerate(pb, itarg, ant, 1);
+	jh->hint_id[HINT_EXTRA] = iid;
+	jh->hint_clause[HINT_EXTRA] = itarg;
+	encode_hint(jh, HINT_EXTRA);
+	if (!rup_check(jh, targ, hint_l_order, HINT_COUNT/2+1)) {
+	    if (pb != NULL && pb->defer) {
+		pbuffer_error(pb, TBDD_PROOF);
+		return TAUTOLOGY;
+	    }
+	    pw_string(&pwrite, "c Uh-Oh.  RUP check failed in second half of proof.  Target = [");
+	    pw_ilist(&pwrite, targ, " ");
+	    pw_string(&pwrite, "].\n");
 	    print_proof_comment(3, "  Candidate hints:");
-	    show_hints(proof_file);
+	    show_hints(jh, NULL);
+	    pw_flush(&pwrite);
 
 	    fprintf(ERROUT, "c Uh-Oh.  RUP check failed in second half of proof.  Target = [");
 	    ilist_print(itarg, ERROUT, " ");
 	    fprintf(ERROUT, "].\n");
 	    fprintf(ERROUT, "c   Candidate hints:");
-	    show_hints(ERROUT);
+	    show_hints(jh, ERROUT);
 	    bdd_error(TBDD_PROOF);
 
 	}
 	ilist_resize(ant, 0);
 	for (oi = 0; oi < HINT_COUNT/2+1; oi++) {
 	    hi = hint_l_order[oi];
-	    if (hint_used[hi])
-		ilist_push(ant, hint_id[hi]);
+	    if (jh->hint_used[hi])
+		ilist_push(ant, jh->hint_id[hi]);
 	}
 	// Negate ID to show that two clauses were generated
 	//	jid = -generate_clause(targ, ant);
-	jid = generate_clause(targ, ant);
+	jid = jgenerate(pb, targ, ant, 2);
 	ilist_fill1(del, iid);
-	delete_clauses(del);
+	if (pb == NULL)
+	    delete_clauses(del);
+	else
+	    buffer_delete(pb, del);
+	count_step(pb, true);
     }
     return jid;
 }
+
+static double justify_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+clause_id_t justify_apply(int op, BDD l, BDD r, int splitVar, pcbdd tresl, pcbdd tresh, BDD res) {
+    jhints jh;
+    if (time_justify && op == bddop_andj) {
+	double start = justify_seconds();
+	clause_id_t jid = justify_apply_to(NULL, &jh, op, l, r, splitVar, tresl, tresh, res);
+	timed_step_seconds += justify_seconds() - start;
+	timed_step_count++;
+	return jid;
+    }
+    return justify_apply_to(NULL, &jh, op, l, r, splitVar, tresl, tresh, res);
+}
+
+clause_id_t justify_apply_buffer(pbuffer *pb, int op, BDD l, BDD r, int splitVar, pcbdd tresl, pcbdd tresh, BDD res) {
+    return justify_apply_to(pb, (jhints *) pb->hints, op, l, r, splitVar, tresl, tresh, res);
+}
@@ -43,19 +43,49 @@
 extern "C" {
 #endif
 
-/* Global variables exported by prover */
-extern proof_type_t proof_type;
-extern int verbosity_level;
-extern int *variable_counter;
-extern int *clause_id_counter;
-extern int total_clause_count;
-extern int input_variable_count;
-extern int input_clause_count;
-extern int max_live_clause_count;
-extern int deleted_clause_count;
+/*
+  Variables exported by prover.  Each BDD manager has its own set,
+  reached through tbdd_prover_vars
+*/
+typedef struct {
+    proof_type_t proof_type;
+    int verbosity_level;
+    int *variable_counter;
+    clause_id_t *clause_id_counter;
+    clause_id_t total_clause_count;
+    int input_variable_count;
+    int input_clause_count;
+    clause_id_t max_live_clause_count;
+    clause_id_t deleted_clause_count;
+    /* Generate defining clauses for node only once used in proof */
+    bool lazy_defining;
+    int defined_node_count;
+    /* Write only clauses needed to derive empty clause */
+    bool trim_proof;
+    clause_id_t trimmed_clause_count;
+    /* Write proof with background thread */
+    bool async_proof;
+    /* Justify conjunctions on the threads of bdd_setapplythreads */
+    bool parallel_justify;
+    long long proof_stall_count;
+    double proof_stall_seconds;
+    /* Apply steps justified, and those needing an intermediate clause */
+    long long apply_step_count;
+    long long apply_split_count;
+    /* Time the proofs of conjunctions alone, see tbdd_set_time_justify */
+    bool time_justify;
+    long long timed_step_count;
+    double timed_step_seconds;
+    /* In-process proof checker.  NULL when not used */
+    tbdd_add_clause_fun checker_add_clause;
+    tbdd_delete_clauses_fun checker_delete_clauses;
+} prover_vars_t;
+
+/* Variables of the current manager of the calling thread */
+extern prover_vars_t *tbdd_prover_vars(void);
 
 /* Prover setup and completion */
-extern int prover_init(FILE *pfile, int *variable_counter, int *clause_counter, ilist *clauses, ilist variable_ordering, proof_type_t ptype, bool binary);
+extern int prover_init(FILE *pfile, int *variable_counter, clause_id_t *clause_counter, ilist *clauses, ilist variable_ordering, proof_type_t ptype, bool binary);
 extern void prover_done();
 
 /* Put literals in clause in canonical order */
@@ -63,15 +93,15 @@ extern ilist clean_clause(ilist clause);
 
 /* Return clause ID */
 /* For DRAT proof, antecedents can be NULL */
-extern int generate_clause(ilist literals, ilist antecedent);
+extern clause_id_t generate_clause(ilist literals, ilist antecedent);
 
 /* For FRAT, have special clauses */
-extern void insert_frat_clause(FILE *pfile, char cmd, int clause_id, ilist literals, bool binary);
+extern void insert_frat_clause(FILE *pfile, char cmd, clause_id_t clause_id, ilist literals, bool binary);
 
 extern void delete_clauses(ilist clause_ids);
 
 /* Some deletions must be deferred until top-level apply completes */
-extern void defer_delete_clause(int clause_id);
+extern void defer_delete_clause(clause_id_t clause_id);
 extern void process_deferred_deletions();
 
 
@@ -32,13 +32,13 @@
 #include <unordered_set>
 
 #include "pseudoboolean.h"
-#include "prover.h"
+#include "kernel.h"
 
 using namespace trustbdd;
 
-#define BUFLEN 2048
-// For formatting information
-static char ibuf[BUFLEN];
+#define BUFLEN TBDD_BUFLEN
+// For formatting information.  Fields of the current manager, see manager.h
+#define ibuf (bddmanager->pseudo.ibuf)
 
 // Standard seed value
 #define DEFAULT_SEED 123456
@@ -60,15 +60,15 @@ static char ibuf[BUFLEN];
 /*
   Statistics gathering
  */
-static int pseudo_xor_created = 0;
-static int pseudo_xor_unique = 0;
-static int pseudo_total_length = 0;
-static int pseudo_plus_computed = 0;
+#define pseudo_xor_created   (bddmanager->pseudo.pseudo_xor_created)
+#define pseudo_xor_unique    (bddmanager->pseudo.pseudo_xor_unique)
+#define pseudo_total_length  (bddmanager->pseudo.pseudo_total_length)
+#define pseudo_plus_computed (bddmanager->pseudo.pseudo_plus_computed)
 
 static int show_xor_buf(char *buf, ilist variables, int phase, int maxlen);
 static void pseudo_info_fun(int vlevel);
 
-static bool initialized = false;
+#define initialized (bddmanager->pseudo.initialized)
 
 static void pseudo_init() {
     if (!initialized) {
@@ -201,7 +201,7 @@ xor_constraint::xor_constraint(ilist vars, int p) {
     validation = tbdd_from_xor(variables, phase);
 }
 
-int xor_constraint::validate_clause(ilist clause) {
+clause_id_t xor_constraint::validate_clause(ilist clause) {
     return tbdd_validate_clause(clause, validation);
 }
 
@@ -687,7 +687,7 @@ public:
 	    printf("c   %d saved equations\n", (int) external_equations.size());
 	    for (int eid = 0; eid < external_equations.size(); eid++) {
 		int tid = eid + internal_equations.size();
-		printf("c     Pivot variable %d.  Equation: ", pivot_sequence[tid]);
+		printf("c     Pivot variable %d.  Equation: ", (int) pivot_sequence[tid]);
 		external_equations[eid]->show(stdout);
 		printf("\n");
 	    }
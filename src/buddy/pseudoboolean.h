@@ -109,7 +109,7 @@ class xor_constraint {
     bool is_degenerate(void) { return ilist_length(variables) == 0 && phase == 0; }
     
     // Use xor constraint to validate a clause
-    int validate_clause(ilist clause);
+    clause_id_t validate_clause(ilist clause);
 
     // Get the validation TBDD
     tbdd get_validation() { return validation; }
@@ -0,0 +1,293 @@
+/*========================================================================
+  Copyright (c) 2022 Randal E. Bryant, Carnegie Mellon University
+  
+  This code was not included in the original BuDDy distribution and is
+  therefore not subject to any of its licensing terms.
+
+  Permission is hereby granted, free of
+  charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+========================================================================*/
+
+
+/* Proof trimming: Keep only those clauses needed to derive the empty clause */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "kernel.h"
+#include "ptrim.h"
+
+/* Indicates that no clause was recorded with an ID */
+#define NO_CLAUSE SIZE_MAX
+
+/* Fields of the current manager, see manager.h */
+#define input_clause_limit (bddmanager->trim.input_clause_limit)
+/* Position of each clause in store.  Indexed by clause ID */
+#define clause_offset      (bddmanager->trim.clause_offset)
+#define alloc_id_count     (bddmanager->trim.alloc_id_count)
+/*
+  Recorded clauses.  For each clause:
+  number of literals, literals, number of hints, hints.
+  Each encoded with variable-byte encoding of binary proofs.
+ */
+#define store              (bddmanager->trim.store)
+#define store_count        (bddmanager->trim.store_count)
+#define store_alloc        (bddmanager->trim.store_alloc)
+#define last_id            (bddmanager->trim.last_id)
+/*
+  Recorded deletions, in order.  For each list:
+  ID of last clause added before it, number of clauses, clause IDs.
+  Encoded as the clauses.
+ */
+#define dstore             (bddmanager->trim.dstore)
+#define dstore_count       (bddmanager->trim.dstore_count)
+#define dstore_alloc       (bddmanager->trim.dstore_alloc)
+
+int trim_init(int input_count) {
+    clause_id_t id;
+    input_clause_limit = input_count;
+    last_id = input_count;
+    alloc_id_count = 2 * input_count + 1000;
+    clause_offset = malloc(alloc_id_count * sizeof(size_t));
+    if (clause_offset == NULL)
+	return bdd_error(BDD_MEMORY);
+    for (id = 0; id < alloc_id_count; id++)
+	clause_offset[id] = NO_CLAUSE;
+    store_alloc = 1 << 20;
+    store_count = 0;
+    store = malloc(store_alloc);
+    if (store == NULL)
+	return bdd_error(BDD_MEMORY);
+    dstore_alloc = 1 << 16;
+    dstore_count = 0;
+    dstore = malloc(dstore_alloc);
+    if (dstore == NULL)
+	return bdd_error(BDD_MEMORY);
+    return 0;
+}
+
+/* Make room for need more bytes in buffer.  Return false if out of memory */
+static bool trim_reserve(unsigned char **bufp, size_t *allocp, size_t count, size_t need) {
+    if (count + need <= *allocp)
+	return true;
+    size_t new_alloc = *allocp;
+    while (count + need > new_alloc)
+	new_alloc *= 2;
+    unsigned char *new_buf = realloc(*bufp, new_alloc);
+    if (new_buf == NULL) {
+	bdd_error(BDD_MEMORY);
+	return false;
+    }
+    *bufp = new_buf;
+    *allocp = new_alloc;
+    return true;
+}
+
+void trim_add(clause_id_t clause_id, ilist clause, ilist hints) {
+    clause_id_t i;
+    if (clause_id >= alloc_id_count) {
+	clause_id_t new_alloc = 2 * alloc_id_count;
+	if (new_alloc <= clause_id)
+	    new_alloc = clause_id + 1;
+	size_t *new_offset = realloc(clause_offset, new_alloc * sizeof(size_t));
+	if (new_offset == NULL) {
+	    bdd_error(BDD_MEMORY);
+	    return;
+	}
+	clause_offset = new_offset;
+	for (i = alloc_id_count; i < new_alloc; i++)
+	    clause_offset[i] = NO_CLAUSE;
+	alloc_id_count = new_alloc;
+    }
+    size_t need = PW_INT_MAX_BYTES * (2 + ilist_length(clause) + ilist_length(hints));
+    if (!trim_reserve(&store, &store_alloc, store_count, need))
+	return;
+    clause_offset[clause_id] = store_count;
+    last_id = clause_id;
+    unsigned char *d = store + store_count;
+    d += pw_int_pack(ilist_length(clause), d);
+    for (i = 0; i < ilist_length(clause); i++)
+	d += pw_int_pack(clause[i], d);
+    d += pw_int_pack(ilist_length(hints), d);
+    for (i = 0; i < ilist_length(hints); i++)
+	d += pw_int_pack(hints[i], d);
+    store_count = d - store;
+}
+
+void trim_delete(ilist clause_ids) {
+    int i;
+    int dlen = ilist_length(clause_ids);
+    if (dlen == 0)
+	return;
+    if (!trim_reserve(&dstore, &dstore_alloc, dstore_count, PW_INT_MAX_BYTES * (2 + dlen)))
+	return;
+    unsigned char *d = dstore + dstore_count;
+    d += pw_int_pack(last_id, d);
+    d += pw_int_pack(dlen, d);
+    for (i = 0; i < dlen; i++)
+	d += pw_int_pack(clause_ids[i], d);
+    dstore_count = d - dstore;
+}
+
+/*
+  Write the recorded deletions following clause after_id, starting at
+  position *posp in dstore.  Only clauses that have been written, with
+  nonzero new_id, are deleted.  next_id is the last ID written.
+  new_id has an entry for each ID up to empty_id
+ */
+static void trim_write_deletions(pwriter *pw, size_t *posp, clause_id_t after_id,
+				 clause_id_t *new_id, clause_id_t empty_id, clause_id_t next_id, bool binary) {
+    while (*posp < dstore_count) {
+	unsigned char *p = dstore + *posp;
+	if ((clause_id_t) pw_int_unpack(&p) != after_id)
+	    return;
+	int dlen = pw_int_unpack(&p);
+	bool started = false;
+	int i;
+	for (i = 0; i < dlen; i++) {
+	    clause_id_t id = pw_int_unpack(&p);
+	    if (id > empty_id || new_id[id] == 0)
+		continue;
+	    if (!started) {
+		if (binary)
+		    pw_char(pw, 'd');
+		else {
+		    pw_int(pw, next_id);
+		    pw_string(pw, " d");
+		}
+		started = true;
+	    }
+	    if (binary)
+		pw_bint(pw, new_id[id]);
+	    else {
+		pw_char(pw, ' ');
+		pw_int(pw, new_id[id]);
+	    }
+	}
+	if (started) {
+	    if (binary)
+		pw_bint(pw, 0);
+	    else
+		pw_string(pw, " 0\n");
+	}
+	*posp = p - dstore;
+    }
+}
+
+int trim_finish(pwriter *pw, clause_id_t empty_id, bool binary, clause_id_t *count) {
+    clause_id_t id;
+    int i;
+    *count = 0;
+    if (empty_id <= input_clause_limit || empty_id >= alloc_id_count || clause_offset[empty_id] == NO_CLAUSE)
+	return 0;
+    /* 
+       Backward pass.  needed[id] is set if clause id is used as hint
+       by a needed clause.
+     */
+    unsigned char *needed = calloc(empty_id+1, sizeof(unsigned char));
+    clause_id_t *new_id = calloc(empty_id+1, sizeof(clause_id_t));
+    if (needed == NULL || new_id == NULL) {
+	free(needed);
+	free(new_id);
+	return BDD_MEMORY;
+    }
+    needed[empty_id] = 1;
+    for (id = empty_id; id > input_clause_limit; id--) {
+	if (!needed[id] || clause_offset[id] == NO_CLAUSE)
+	    continue;
+	unsigned char *p = store + clause_offset[id];
+	int len = pw_int_unpack(&p);
+	for (i = 0; i < len; i++)
+	    pw_int_unpack(&p);
+	int hlen = pw_int_unpack(&p);
+	for (i = 0; i < hlen; i++) {
+	    clause_id_t hint = pw_int_unpack(&p);
+	    needed[ABS(hint)] = 1;
+	}
+    }
+
+    /* Input clauses keep their IDs */
+    for (id = 1; id <= input_clause_limit; id++)
+	new_id[id] = id;
+    clause_id_t next_id = input_clause_limit;
+    size_t dpos = 0;
+    trim_write_deletions(pw, &dpos, input_clause_limit, new_id, empty_id, next_id, binary);
+
+    /* Forward pass */
+    for (id = input_clause_limit+1; id <= empty_id; id++) {
+	if (!needed[id] || clause_offset[id] == NO_CLAUSE) {
+	    trim_write_deletions(pw, &dpos, id, new_id, empty_id, next_id, binary);
+	    continue;
+	}
+	new_id[id] = ++next_id;
+	unsigned char *p = store + clause_offset[id];
+	int len = pw_int_unpack(&p);
+	if (binary) {
+	    pw_char(pw, 'a');
+	    pw_bint(pw, next_id);
+	    for (i = 0; i < len; i++)
+		pw_bint(pw, pw_int_unpack(&p));
+	    pw_bint(pw, 0);
+	} else {
+	    pw_int(pw, next_id);
+	    for (i = 0; i < len; i++) {
+		pw_char(pw, ' ');
+		pw_int(pw, pw_int_unpack(&p));
+	    }
+	    pw_string(pw, " 0");
+	}
+	int hlen = pw_int_unpack(&p);
+	for (i = 0; i < hlen; i++) {
+	    clause_id_t hint = pw_int_unpack(&p);
+	    clause_id_t hid = ABS(hint);
+	    clause_id_t nhint = hint < 0 ? -new_id[hid] : new_id[hid];
+	    if (binary)
+		pw_bint(pw, nhint);
+	    else {
+		pw_char(pw, ' ');
+		pw_int(pw, nhint);
+	    }
+	}
+	if (binary)
+	    pw_bint(pw, 0);
+	else
+	    pw_string(pw, " 0\n");
+	if (id < empty_id)
+	    trim_write_deletions(pw, &dpos, id, new_id, empty_id, next_id, binary);
+    }
+    free(needed);
+    free(new_id);
+    *count = next_id - input_clause_limit;
+    return 0;
+}
+
+void trim_done() {
+    free(clause_offset);
+    free(store);
+    free(dstore);
+    clause_offset = NULL;
+    store = NULL;
+    dstore = NULL;
+    alloc_id_count = 0;
+    store_count = store_alloc = 0;
+    dstore_count = dstore_alloc = 0;
+}
+
+/* EOF */
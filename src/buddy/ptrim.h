@@ -0,0 +1,84 @@
+/*========================================================================
+  Copyright (c) 2022 Randal E. Bryant, Carnegie Mellon University
+  
+  This code was not included in the original BuDDy distribution and is
+  therefore not subject to any of its licensing terms.
+
+  Permission is hereby granted, free of
+  charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+========================================================================*/
+
+
+/* Proof trimming: Keep only those clauses needed to derive the empty clause */
+
+#ifndef PTRIM_H
+#define PTRIM_H
+
+#include <stdbool.h>
+#include "ilist.h"
+#include "pwriter.h"
+
+/* Allow this headerfile to define C++ constructs if requested */
+#ifdef __cplusplus
+#define CPLUSPLUS
+#endif
+
+#ifdef CPLUSPLUS
+extern "C" {
+#endif
+
+/*
+  Rather than being written directly, each added clause and its hints
+  are recorded in memory in compressed form, as is each list of deleted
+  clauses.  Once the proof is complete, a backward pass from the empty
+  clause finds the clauses that contribute to the refutation, and a
+  forward pass writes these as an LRAT proof with consecutive clause
+  IDs.  Deletions are written where they were in the untrimmed proof,
+  leaving out clauses that were not written, so that the trimmed proof
+  is never larger.
+ */
+
+/* Set up for proof having specified number of input clauses */
+extern int trim_init(int input_count);
+
+/* Record added clause.  Clause IDs must be increasing */
+extern void trim_add(clause_id_t clause_id, ilist clause, ilist hints);
+
+/* Record deleted clauses, following the last added clause */
+extern void trim_delete(ilist clause_ids);
+
+/* 
+   Write trimmed proof ending with specified empty clause.
+   Set *count to number of added clauses written.
+   Return 0, or error code if out of memory
+*/
+extern int trim_finish(pwriter *pw, clause_id_t empty_id, bool binary, clause_id_t *count);
+
+/* Free all storage */
+extern void trim_done();
+
+#ifdef CPLUSPLUS
+}
+#endif
+
+#endif /* PTRIM_H */
+
+/* EOF */
@@ -0,0 +1,408 @@
+/*========================================================================
+  Copyright (c) 2022 Randal E. Bryant, Carnegie Mellon University
+  
+  This code was not included in the original BuDDy distribution and is
+  therefore not subject to any of its licensing terms.
+
+  Permission is hereby granted, free of
+  charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+========================================================================*/
+
+
+/* Buffered writer for proof output */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "kernel.h"
+#include "pwriter.h"
+
+/*
+  Ring of buffers shared with background thread.
+  Slot i holds count[i] bytes once head has advanced past i.
+  Producer only advances head, consumer only advances tail, each
+  holding the mutex.  Both block on condition variables rather than
+  polling.  Buffers are swapped into slots and written outside it.
+*/
+struct pw_async {
+    pthread_t thread;
+    int fd;
+    int nslots;
+    unsigned char **slot;
+    size_t *count;
+    pthread_mutex_t lock;     /* Guards head, tail, done, and error */
+    pthread_cond_t nonempty;  /* Signaled when head advances or done set */
+    pthread_cond_t nonfull;   /* Signaled when tail advances */
+    long long head;  /* Number of buffers handed to thread */
+    long long tail;  /* Number of buffers written by thread */
+    bool done;       /* Set when no more buffers will be added */
+    bool error;      /* Set if write failed in thread */
+};
+
+/* Pass bytes to operating system, retrying on partial writes.  Return false if fails */
+static bool pw_write_all(int fd, unsigned char *data, size_t len) {
+    while (len > 0) {
+	ssize_t rval = write(fd, data, len);
+	if (rval < 0) {
+	    if (errno == EINTR)
+		continue;
+	    return false;
+	}
+	data += rval;
+	len -= rval;
+    }
+    return true;
+}
+
+static double pw_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/* Background thread.  Wait for each buffer under the mutex, then write it without holding the mutex */
+static void *pw_thread(void *arg) {
+    struct pw_async *as = (struct pw_async *) arg;
+    pthread_mutex_lock(&as->lock);
+    while (true) {
+	while (as->tail == as->head && !as->done)
+	    pthread_cond_wait(&as->nonempty, &as->lock);
+	if (as->tail == as->head)
+	    /* Done, and all buffers written */
+	    break;
+	int idx = as->tail % as->nslots;
+	/* Producer won't touch this slot until tail advances */
+	pthread_mutex_unlock(&as->lock);
+	bool ok = pw_write_all(as->fd, as->slot[idx], as->count[idx]);
+	pthread_mutex_lock(&as->lock);
+	if (!ok)
+	    as->error = true;
+	as->tail++;
+	pthread_cond_signal(&as->nonfull);
+    }
+    pthread_mutex_unlock(&as->lock);
+    return NULL;
+}
+
+/* Free ring.  Works on partially allocated structure */
+static void pw_async_free(struct pw_async *as) {
+    int i;
+    if (as->slot) {
+	for (i = 0; i < as->nslots; i++)
+	    free(as->slot[i]);
+    }
+    free(as->slot);
+    free(as->count);
+    free(as);
+}
+
+int pw_init(pwriter *pw, FILE *file, size_t bufsize) {
+    /* Anything already written via stdio must precede our output */
+    if (file != NULL)
+	fflush(file);
+    pw->fd = file == NULL ? -1 : fileno(file);
+    pw->bufsize = bufsize;
+    pw->count = 0;
+    pw->total = 0;
+    pw->async = NULL;
+    pw->stall_count = 0;
+    pw->stall_seconds = 0.0;
+    pw->buf = malloc(bufsize);
+    if (pw->buf == NULL)
+	return bdd_error(BDD_MEMORY);
+    return 0;
+}
+
+int pw_start_async(pwriter *pw, int slots) {
+    int i;
+    if (pw->fd < 0)
+	/* Nothing to write */
+	return 0;
+    struct pw_async *as = calloc(1, sizeof(struct pw_async));
+    if (as == NULL)
+	return bdd_error(BDD_MEMORY);
+    as->fd = pw->fd;
+    as->nslots = slots;
+    as->slot = calloc(slots, sizeof(unsigned char *));
+    as->count = calloc(slots, sizeof(size_t));
+    if (as->slot == NULL || as->count == NULL) {
+	pw_async_free(as);
+	return bdd_error(BDD_MEMORY);
+    }
+    for (i = 0; i < slots; i++) {
+	as->slot[i] = malloc(pw->bufsize);
+	if (as->slot[i] == NULL) {
+	    pw_async_free(as);
+	    return bdd_error(BDD_MEMORY);
+	}
+    }
+    as->head = 0;
+    as->tail = 0;
+    as->done = false;
+    as->error = false;
+    if (pthread_mutex_init(&as->lock, NULL) != 0) {
+	fprintf(ERROUT, "c WARNING: Couldn't initialize proof output lock.  Writing synchronously\n");
+	pw_async_free(as);
+	return 0;
+    }
+    pthread_cond_init(&as->nonempty, NULL);
+    pthread_cond_init(&as->nonfull, NULL);
+    /* Anything buffered so far must be written first */
+    pw_flush(pw);
+    if (pthread_create(&as->thread, NULL, pw_thread, as) != 0) {
+	fprintf(ERROUT, "c WARNING: Couldn't create proof output thread.  Writing synchronously\n");
+	pthread_cond_destroy(&as->nonfull);
+	pthread_cond_destroy(&as->nonempty);
+	pthread_mutex_destroy(&as->lock);
+	pw_async_free(as);
+	return 0;
+    }
+    pw->async = as;
+    return 0;
+}
+
+void pw_done(pwriter *pw) {
+    if (pw->buf == NULL)
+	return;
+    pw_flush(pw);
+    if (pw->async) {
+	struct pw_async *as = pw->async;
+	pthread_mutex_lock(&as->lock);
+	as->done = true;
+	pthread_cond_signal(&as->nonempty);
+	pthread_mutex_unlock(&as->lock);
+	pthread_join(as->thread, NULL);
+	bool error = as->error;
+	pthread_cond_destroy(&as->nonfull);
+	pthread_cond_destroy(&as->nonempty);
+	pthread_mutex_destroy(&as->lock);
+	pw_async_free(as);
+	pw->async = NULL;
+	if (error)
+	    bdd_error(BDD_FILE);
+    }
+    free(pw->buf);
+    pw->buf = NULL;
+}
+
+/* Hand buffer to background thread, waiting if all slots are full */
+static void pw_enqueue(pwriter *pw) {
+    struct pw_async *as = pw->async;
+    pthread_mutex_lock(&as->lock);
+    long long h = as->head;
+    if (h - as->tail >= as->nslots) {
+	double start = pw_seconds();
+	pw->stall_count++;
+	while (h - as->tail >= as->nslots)
+	    pthread_cond_wait(&as->nonfull, &as->lock);
+	pw->stall_seconds += pw_seconds() - start;
+    }
+    bool error = as->error;
+    pthread_mutex_unlock(&as->lock);
+    if (error)
+	bdd_error(BDD_FILE);
+    /* Swap our buffer with the free one in the slot */
+    int idx = h % as->nslots;
+    unsigned char *full = pw->buf;
+    pw->buf = as->slot[idx];
+    as->slot[idx] = full;
+    as->count[idx] = pw->count;
+    pthread_mutex_lock(&as->lock);
+    as->head = h+1;
+    pthread_cond_signal(&as->nonempty);
+    pthread_mutex_unlock(&as->lock);
+}
+
+void pw_flush(pwriter *pw) {
+    if (pw->count == 0)
+	return;
+    if (pw->async)
+	pw_enqueue(pw);
+    else if (pw->fd >= 0 && !pw_write_all(pw->fd, pw->buf, pw->count))
+	bdd_error(BDD_FILE);
+    pw->total += pw->count;
+    pw->count = 0;
+}
+
+unsigned char *pw_reserve(pwriter *pw, size_t len) {
+    if (pw->count + len > pw->bufsize)
+	pw_flush(pw);
+    return pw->buf + pw->count;
+}
+
+void pw_advance(pwriter *pw, size_t len) {
+    pw->count += len;
+}
+
+void pw_char(pwriter *pw, char c) {
+    if (pw->count >= pw->bufsize)
+	pw_flush(pw);
+    pw->buf[pw->count++] = c;
+}
+
+void pw_bytes(pwriter *pw, const unsigned char *data, size_t len) {
+    while (len > 0) {
+	if (pw->count >= pw->bufsize)
+	    pw_flush(pw);
+	size_t n = pw->bufsize - pw->count;
+	if (n > len)
+	    n = len;
+	memcpy(pw->buf + pw->count, data, n);
+	pw->count += n;
+	data += n;
+	len -= n;
+    }
+}
+
+void pw_string(pwriter *pw, const char *s) {
+    pw_bytes(pw, (const unsigned char *) s, strlen(s));
+}
+
+/* Convert integer to decimal.  Return number of characters */
+static int pw_int_format(ival_t x, unsigned char *dest) {
+    unsigned char digits[PW_INT_MAX_CHARS];
+    unsigned char *d = dest;
+    uival_t u = x < 0 ? -(uival_t) x : (uival_t) x;
+    int n = 0;
+    do {
+	digits[n++] = '0' + u % 10;
+	u /= 10;
+    } while (u > 0);
+    if (x < 0)
+	*d++ = '-';
+    while (n > 0)
+	*d++ = digits[--n];
+    return d - dest;
+}
+
+void pw_int(pwriter *pw, ival_t x) {
+    unsigned char *d = pw_reserve(pw, PW_INT_MAX_CHARS);
+    pw->count += pw_int_format(x, d);
+}
+
+void pw_ilist(pwriter *pw, ilist ils, const char *sep) {
+    int i;
+    if (ils == TAUTOLOGY_CLAUSE) {
+	pw_string(pw, "TAUT");
+	return;
+    }
+    if (ils == NULL) {
+	pw_string(pw, "NULL");
+	return;
+    }
+    size_t slen = strlen(sep);
+    for (i = 0; i < ilist_length(ils); i++) {
+	unsigned char *d = pw_reserve(pw, slen + PW_INT_MAX_CHARS);
+	if (i > 0) {
+	    memcpy(d, sep, slen);
+	    d += slen;
+	    pw->count += slen;
+	}
+	pw->count += pw_int_format(ils[i], d);
+    }
+}
+
+void pw_vprintf(pwriter *pw, const char *fmt, va_list vlist) {
+    va_list vcopy;
+    va_copy(vcopy, vlist);
+    size_t avail = pw->bufsize - pw->count;
+    int len = vsnprintf((char *) pw->buf + pw->count, avail, fmt, vcopy);
+    va_end(vcopy);
+    if (len < 0) {
+	bdd_error(BDD_FILE);
+	return;
+    }
+    if ((size_t) len < avail) {
+	pw->count += len;
+	return;
+    }
+    /* Didn't fit.  Make room and format again */
+    pw_flush(pw);
+    if ((size_t) len < pw->bufsize) {
+	va_copy(vcopy, vlist);
+	vsnprintf((char *) pw->buf, pw->bufsize, fmt, vcopy);
+	va_end(vcopy);
+	pw->count = len;
+    } else {
+	char *s = malloc(len+1);
+	if (s == NULL) {
+	    bdd_error(BDD_MEMORY);
+	    return;
+	}
+	va_copy(vcopy, vlist);
+	vsnprintf(s, len+1, fmt, vcopy);
+	va_end(vcopy);
+	pw_bytes(pw, (unsigned char *) s, len);
+	free(s);
+    }
+}
+
+void pw_printf(pwriter *pw, const char *fmt, ...) {
+    va_list vlist;
+    va_start(vlist, fmt);
+    pw_vprintf(pw, fmt, vlist);
+    va_end(vlist);
+}
+
+/* Convert integer into byte sequence.  Return number of bytes */
+int pw_int_pack(ival_t x, unsigned char *dest) {
+    unsigned char *d = dest;
+    uival_t u = x < 0 ? 2*(-(uival_t) x)+1 : 2*(uival_t) x;
+    while (u >= 128) {
+	unsigned char b = u & 0x7F;
+	u >>= 7;
+	*d++ =  b+128;
+    }
+    *d++ = u;
+    return d - dest;
+}
+
+/* Inverse of pw_int_pack.  Advance *pp past the bytes */
+ival_t pw_int_unpack(unsigned char **pp) {
+    unsigned char *p = *pp;
+    uival_t u = 0;
+    int shift = 0;
+    while (*p >= 128) {
+	u |= (uival_t) (*p++ & 0x7F) << shift;
+	shift += 7;
+    }
+    u |= (uival_t) *p++ << shift;
+    *pp = p;
+    return (u & 0x1) ? -(ival_t) (u >> 1) : (ival_t) (u >> 1);
+}
+
+void pw_bint(pwriter *pw, ival_t x) {
+    unsigned char *d = pw_reserve(pw, PW_INT_MAX_BYTES);
+    pw->count += pw_int_pack(x, d);
+}
+
+void pw_bilist(pwriter *pw, ilist ils) {
+    int i;
+    for (i = 0; i < ilist_length(ils); i++) {
+	unsigned char *d = pw_reserve(pw, PW_INT_MAX_BYTES);
+	pw->count += pw_int_pack(ils[i], d);
+    }
+}
+
+/* EOF */
@@ -0,0 +1,152 @@
+/*========================================================================
+  Copyright (c) 2022 Randal E. Bryant, Carnegie Mellon University
+  
+  This code was not included in the original BuDDy distribution and is
+  therefore not subject to any of its licensing terms.
+
+  Permission is hereby granted, free of
+  charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+========================================================================*/
+
+
+/* Buffered writer for proof output */
+
+#ifndef PWRITER_H
+#define PWRITER_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "ilist.h"
+
+/* Allow this headerfile to define C++ constructs if requested */
+#ifdef __cplusplus
+#define CPLUSPLUS
+#endif
+
+#ifdef CPLUSPLUS
+extern "C" {
+#endif
+
+/*
+  Proof output is accumulated in a large user-space buffer and passed
+  to the operating system with a single write() each time the buffer
+  fills.  All output to the proof file must go through the writer,
+  since anything written via stdio would appear out of order.
+
+  Optionally, the writes can be performed by a background thread.
+  Full buffers are then handed to the thread through a ring of buffers,
+  taking a mutex once per buffer (not per clause), and the caller only
+  blocks, on a condition variable, when all slots in the ring are
+  waiting to be written.
+ */
+
+/* Default buffer size (bytes) */
+#define PW_BUFSIZE (1 << 22)
+
+/*
+  Integers are written as ival_t, the type of ilist elements, so that
+  64-bit clause IDs can be written when compiled with -DCLAUSE_ID64.
+  uival_t is the corresponding unsigned type
+ */
+#ifdef CLAUSE_ID64
+typedef unsigned long long uival_t;
+/* Longest possible ASCII representation of an ival_t, including sign */
+#define PW_INT_MAX_CHARS 20
+/* Longest possible byte encoding of an ival_t in binary proof formats */
+#define PW_INT_MAX_BYTES 10
+#else
+typedef unsigned uival_t;
+/* Longest possible ASCII representation of an int, including sign */
+#define PW_INT_MAX_CHARS 11
+/* Longest possible byte encoding of an int in binary proof formats */
+#define PW_INT_MAX_BYTES 5
+#endif
+
+/* Buffer size for occasional output to other files */
+#define PW_SMALL_BUFSIZE (1 << 12)
+
+/* Number of buffers in ring for asynchronous output */
+#define PW_RING_SLOTS 8
+
+/* State shared with background thread.  Defined in pwriter.c */
+struct pw_async;
+
+typedef struct {
+    int fd;             /* Destination file descriptor */
+    unsigned char *buf; /* Buffer */
+    size_t bufsize;     /* Allocated size of buffer */
+    size_t count;       /* Number of bytes currently in buffer */
+    long long total;    /* Total number of bytes written */
+    struct pw_async *async; /* Background thread state.  NULL when synchronous */
+    long long stall_count;  /* Number of times caller waited for free slot */
+    double stall_seconds;   /* Total time spent waiting */
+} pwriter;
+
+/* Set up writer for open file.  Return 0 if OK, otherwise error code
+   When file is NULL, output is discarded */
+extern int pw_init(pwriter *pw, FILE *file, size_t bufsize);
+
+/* 
+   Switch to writing via background thread with specified number of ring slots.
+   Return 0 if OK, otherwise error code
+*/
+extern int pw_start_async(pwriter *pw, int slots);
+
+/* Flush remaining output and free buffer.  Waits for background thread */
+extern void pw_done(pwriter *pw);
+
+/* Write buffer contents to file (or pass to background thread) */
+extern void pw_flush(pwriter *pw);
+
+/* 
+   Get pointer to space for at least len bytes.  Caller fills in
+   the bytes and then calls pw_advance with the number actually used.
+   len must not exceed buffer size
+*/
+extern unsigned char *pw_reserve(pwriter *pw, size_t len);
+extern void pw_advance(pwriter *pw, size_t len);
+
+/* Arbitrary sequence of bytes */
+extern void pw_bytes(pwriter *pw, const unsigned char *data, size_t len);
+
+/* Text output */
+extern void pw_char(pwriter *pw, char c);
+extern void pw_string(pwriter *pw, const char *s);
+extern void pw_int(pwriter *pw, ival_t x);
+/* Print elements of ilist separated by sep.  Matches ilist_print */
+extern void pw_ilist(pwriter *pw, ilist ils, const char *sep);
+/* Formatted output for comments and other infrequent text */
+extern void pw_printf(pwriter *pw, const char *fmt, ...);
+extern void pw_vprintf(pwriter *pw, const char *fmt, va_list vlist);
+
+/* Binary output.  Variable-byte encoding used by the binary proof formats */
+extern int pw_int_pack(ival_t x, unsigned char *dest);
+extern ival_t pw_int_unpack(unsigned char **pp);
+extern void pw_bint(pwriter *pw, ival_t x);
+extern void pw_bilist(pwriter *pw, ilist ils);
+
+#ifdef CPLUSPLUS
+}
+#endif
+
+#endif /* PWRITER_H */
+
+/* EOF */
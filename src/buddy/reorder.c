@@ -62,21 +62,6 @@
 
 #define __USERESIZE /* FIXME */
 
-   /* Current auto reord. method and number of automatic reorderings left */
-static int bddreordermethod;
-static int bddreordertimes;
-
-   /* Flag for disabling reordering temporarily */
-static int reorderdisabled;
-
-   /* Store for the variable relationships */
-static BddTree *vartree;
-static int blockid;
-
-   /* Store for the ref.cou. of the external roots */
-static int *extroots;
-static int extrootsize;
-
 /* Level data */
 typedef struct _levelData
 {
@@ -86,28 +71,24 @@ typedef struct _levelData
    int nodenum;  /* Number of nodes in this level */
 } levelData;
 
-static levelData *levels; /* Indexed by variable! */
-
-   /* Interaction matrix */
-static imatrix *iactmtx;
-
-   /* Reordering information for the user */
-static int verbose;
-static bddinthandler reorder_handler;
-static bddfilehandler reorder_filehandler;
-static bddsizehandler reorder_nodenum;
-
-   /* Number of live nodes before and after a reordering session */
-static int usednum_before;
-static int usednum_after;
-	    
-   /* Kernel variables needed for reordering */
-extern int bddfreepos;
-extern int bddfreenum;
-extern int bddproduced;
-
-   /* Flag telling us when a node table resize is done */
-static int resizedInMakenode;
+   /* Reordering state of the current manager, see manager.h */
+#define bddreordermethod    (bddmanager->reorder.bddreordermethod)
+#define bddreordertimes     (bddmanager->reorder.bddreordertimes)
+#define reorderdisabled     (bddmanager->reorder.reorderdisabled)
+#define vartree             (bddmanager->reorder.vartree)
+#define blockid             (bddmanager->reorder.blockid)
+#define extroots            (bddmanager->reorder.extroots)
+#define extrootsize         (bddmanager->reorder.extrootsize)
+#define levels              (bddmanager->reorder.levels)
+#define iactmtx             (bddmanager->reorder.iactmtx)
+#define verbose             (bddmanager->reorder.verbose)
+#define reorder_handler     (bddmanager->reorder.reorder_handler)
+#define reorder_filehandler (bddmanager->reorder.reorder_filehandler)
+#define reorder_nodenum     (bddmanager->reorder.reorder_nodenum)
+#define reorderclock        (bddmanager->reorder.reorderclock)
+#define usednum_before      (bddmanager->reorder.usednum_before)
+#define usednum_after       (bddmanager->reorder.usednum_after)
+#define resizedInMakenode   (bddmanager->reorder.resizedInMakenode)
 
    /* New node hashing function for use with reordering */
 #define NODEHASH(var,l,h) ((PAIR((l),(h))%levels[var].size)+levels[var].start)
@@ -812,7 +793,7 @@ static void addref_rec(int r, char *dep)
    if (r < 2)
       return;
    
-   if (bddnodes[r].refcou == 0)
+   if (REFCOU(r) == 0)
    {
       bddfreenum--;
 
@@ -872,7 +853,7 @@ static int mark_roots(void)
 	  * - Do NOT use the LEVEL macro here. */
       bddnodes[n].level = bddlevel2var[bddnodes[n].level];
       
-      if (bddnodes[n].refcou > 0)
+      if (REFCOU(n) > 0)
       {
 	 SETMARK(n);
 	 extrootsize++;
@@ -905,11 +886,11 @@ static int mark_roots(void)
 
       /* Make sure the hash field is empty. This saves a loop in the
 	 initial GBC */
-      node->hash = 0;
+      HASHHEADp(node) = 0;
    }
 
-   bddnodes[0].hash = 0;
-   bddnodes[1].hash = 0;
+   HASHHEAD(0) = 0;
+   HASHHEAD(1) = 0;
 
    free(dep);
    return 0;
@@ -933,19 +914,19 @@ static void reorder_gbc(void)
    {
       register BddNode *node = &bddnodes[n];
 
-      if (node->refcou > 0)
+      if (REFCOUp(node) > 0)
       {
 	 register unsigned int hash;
 	 
 	 hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
-	 node->next = bddnodes[hash].hash;
-	 bddnodes[hash].hash = n;
+	 NEXTNODEp(node) = HASHHEAD(hash);
+	 HASHHEAD(hash) = n;
 
       }
       else
       {
 	 LOWp(node) = -1;
-	 node->next = bddfreepos;
+	 NEXTNODEp(node) = bddfreepos;
 	 bddfreepos = n;
 	 bddfreenum++;
       }
@@ -988,23 +969,23 @@ static void reorder_rehashAll(void)
    bddfreepos = 0;
 
    for (n=bddnodesize-1 ; n>=0 ; n--)
-      bddnodes[n].hash = 0;
+      HASHHEAD(n) = 0;
    
    for (n=bddnodesize-1 ; n>=2 ; n--)
    {
       register BddNode *node = &bddnodes[n];
 
-      if (node->refcou > 0)
+      if (REFCOUp(node) > 0)
       {
 	 register unsigned int hash;
 	 
 	 hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
-	 node->next = bddnodes[hash].hash;
-	 bddnodes[hash].hash = n;
+	 NEXTNODEp(node) = HASHHEAD(hash);
+	 HASHHEAD(hash) = n;
       }
       else
       {
-	 node->next = bddfreepos;
+	 NEXTNODEp(node) = bddfreepos;
 	 bddfreepos = n;
       }
    }
@@ -1038,7 +1019,7 @@ static int reorder_makenode(int var, int low, int high)
 
       /* Try to find an existing node of this kind */
    hash = NODEHASH(var, low, high);
-   res = bddnodes[hash].hash;
+   res = HASHHEAD(hash);
       
    while(res != 0)
    {
@@ -1050,7 +1031,7 @@ static int reorder_makenode(int var, int low, int high)
 	 INCREF(res);
 	 return res;
       }
-      res = bddnodes[res].next;
+      res = NEXTNODE(res);
       
 #ifdef CACHESTATS
       bddcachestats.uniqueChain++;
@@ -1086,7 +1067,7 @@ static int reorder_makenode(int var, int low, int high)
 
       /* Build new node */
    res = bddfreepos;
-   bddfreepos = bddnodes[bddfreepos].next;
+   bddfreepos = NEXTNODE(bddfreepos);
    levels[var].nodenum++;
    bddproduced++;
    bddfreenum--;
@@ -1097,11 +1078,11 @@ static int reorder_makenode(int var, int low, int high)
    HIGHp(node) = high;
 
       /* Insert node in hash chain */
-   node->next = bddnodes[hash].hash;
-   bddnodes[hash].hash = res;
+   NEXTNODEp(node) = HASHHEAD(hash);
+   HASHHEAD(hash) = res;
 
       /* Make sure it is reference counted */
-   node->refcou = 1;
+   REFCOUp(node) = 1;
    INCREF(LOWp(node));
    INCREF(HIGHp(node));
    
@@ -1128,25 +1109,25 @@ static int reorder_downSimple(int var0)
    {
       int r;
 
-      r = bddnodes[n + vl0].hash;
-      bddnodes[n + vl0].hash = 0;
+      r = HASHHEAD(n + vl0);
+      HASHHEAD(n + vl0) = 0;
 
       while (r != 0)
       {
 	 BddNode *node = &bddnodes[r];
-	 int next = node->next;
+	 int next = NEXTNODEp(node);
 
 	 if (VAR(LOWp(node)) != var1  &&  VAR(HIGHp(node)) != var1)
 	 {
  	       /* Node does not depend on next var, let it stay in the chain */
-	    node->next = bddnodes[n+vl0].hash;
-	    bddnodes[n+vl0].hash = r;
+	    NEXTNODEp(node) = HASHHEAD(n+vl0);
+	    HASHHEAD(n+vl0) = r;
 	    levels[var0].nodenum++;
 	 }
 	 else
 	 {
    	       /* Node depends on next var - save it for later procesing */
-	    node->next = toBeProcessed;
+	    NEXTNODEp(node) = toBeProcessed;
 	    toBeProcessed = r;
 #ifdef SWAPCOUNT
 	    bddcachestats.swapCount++;
@@ -1174,7 +1155,7 @@ static void reorder_swap(int toBeProcessed, int var0)
    while (toBeProcessed)
    {
       BddNode *node = &bddnodes[toBeProcessed];
-      int next = node->next;
+      int next = NEXTNODEp(node);
       int f0 = LOWp(node);
       int f1 = HIGHp(node);
       int f00, f01, f10, f11, hash;
@@ -1219,8 +1200,8 @@ static void reorder_swap(int toBeProcessed, int var0)
       
          /* Rehash the node since it got new childs */
       hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
-      node->next = bddnodes[hash].hash;
-      bddnodes[hash].hash = toBeProcessed;
+      NEXTNODEp(node) = HASHHEAD(hash);
+      HASHHEAD(hash) = toBeProcessed;
 
       toBeProcessed = next;
    }
@@ -1241,18 +1222,18 @@ static void reorder_localGbc(int var0)
    for (n=0 ; n<size1 ; n++)
    {
       int hash = n+vl1;
-      int r = bddnodes[hash].hash;
-      bddnodes[hash].hash = 0;
+      int r = HASHHEAD(hash);
+      HASHHEAD(hash) = 0;
 
       while (r)
       {
 	 BddNode *node = &bddnodes[r];
-	 int next = node->next;
+	 int next = NEXTNODEp(node);
 
-	 if (node->refcou > 0)
+	 if (REFCOUp(node) > 0)
 	 {
-	    node->next = bddnodes[hash].hash;
-	    bddnodes[hash].hash = r;
+	    NEXTNODEp(node) = HASHHEAD(hash);
+	    HASHHEAD(hash) = r;
 	 }
 	 else
 	 {
@@ -1260,7 +1241,7 @@ static void reorder_localGbc(int var0)
 	    DECREF(HIGHp(node));
 	    
 	    LOWp(node) = -1;
-	    node->next = bddfreepos; 
+	    NEXTNODEp(node) = bddfreepos; 
 	    bddfreepos = r;
 	    levels[var1].nodenum--;
 	    bddfreenum++;
@@ -1283,7 +1264,7 @@ static void reorder_swapResize(int toBeProcessed, int var0)
    while (toBeProcessed)
    {
       BddNode *node = &bddnodes[toBeProcessed];
-      int next = node->next;
+      int next = NEXTNODEp(node);
       int f0 = LOWp(node);
       int f1 = HIGHp(node);
       int f00, f01, f10, f11;
@@ -1343,17 +1324,17 @@ static void reorder_localGbcResize(int toBeProcessed, int var0)
    for (n=0 ; n<size1 ; n++)
    {
       int hash = n+vl1;
-      int r = bddnodes[hash].hash;
-      bddnodes[hash].hash = 0;
+      int r = HASHHEAD(hash);
+      HASHHEAD(hash) = 0;
 
       while (r)
       {
 	 BddNode *node = &bddnodes[r];
-	 int next = node->next;
+	 int next = NEXTNODEp(node);
 
-	 if (node->refcou > 0)
+	 if (REFCOUp(node) > 0)
 	 {
-	    node->next = toBeProcessed;
+	    NEXTNODEp(node) = toBeProcessed;
 	    toBeProcessed = r;
 	 }
 	 else
@@ -1362,7 +1343,7 @@ static void reorder_localGbcResize(int toBeProcessed, int var0)
 	    DECREF(HIGHp(node));
 	    
 	    LOWp(node) = -1;
-	    node->next = bddfreepos; 
+	    NEXTNODEp(node) = bddfreepos; 
 	    bddfreepos = r;
 	    levels[var1].nodenum--;
 	    bddfreenum++;
@@ -1385,11 +1366,11 @@ static void reorder_localGbcResize(int toBeProcessed, int var0)
    while (toBeProcessed)
    {
       BddNode *node = &bddnodes[toBeProcessed];
-      int next = node->next;
+      int next = NEXTNODEp(node);
       int hash = NODEHASH(VARp(node), LOWp(node), HIGHp(node));
 	 
-      node->next = bddnodes[hash].hash;
-      bddnodes[hash].hash = toBeProcessed;
+      NEXTNODEp(node) = HASHHEAD(hash);
+      HASHHEAD(hash) = toBeProcessed;
 
       toBeProcessed = next;
    }   
@@ -1420,12 +1401,12 @@ static void sanitycheck(void)
       
       for (n=0 ; n<levels[v].size ; n++)
       {
-	 r = bddnodes[n+levels[v].start].hash;
+	 r = HASHHEAD(n+levels[v].start);
 	 
 	 while (r)
 	 {
 	    assert(VAR(r) == v);
-	    r = bddnodes[r].next;
+	    r = NEXTNODE(r);
 	    cou++;
 	    vcou++;
 	 }
@@ -1436,7 +1417,7 @@ static void sanitycheck(void)
 
    for (n=2 ; n<bddnodesize ; n++)
    {
-      if (bddnodes[n].refcou > 0)
+      if (REFCOU(n) > 0)
       {
 	 assert(LEVEL(n) < LEVEL(LOW(n)));
 	 assert(LEVEL(n) < LEVEL(HIGH(n)));
@@ -1566,20 +1547,18 @@ int bdd_swapvar(int v1, int v2)
 
 void bdd_default_reohandler(int prestate)
 {
-   static long c1;
-
    if (verbose > 0)
    {
       if (prestate)
       {
 	 printf("Start reordering\n");
-	 c1 = clock();
+	 reorderclock = clock();
       }
       else
       {
 	 long c2 = clock();
 	 printf("End reordering. Went from %d to %d nodes (%.1f sec)\n",
-		usednum_before, usednum_after, (float)(c2-c1)/CLOCKS_PER_SEC);
+		usednum_before, usednum_after, (float)(c2-reorderclock)/CLOCKS_PER_SEC);
       }
    }
 }
@@ -1683,7 +1662,7 @@ static void reorder_done(void)
       if (MARKED(n))
 	 UNMARK(n);
       else
-	 bddnodes[n].refcou = 0;
+	 REFCOU(n) = 0;
 
          /* This is where we go from .var to .level again!
 	  * - Do NOT use the LEVEL macro here. */
@@ -1704,7 +1683,8 @@ static void reorder_done(void)
    free(extroots);
    free(levels);
    imatrixDelete(iactmtx);
-   bdd_gbc();
+      /* Nodes have been rewritten, so all generations must be collected */
+   bdd_gbc_full();
 }
 
 
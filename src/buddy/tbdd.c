@@ -38,25 +38,27 @@
   Local data
 ============================================*/
 
-#define BUFLEN 2048
+/* Fields of the current manager, see manager.h */
+
+#define BUFLEN TBDD_BUFLEN
 // For formatting information
-static char ibuf[BUFLEN];
+#define ibuf (bddmanager->tbdd.ibuf)
 
-#define FUN_MAX 10
-static tbdd_info_fun ifuns[FUN_MAX];
-static int ifun_count = 0;
+#define FUN_MAX TBDD_FUN_MAX
+#define ifuns      (bddmanager->tbdd.ifuns)
+#define ifun_count (bddmanager->tbdd.ifun_count)
 
-static tbdd_done_fun dfuns[FUN_MAX];
-static int dfun_count = 0;
+#define dfuns      (bddmanager->tbdd.dfuns)
+#define dfun_count (bddmanager->tbdd.dfun_count)
 
-static int last_variable = 0;
-static int last_clause_id = 0;
+#define last_variable  (bddmanager->tbdd.last_variable)
+#define last_clause_id (bddmanager->tbdd.last_clause_id)
 
 
 /* Unit clauses that have not been deleted */
-static ilist created_unit_clauses;
+#define created_unit_clauses (bddmanager->tbdd.created_unit_clauses)
 /* Unit clauses that (should) have been deleted */
-static ilist dead_unit_clauses;
+#define dead_unit_clauses    (bddmanager->tbdd.dead_unit_clauses)
 
 /* Managing reference counts for TBDDs */
 
@@ -72,19 +74,19 @@ static ilist dead_unit_clauses;
 #define TABLE_SCALE 2
 
 /* Table of references */
-static int *rc_table = NULL;
+#define rc_table           (bddmanager->tbdd.rc_table)
 /* Number of allocated table entries */
-static int rc_allocated_count = 0;
+#define rc_allocated_count (bddmanager->tbdd.rc_allocated_count)
 /*
   Head of free list.  Free list threads through unused table
   positions, terminating with value -1
 */
-static int rc_freepos;
+#define rc_freepos         (bddmanager->tbdd.rc_freepos)
 
 /*============================================
   Local functions
 ============================================*/
-static int new_unit_clause(int id) {
+static clause_id_t new_unit_clause(clause_id_t id) {
     if (id != TAUTOLOGY)
 	created_unit_clauses = ilist_push(created_unit_clauses, id);
     return id;
@@ -128,7 +130,7 @@ static void rc_grow() {
     rc_allocated_count = nsize;
 }
 
-static int rc_new_entry(int clause_id) {
+static int rc_new_entry(clause_id_t clause_id) {
     if (clause_id == TAUTOLOGY)
 	return -1;
     if (rc_freepos == -1)
@@ -207,11 +209,11 @@ static int rc_decrement(int rci) {
   Returns 0 if OK, otherwise error code
 */
 
-int tbdd_init(FILE *pfile, int *variable_counter, int *clause_id_counter, ilist *input_clauses, ilist variable_ordering, proof_type_t ptype, bool binary) {
+int tbdd_init(FILE *pfile, int *var_counter, clause_id_t *cls_counter, ilist *input_clauses, ilist variable_ordering, proof_type_t ptype, bool binary) {
     created_unit_clauses = ilist_new(100);
     dead_unit_clauses = ilist_new(100);
     rc_init();
-    return prover_init(pfile, variable_counter, clause_id_counter, input_clauses, variable_ordering, ptype, binary);
+    return prover_init(pfile, var_counter, cls_counter, input_clauses, variable_ordering, ptype, binary);
 }
 
 int tbdd_init_lrat(FILE *pfile, int variable_count, int clause_count, ilist *input_clauses, ilist variable_ordering) {
@@ -238,12 +240,12 @@ int tbdd_init_drat_binary(FILE *pfile, int variable_count) {
     return tbdd_init(pfile, &last_variable, &last_clause_id, NULL, NULL, PROOF_DRAT, true);
 }
 
-int tbdd_init_frat(FILE *pfile, int *variable_counter, int *clause_id_counter) {
-    return tbdd_init(pfile, variable_counter, clause_id_counter, NULL, NULL, PROOF_FRAT, false);
+int tbdd_init_frat(FILE *pfile, int *var_counter, clause_id_t *cls_counter) {
+    return tbdd_init(pfile, var_counter, cls_counter, NULL, NULL, PROOF_FRAT, false);
 }
 
-int tbdd_init_frat_binary(FILE *pfile, int *variable_counter, int *clause_id_counter) {
-    return tbdd_init(pfile, variable_counter, clause_id_counter, NULL, NULL, PROOF_FRAT, false);
+int tbdd_init_frat_binary(FILE *pfile, int *var_counter, clause_id_t *cls_counter) {
+    return tbdd_init(pfile, var_counter, cls_counter, NULL, NULL, PROOF_FRAT, false);
 }
 
 int tbdd_init_noproof(int variable_count) {
@@ -255,6 +257,31 @@ void tbdd_set_verbose(int level) {
     verbosity_level = level;
 }
 
+void tbdd_set_lazy_defining(bool enable) {
+    lazy_defining = enable;
+}
+
+void tbdd_set_trim_proof(bool enable) {
+    trim_proof = enable;
+}
+
+void tbdd_set_async_proof(bool enable) {
+    async_proof = enable;
+}
+
+void tbdd_set_parallel_justify(bool enable) {
+    parallel_justify = enable;
+}
+
+void tbdd_set_time_justify(bool enable) {
+    time_justify = enable;
+}
+
+void tbdd_set_proof_checker(tbdd_add_clause_fun af, tbdd_delete_clauses_fun df) {
+    checker_add_clause = af;
+    checker_delete_clauses = df;
+}
+
 void tbdd_done() {
     /* Find difference of the created/dead unit clauses */
     ilist_sort(created_unit_clauses);
@@ -263,22 +290,22 @@ void tbdd_done() {
     int id = 0;
     ilist live_unit_clauses = ilist_new(100);
     while (ic < ilist_length(created_unit_clauses) && id < ilist_length(dead_unit_clauses)) {
-	int cc = created_unit_clauses[ic];
-	int cd = dead_unit_clauses[id];
+	clause_id_t cc = created_unit_clauses[ic];
+	clause_id_t cd = dead_unit_clauses[id];
 	if (cc < cd) {
 	    live_unit_clauses = ilist_push(live_unit_clauses, cc);
 	    ic++;
 	} else if (cc == cd) {
 	    ic++; id++;
 	} else {
-	    fprintf(ERROUT, "ERROR: Unit clause %d dead but never created\n", cd);
+	    fprintf(ERROUT, "ERROR: Unit clause " CLAUSE_ID_FMT " dead but never created\n", cd);
 	    id++;
 	}
     }
     while (ic < ilist_length(created_unit_clauses))
 	live_unit_clauses = ilist_push(live_unit_clauses, created_unit_clauses[ic++]);
     while (id < ilist_length(dead_unit_clauses))
-	fprintf(ERROUT, "ERROR: Unit clause %d dead but never created\n", dead_unit_clauses[id++]);
+	fprintf(ERROUT, "ERROR: Unit clause " CLAUSE_ID_FMT " dead but never created\n", dead_unit_clauses[id++]);
 
     /* Delete outstanding unit clauses */
     if (ilist_length(live_unit_clauses) > 0) {
@@ -311,21 +338,41 @@ void tbdd_done() {
 	printf("\nc BDD statistics\n");
 	printf("c ----------------\n");
 	printf("c Total BDD nodes produced: %ld\n", s.produced);
+	if (s.gbcyoungnum > 0)
+	    printf("c Garbage collections: %d (%d of young nodes only)\n", s.gbcnum, s.gbcyoungnum);
+	printf("c Node table: %d nodes after %d resizes\n", s.nodenum, s.resizenum);
+	if (s.cacheresizenum > 0)
+	    printf("c Operator caches grown from hit rates: %d times\n", s.cacheresizenum);
+	if (s.memlimit > 0)
+	    printf("c Memory limit: %d MB\n", s.memlimit);
     }
     bdd_done();
     prover_done();
     if (verbosity_level >= 1) {
 	printf("c Input variables: %d\n", input_variable_count);
 	printf("c Input clauses: %d\n", input_clause_count);
-	printf("c Total clauses: %d\n", total_clause_count);
-	int unused = *clause_id_counter - total_clause_count;
+	printf("c Total clauses: " CLAUSE_ID_FMT "\n", total_clause_count);
+	clause_id_t unused = *clause_id_counter - total_clause_count;
 	double upct = 100.0 * (double) unused/total_clause_count;
-	printf("c Unused clause IDs: %d (%.1f%%)\n", unused, upct);
-	printf("c Maximum live clauses: %d\n", max_live_clause_count);
-	printf("c Deleted clauses: %d\n", deleted_clause_count);
-	printf("c Final live clauses: %d\n", total_clause_count-deleted_clause_count);
+	printf("c Unused clause IDs: " CLAUSE_ID_FMT " (%.1f%%)\n", unused, upct);
+	printf("c Maximum live clauses: " CLAUSE_ID_FMT "\n", max_live_clause_count);
+	printf("c Deleted clauses: " CLAUSE_ID_FMT "\n", deleted_clause_count);
+	printf("c Final live clauses: " CLAUSE_ID_FMT "\n", total_clause_count-deleted_clause_count);
 	if (variable_counter)
 	    printf("c Total variables: %d\n", *variable_counter);
+	if (lazy_defining && proof_type != PROOF_NONE)
+	    printf("c Nodes with defining clauses: %d\n", defined_node_count);
+	if (trim_proof)
+	    printf("c Clauses in trimmed proof: " CLAUSE_ID_FMT "\n", trimmed_clause_count);
+	if (async_proof && proof_type != PROOF_NONE)
+	    printf("c Proof output stalls: %lld (%.2f seconds)\n", proof_stall_count, proof_stall_seconds);
+	if (apply_step_count > 0)
+	    printf("c Apply proof steps: %lld (%lld split in two)\n", apply_step_count, apply_split_count);
+	if (timed_step_count > 0) {
+	    printf("c Timed conjunction proof steps: %lld (%.3f seconds)\n", timed_step_count, timed_step_seconds);
+	    if (timed_step_seconds > 0)
+		printf("c Conjunction proof step rate: %.0f steps/s\n", timed_step_count / timed_step_seconds);
+	}
     }
     for (i = 0; i < ifun_count; i++) {
 	ifuns[i](verbosity_level);
@@ -351,13 +398,13 @@ void tbdd_add_done_fun(tbdd_done_fun f) {
 
 void tbdd_print(TBDD t, FILE *out) {
     int nid = NNAME(t.root);
-    int cid = t.clause_id;
+    clause_id_t cid = t.clause_id;
     int rci = t.rc_index;
     int rc = rc_get(rci);
-    fprintf(out, "[N%d, Clause #%d, RCI=%d, RC=%d]", nid, cid, rci, rc);
+    fprintf(out, "[N%d, Clause #" CLAUSE_ID_FMT ", RCI=%d, RC=%d]", nid, cid, rci, rc);
 }
 
-TBDD tbdd_create(BDD r, int clause_id) {
+TBDD tbdd_create(BDD r, clause_id_t clause_id) {
     TBDD res;
     res.root = bdd_addref(r);
     res.clause_id = new_unit_clause(clause_id);
@@ -405,11 +452,11 @@ void tbdd_delref(TBDD tr) {
     bdd_delref(tr.root);
     int rc = rc_decrement(tr.rc_index);
     if (rc == 0) {
-	int dbuf[1+ILIST_OVHD];
+	ival_t dbuf[1+ILIST_OVHD];
 	ilist dlist = ilist_make(dbuf, 1);
 	ilist_fill1(dlist, tr.clause_id);
 	if (tr.root != bdd_false()) {
-	    print_proof_comment(2, "Deleting unit clause #%d for node N%d", tr.clause_id, NNAME(tr.root));
+	    print_proof_comment(2, "Deleting unit clause #" CLAUSE_ID_FMT " for node N%d", tr.clause_id, NNAME(tr.root));
 	    delete_clauses(dlist);
 	}
 	/* Empty clause will be marked as "dead" so that is not later deleted */
@@ -431,8 +478,8 @@ static TBDD tbdd_duplicate(TBDD tr) {
   for all assignments satisfying clause.
  */
 
-static TBDD tbdd_from_clause_with_id(ilist clause, int id) {
-    print_proof_comment(2, "Build BDD representation of clause #%d", id);
+static TBDD tbdd_from_clause_with_id(ilist clause, clause_id_t id) {
+    print_proof_comment(2, "Build BDD representation of clause #" CLAUSE_ID_FMT, id);
     clause = clean_clause(clause);
     BDD r = BDD_build_clause(clause);
     if (proof_type == PROOF_NONE) {
@@ -440,7 +487,7 @@ static TBDD tbdd_from_clause_with_id(ilist clause, int id) {
     }
     int len = ilist_length(clause);
     int nlits = 2*len+1;
-    int abuf[nlits+ILIST_OVHD];
+    ival_t abuf[nlits+ILIST_OVHD];
     ilist ant = ilist_make(abuf, nlits);
     /* Clause literals are in descending order */
     ilist_reverse(clause);
@@ -459,19 +506,19 @@ static TBDD tbdd_from_clause_with_id(ilist clause, int id) {
 	}
     } 
     ilist_push(ant, id);
-    int cbuf[1+ILIST_OVHD];
+    ival_t cbuf[1+ILIST_OVHD];
     ilist uclause = ilist_make(cbuf, 1);
-    ilist_fill1(uclause, XVAR(r));
-    print_proof_comment(2, "Validate BDD representation of Clause #%d.  Node = N%d.", id, NNAME(r));
-    int clause_id = generate_clause(uclause, ant);
+    ilist_fill1(uclause, bdd_xvar(r));
+    print_proof_comment(2, "Validate BDD representation of Clause #" CLAUSE_ID_FMT ".  Node = N%d.", id, NNAME(r));
+    clause_id_t clause_id = generate_clause(uclause, ant);
     return tbdd_create(r, clause_id);
 }
 
 // This seems like it should be easier to check, but it isn't.
 TBDD tbdd_from_clause(ilist clause) {
-    int dbuf[ILIST_OVHD+1];
+    ival_t dbuf[ILIST_OVHD+1];
     ilist dels = ilist_make(dbuf, 1);
-    int id = assert_clause(clause);
+    clause_id_t id = assert_clause(clause);
     TBDD tr = tbdd_from_clause_with_id(clause, id);
     delete_clauses(ilist_fill1(dels, id));
     return tr;
@@ -522,7 +569,7 @@ TBDD TBDD_from_xor(ilist vars, int phase) {
     int len = ilist_length(vars);
     int bits;
     int elen = 1 << len;
-    int lbuf[ILIST_OVHD+len];
+    ival_t lbuf[ILIST_OVHD+len];
     ilist lits = ilist_make(lbuf, len);
     ilist_resize(lits, len);
     TBDD result = TBDD_tautology();
@@ -561,9 +608,9 @@ TBDD tbdd_validate(BDD r, TBDD tr) {
     if (proof_type == PROOF_NONE) {
 	return tbdd_create(r, TAUTOLOGY);
     }
-    int cbuf[1+ILIST_OVHD];
+    ival_t cbuf[1+ILIST_OVHD];
     ilist clause = ilist_make(cbuf, 1);
-    int abuf[2+ILIST_OVHD];
+    ival_t abuf[2+ILIST_OVHD];
     ilist ant = ilist_make(abuf, 2);
     pcbdd p = bdd_imptst_justify(tr.root, r);
     if (p.root != bdd_true()) {
@@ -571,9 +618,9 @@ TBDD tbdd_validate(BDD r, TBDD tr) {
 	exit(1);
     }
     print_proof_comment(2, "Validation of unit clause for N%d by implication from N%d",NNAME(r), NNAME(tr.root));
-    ilist_fill1(clause, XVAR(r));
+    ilist_fill1(clause, bdd_xvar(r));
     ilist_fill2(ant, p.clause_id, tr.clause_id);
-    int clause_id = generate_clause(clause, ant);
+    clause_id_t clause_id = generate_clause(clause, ant);
     /* Now we can handle any deletions caused by GC */
     process_deferred_deletions();
     return tbdd_create(r, clause_id);
@@ -588,13 +635,13 @@ TBDD tbdd_trust(BDD r) {
     if (proof_type == PROOF_NONE) {
 	return tbdd_create(r, TAUTOLOGY);
     }
-    int cbuf[1+ILIST_OVHD];
+    ival_t cbuf[1+ILIST_OVHD];
     ilist clause = ilist_make(cbuf, 1);
-    int abuf[0+ILIST_OVHD];
+    ival_t abuf[0+ILIST_OVHD];
     ilist ant = ilist_make(abuf, 0);
     print_proof_comment(2, "Assertion of N%d",NNAME(r));
-    ilist_fill1(clause, XVAR(r));
-    int clause_id = generate_clause(clause, ant);
+    ilist_fill1(clause, bdd_xvar(r));
+    clause_id_t clause_id = generate_clause(clause, ant);
     return tbdd_create(r, clause_id);
 }
 
@@ -613,18 +660,18 @@ TBDD tbdd_and(TBDD tr1, TBDD tr2) {
 	return tbdd_duplicate(tr1);
     pcbdd p = bdd_and_justify(tr1.root, tr2.root);
     BDD r = p.root;
-    int cbuf[1+ILIST_OVHD];
+    ival_t cbuf[1+ILIST_OVHD];
     ilist clause = ilist_make(cbuf, 1);
-    int abuf[3+ILIST_OVHD];
+    ival_t abuf[3+ILIST_OVHD];
     ilist ant = ilist_make(abuf, 3);
     if (r == bdd_false())
 	print_proof_comment(2, "Validate empty clause for node N%d = N%d & N%d", NNAME(r), NNAME(tr1.root), NNAME(tr2.root));
     else
 	print_proof_comment(2, "Validate unit clause for node N%d = N%d & N%d", NNAME(r), NNAME(tr1.root), NNAME(tr2.root));
-    ilist_fill1(clause, XVAR(r));
+    ilist_fill1(clause, bdd_xvar(r));
     ilist_fill3(ant, tr1.clause_id, tr2.clause_id, p.clause_id);
     /* Insert proof of unit clause into t's justification */
-    int clause_id = generate_clause(clause, ant);
+    clause_id_t clause_id = generate_clause(clause, ant);
     /* Now we can handle any deletions caused by GC */
     process_deferred_deletions();
     return tbdd_create(r, clause_id);
@@ -646,15 +693,15 @@ TBDD tbdd_validate_with_and(BDD r, TBDD tr1, TBDD tr2) {
 	fprintf(ERROUT, "Failed to prove implication N%d & N%d --> N%d\n", NNAME(tr1.root), NNAME(tr2.root), NNAME(r));
 	exit(1);
     }
-    int cbuf[1+ILIST_OVHD];
+    ival_t cbuf[1+ILIST_OVHD];
     ilist clause = ilist_make(cbuf, 1);
-    int abuf[3+ILIST_OVHD];
+    ival_t abuf[3+ILIST_OVHD];
     ilist ant = ilist_make(abuf, 3);
     print_proof_comment(2, "Validate unit clause for node N%d, based on N%d & N%d", NNAME(r), NNAME(tr1.root), NNAME(tr2.root));
-    ilist_fill1(clause, XVAR(r));
+    ilist_fill1(clause, bdd_xvar(r));
     ilist_fill3(ant, tr1.clause_id, tr2.clause_id, p.clause_id);
     /* Insert proof of unit clause into rr's justification */
-    int clause_id = generate_clause(clause, ant);
+    clause_id_t clause_id = generate_clause(clause, ant);
     /* Now we can handle any deletions caused by GC */
     process_deferred_deletions();
     return tbdd_create(r, clause_id);
@@ -692,9 +739,9 @@ static bool test_validation_path(ilist clause, TBDD tr) {
     return ISZERO(r);
 }
 
-static int tbdd_validate_clause_path(ilist clause, TBDD tr) {
+static clause_id_t tbdd_validate_clause_path(ilist clause, TBDD tr) {
     int len = ilist_length(clause);
-    int abuf[1+len+ILIST_OVHD];
+    ival_t abuf[1+len+ILIST_OVHD];
     int i;
     BDD r = tr.root;
     ilist ant = ilist_make(abuf, 1+len);
@@ -702,7 +749,7 @@ static int tbdd_validate_clause_path(ilist clause, TBDD tr) {
     for (i = len-1; i >= 0; i--) {
 	int lit = clause[i];
 	int var = ABS(lit);
-	int id;
+	clause_id_t id;
 	if (LEVEL(r) > var)
 	    // Function does not depend on this variable
 	    continue;
@@ -724,11 +771,11 @@ static int tbdd_validate_clause_path(ilist clause, TBDD tr) {
 	ilist_format(clause, buf, " ", BUFLEN);
 	print_proof_comment(2, "Validation of clause [%s] from N%d", buf, NNAME(tr.root));
     }
-    int id =  generate_clause(clause, ant);
+    clause_id_t id =  generate_clause(clause, ant);
     return id;
 }
 
-int tbdd_validate_clause(ilist clause, TBDD tr) {
+clause_id_t tbdd_validate_clause(ilist clause, TBDD tr) {
     if (proof_type == PROOF_NONE)
 	return TAUTOLOGY;
     clause = clean_clause(clause);
@@ -744,7 +791,7 @@ int tbdd_validate_clause(ilist clause, TBDD tr) {
 	bdd_addref(cr);
 	TBDD tcr = tbdd_validate(cr, tr);
 	bdd_delref(cr);
-	int id = tbdd_validate_clause_path(clause, tcr);
+	clause_id_t id = tbdd_validate_clause_path(clause, tcr);
 	if (id < 0) {
 	    char buf[BUFLEN];
 	    ilist_format(clause, buf, " ", BUFLEN);
@@ -762,10 +809,10 @@ int tbdd_validate_clause(ilist clause, TBDD tr) {
   or when don't want to provide antecedent in FRAT proof
   Returns clause id.
  */
-int assert_clause(ilist clause) {
+clause_id_t assert_clause(ilist clause) {
     if (proof_type == PROOF_NONE)
 	return TAUTOLOGY;
-    int abuf[1+ILIST_OVHD];
+    ival_t abuf[1+ILIST_OVHD];
     ilist ant = ilist_make(abuf, 1);
     if (verbosity_level >= 2) {
 	char buf[BUFLEN];
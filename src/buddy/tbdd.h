@@ -49,8 +49,10 @@
 #include "ilist.h"
 #include "bdd.h"
 
-/* Value representing logical truth */
-#define TAUTOLOGY INT_MAX 
+/* Value representing logical truth, as a clause ID */
+#define TAUTOLOGY CLAUSE_ID_MAX
+/* Literal for logical truth.  Its negation is the literal for falsehood */
+#define TAUTOLOGY_LIT INT_MAX
 
 /* 
    A trusted BDD is one for which a proof has
@@ -65,7 +67,7 @@
  */
 typedef struct {
     BDD root;
-    int clause_id;  /* Id of justifying clause */
+    clause_id_t clause_id;  /* Id of justifying clause */
     int rc_index;   /* Index of reference counter */
 } TBDD;
 
@@ -100,7 +102,7 @@ extern "C" {
 /* Supported proof types */
    typedef enum { PROOF_LRAT, PROOF_DRAT, PROOF_FRAT, PROOF_NONE } proof_type_t;
 
-   extern int tbdd_init(FILE *pfile, int *variable_counter, int *clause_id_counter, ilist *input_clauses, ilist variable_ordering, proof_type_t ptype, bool binary);
+   extern int tbdd_init(FILE *pfile, int *variable_counter, clause_id_t *clause_id_counter, ilist *input_clauses, ilist variable_ordering, proof_type_t ptype, bool binary);
 
 /* 
    Initializers specific for the seven combinations of proof formats
@@ -109,8 +111,8 @@ extern int tbdd_init_lrat(FILE *pfile, int variable_count, int clause_count, ili
 extern int tbdd_init_lrat_binary(FILE *pfile, int variable_count, int clause_count, ilist *input_clauses, ilist variable_ordering);
 extern int tbdd_init_drat(FILE *pfile, int variable_count);
 extern int tbdd_init_drat_binary(FILE *pfile, int variable_count);
-extern int tbdd_init_frat(FILE *pfile, int *variable_counter, int *clause_id_counter);
-extern int tbdd_init_frat_binary(FILE *pfile, int *variable_counter, int *clause_id_counter);
+extern int tbdd_init_frat(FILE *pfile, int *variable_counter, clause_id_t *clause_id_counter);
+extern int tbdd_init_frat_binary(FILE *pfile, int *variable_counter, clause_id_t *clause_id_counter);
 extern int tbdd_init_noproof(int variable_count);
 
 /*
@@ -144,6 +146,58 @@ void tbdd_add_done_fun(tbdd_done_fun f);
 */
 extern void tbdd_set_verbose(int level);
 
+/*
+  Generate the defining clauses for a BDD node only when the node
+  is first used in the proof, rather than when it is created.
+  Must be set before calling tbdd_init.
+ */
+extern void tbdd_set_lazy_defining(bool enable);
+
+/*
+  Write only those clauses that contribute to the derivation of the
+  empty clause, renumbered to have consecutive IDs.  The proof is held
+  in memory until tbdd_done.  LRAT proofs only.
+  Must be set before calling tbdd_init.
+ */
+extern void tbdd_set_trim_proof(bool enable);
+
+/*
+  Write proof using a background thread, so that BDD operations
+  and proof output can proceed concurrently.
+  Must be set before calling tbdd_init.
+ */
+extern void tbdd_set_async_proof(bool enable);
+
+/*
+  Split the proof of each large conjunction among the threads set by
+  bdd_setapplythreads.  The proof differs from the one generated by a
+  single thread.  Off by default: no speedup has been measured yet.
+ */
+extern void tbdd_set_parallel_justify(bool enable);
+
+/*
+  Measure the rate of justifying conjunction steps, apart from building
+  the BDDs.  Each step is timed as it is justified, on the calling
+  thread, so the proof is the same as the one generated without timing.
+  The time and the number of steps are reported by tbdd_done.  Steps
+  justified by tbdd_set_parallel_justify are not counted.
+ */
+extern void tbdd_set_time_justify(bool enable);
+
+/*
+  Pass each proof step to an in-process checker as it is generated,
+  so that checking can proceed while the solver runs.
+  The add function gets the ID, literals, and hints of each added clause
+  (hints can be NULL for DRAT proofs).  The delete function gets the IDs of
+  deleted clauses.  Clause IDs are those of the untrimmed LRAT proof.
+  Works with or without a proof file.
+  Must be set before calling tbdd_init.
+ */
+typedef void (*tbdd_add_clause_fun)(clause_id_t clause_id, ilist literals, ilist hints);
+typedef void (*tbdd_delete_clauses_fun)(ilist clause_ids);
+
+extern void tbdd_set_proof_checker(tbdd_add_clause_fun af, tbdd_delete_clauses_fun df);
+
 /*============================================
  Creation and manipulation of trusted BDDs
 ============================================*/
@@ -157,7 +211,7 @@ void tbdd_print(TBDD r, FILE *out);
   Create a fresh TBDD.  Increment reference count for BDD
   and initialize reference count for TBDD
  */
-TBDD tbdd_create(BDD r, int clause_id);
+TBDD tbdd_create(BDD r, clause_id_t clause_id);
 
 /*
   Increment/decrement reference count for BDD
@@ -234,7 +288,7 @@ extern TBDD tbdd_validate_with_and(BDD r, TBDD tl, TBDD tr);
   Use this version when generating LRAT proofs
   Returns clause id.
  */
-extern int tbdd_validate_clause(ilist clause, TBDD tr);
+extern clause_id_t tbdd_validate_clause(ilist clause, TBDD tr);
 
 /*
   Assert that a clause holds.  Proof checker
@@ -243,7 +297,7 @@ extern int tbdd_validate_clause(ilist clause, TBDD tr);
   or when don't want to provide antecedent in FRAT proof
   Returns clause id.
  */
-extern int assert_clause(ilist clause);
+extern clause_id_t assert_clause(ilist clause);
 
 /*============================================
  Useful BDD operations
@@ -277,7 +331,7 @@ class tbdd
 {
  public:
 
-    tbdd(const bdd &r, const int &id) { tb = tbdd_create(r.get_BDD(), id); }
+    tbdd(const bdd &r, const clause_id_t &id) { tb = tbdd_create(r.get_BDD(), id); }
     tbdd(const tbdd &t)               { tb = tbdd_addref(t.tb); }
     tbdd(TBDD tr)                     { tb = tr; }  
     tbdd(void)                        { tb = TBDD_tautology(); } 
@@ -287,7 +341,7 @@ class tbdd
     tbdd operator=(const tbdd &tr)    { if (tb.root != tr.tb.root) { tbdd_delref(tb); tb = tbdd_addref(tr.tb); } return *this; }
     // Backdoor functions provide read-only access
     bdd get_root()                     { return bdd(tb.root); }
-    int get_clause_id()                { return tb.clause_id; }
+    clause_id_t get_clause_id()        { return tb.clause_id; }
 
  private:
     TBDD tb;
@@ -301,7 +355,7 @@ class tbdd
     friend tbdd tbdd_validate(bdd r, tbdd &tr);
     friend tbdd tbdd_validate_with_and(bdd r, tbdd &tl, tbdd &tr);
     friend tbdd tbdd_trust(bdd r);
-    friend int tbdd_validate_clause(ilist clause, tbdd &tr);
+    friend clause_id_t tbdd_validate_clause(ilist clause, tbdd &tr);
     friend tbdd tbdd_from_xor(ilist variables, int phase);
     friend int tbdd_nameid(tbdd &tr);
     friend bdd bdd_build_xor(ilist literals);
@@ -340,7 +394,7 @@ inline tbdd tbdd_validate_with_and(bdd r, tbdd &tl, tbdd &tr)
 inline tbdd tbdd_trust(bdd r)
 { return tbdd(tbdd_trust(r.get_BDD())); }
 
-inline int tbdd_validate_clause(ilist clause, tbdd &tr)
+inline clause_id_t tbdd_validate_clause(ilist clause, tbdd &tr)
 { return tbdd_validate_clause(clause, tr.tb); }
 
 inline tbdd tbdd_from_xor(ilist variables, int phase)
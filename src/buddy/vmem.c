@@ -0,0 +1,143 @@
+/*========================================================================
+  Copyright (c) 2022 Randal E. Bryant, Carnegie Mellon University
+  
+  This code was not included in the original BuDDy distribution and is
+  therefore not subject to any of its licensing terms.
+
+  Permission is hereby granted, free of
+  charge, to any person obtaining a copy of this software and
+  associated documentation files (the "Software"), to deal in the
+  Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom
+  the Software is furnished to do so, subject to the following
+  conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+  BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+========================================================================*/
+
+/*************************************************************************
+  FILE:  vmem.c
+  DESCR: Allocation of large tables that grow without copying.
+	 On Linux, a table of at least VM_MINSIZE bytes is mapped
+	 directly with mmap and grown with mremap, which moves the
+	 pages rather than copying them, so growing the node table
+	 does not need room for both the old and the new one.  The
+	 region can be marked for transparent huge pages, which cuts
+	 the TLB misses of following LOW and HIGH through a large
+	 table.  Smaller tables, and other systems, use realloc.
+*************************************************************************/
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     /* For mremap */
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include "vmem.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#define VM_MAP
+#endif
+
+   /* Smallest table that is mapped: the size of a huge page */
+#define VM_MINSIZE ((size_t) 1 << 21)
+
+
+#ifdef VM_MAP
+static void vm_advise(void *p, size_t size, int huge)
+{
+#ifdef MADV_HUGEPAGE
+   if (huge)
+      madvise(p, size, MADV_HUGEPAGE);
+#endif
+}
+
+
+static void *vm_map(size_t size, int huge)
+{
+   void *p = mmap(NULL, size, PROT_READ|PROT_WRITE,
+		  MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+
+   if (p == MAP_FAILED)
+      return NULL;
+   vm_advise(p, size, huge);
+   return p;
+}
+#endif
+
+
+/*
+  Like realloc, but also given the old size, which is 0 when p is
+  NULL.  Huge asks for transparent huge pages when the table is
+  mapped.  Returns NULL, leaving p unchanged, if out of memory.
+*/
+void *bdd_vm_realloc(void *p, size_t oldsize, size_t size, int huge)
+{
+#ifdef VM_MAP
+   void *np;
+
+   if (p == NULL)
+      oldsize = 0;
+   if (size < VM_MINSIZE  &&  oldsize < VM_MINSIZE)
+      return realloc(p, size);
+
+   if (size >= VM_MINSIZE  &&  oldsize >= VM_MINSIZE)
+   {
+      if ((np=mremap(p, oldsize, size, MREMAP_MAYMOVE)) == MAP_FAILED)
+	 return NULL;
+      vm_advise(np, size, huge);
+      return np;
+   }
+
+      /* Crossing the threshold: copy once */
+   if (size >= VM_MINSIZE)
+   {
+      if ((np=vm_map(size, huge)) == NULL)
+	 return NULL;
+      if (p != NULL)
+      {
+	 memcpy(np, p, oldsize);
+	 free(p);
+      }
+   }
+   else
+   {
+      if ((np=malloc(size)) == NULL)
+	 return NULL;
+      memcpy(np, p, size);
+      munmap(p, oldsize);
+   }
+   return np;
+#else
+   return realloc(p, size);
+#endif
+}
+
+
+/*
+  Free a table from bdd_vm_realloc, given its size
+*/
+void bdd_vm_free(void *p, size_t size)
+{
+#ifdef VM_MAP
+   if (p != NULL  &&  size >= VM_MINSIZE)
+   {
+      munmap(p, size);
+      return;
+   }
+#endif
+   free(p);
+}
+
+
+/* EOF */
@@ -18,11 +18,20 @@ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
 OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 **************************************************************************************************/
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/time.h>
+#include <pthread.h>
 
 #define PRINT		0
 #define DELETED		-1
@@ -32,16 +41,30 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define CNF		100
 #define LRAT		200
 #define CLRAT		300
+#define BLRAT		400
 #define BUCKET		8192
 #define INIT		1024
+#define STREAM_CHUNK	(1 << 16)	// read size for pipes and FIFOs
+#define EPOCH		65536	// number of proof lines per epoch in parallel mode
 
 void usage(char *name) {
-  printf("Usage: %s FILE1.cnf FILE2.lrat [optional: FILE3.drat]\n", name);
+  printf("Usage: %s [-t THREADS] FILE1.cnf FILE2.lrat(b) [optional: FILE3.drat]\n", name);
+  printf("  Binary LRAT proofs are detected automatically\n");
+  printf("  Proofs can be read from a pipe or FIFO as they are generated (use '-' for standard input)\n");
+  printf("  -t THREADS  Check RUP lemmas with multiple threads\n");
   exit(0);
 }
 
-//typedef long long ltype;
+// Clause IDs, positions in the clause table, and the values read from
+// the proof have type ltype.  Compile with -DCLAUSE_ID64 for proofs
+// having more than 2^31 clauses
+#ifdef CLAUSE_ID64
+typedef long long ltype;
+typedef unsigned long long ultype;
+#else
 typedef int ltype;
+typedef unsigned ultype;
+#endif
 typedef int mtype;
 
 ltype added_clauses = 0;
@@ -53,48 +76,52 @@ ltype *mask, *intro, now, lastIndex;
 
 int maxBucket;
 
-int *clsList, clsAlloc, clsLast;
-int *table, tableSize, tableAlloc, maskAlloc;
-int *litList, litCount, litAlloc;
+ltype *clsList, clsLast;
+ltype *table, tableSize, tableAlloc;
+int clsAlloc, maskAlloc;
+ltype *litList;
+int litCount, litAlloc;
 int *inBucket, *topTable, topAlloc;
 
-int  getType   (int* list) { return list[1]; }
-int  getIndex  (int* list) { return list[0]; }
-int  getLength (int* list) { int i = 2; while (list[i]) i++; return i - 2; }
-int* getHints  (int* list) { return list + getLength (list) + 2; }
-int  getRATs   (int* list) { int c = 0; while (*list) if ((*list++) < 0) c++; return c; }
+int    getType   (ltype* list) { return list[1]; }
+ltype  getIndex  (ltype* list) { return list[0]; }
+int    getLength (ltype* list) { int i = 2; while (list[i]) i++; return i - 2; }
+ltype* getHints  (ltype* list) { return list + getLength (list) + 2; }
+int    getRATs   (ltype* list) { int c = 0; while (*list) if ((*list++) < 0) c++; return c; }
 
 int convertLit (int lit)   { return (abs(lit) * 2) + (lit < 0); }
 int printLit   (int lit)   { return (lit >> 1) * (-2 * (lit&1) + 1); }
 
-inline int getClause (int index) {
+inline ltype getClause (ltype index) {
   int bucket = index / BUCKET;
   int offset = index % BUCKET;
-  return clsList[topTable[bucket]*BUCKET + offset]; }
+  return clsList[(ltype) topTable[bucket]*BUCKET + offset]; }
 
-inline void setClause (int index, int value) {
+inline void setClause (ltype index, ltype value) {
   int bucket = index / BUCKET;
   int offset = index % BUCKET;
-  clsList[topTable[bucket]*BUCKET + offset] = value; }
+  clsList[(ltype) topTable[bucket]*BUCKET + offset] = value; }
 
-void printClause (int* clause) {
-  while (*clause) printf ("%i ", *clause++); printf ("0\n"); }
+void printClause (ltype* clause) {
+  while (*clause) printf ("%lli ", (long long) *clause++); printf ("0\n"); }
 
-int checkRedundancy (int pivot, int start, int *hints, ltype thisMask, int print) {
-  int res = abs(*hints++);
+int checkRedundancy (int pivot, ltype start, ltype *hints, ltype thisMask, int print) {
+  ltype res = *hints < 0 ? -*hints : *hints;
+  hints++;
   assert (start <= res);
 
 
-  if (print) printf ("c check redundancy res: %i pivot: %i start: %i\n", res, printLit(pivot), start);
+  if (print) printf ("c check redundancy res: %lli pivot: %i start: %lli\n", (long long) res, printLit(pivot), (long long) start);
   if (res != 0) {
     while (start < res) {
       if (getClause(start++) != DELETED) {
-        int *clause = table + getClause(start-1);
+        ltype *clause = table + getClause(start-1);
         while (*clause) {
           int clit = convertLit (*clause++);
           if (clit == (pivot^1)) { printf ("c FAILED tautology %i\n", pivot); return FAILED; } } } }
-    if (getClause(res) == DELETED) { printf ("c ERROR: using DELETED clause %i\n", res); return FAILED; };
-    int flag = 0, *clause = table + getClause(res);
+    if (getClause(res) == DELETED) { printf ("c ERROR: using DELETED clause %lli\n", (long long) res); return FAILED; };
+    int flag = 0;
+    ltype *clause = table + getClause(res);
     while (*clause) {
       int clit = convertLit (*clause++);
       if (clit == (pivot^1)) { flag = 1; continue; }
@@ -105,14 +132,15 @@ int checkRedundancy (int pivot, int start, int *hints, ltype thisMask, int print
 
   while (*hints > 0) {
     if (print) {
-      printf ("c hint %i\nc ", *hints);
-      int* c = table + getClause(*hints); printClause (c); }
-    if (getClause(*hints) == DELETED) { printf ("c ERROR: using DELETED hint clause %i\n", *hints); printf ("c %i\n", topTable[*hints/BUCKET]); return FAILED; };
-    int unit = 0, *clause = table + getClause(*(hints++));
+      printf ("c hint %lli\nc ", (long long) *hints);
+      ltype* c = table + getClause(*hints); printClause (c); }
+    if (getClause(*hints) == DELETED) { printf ("c ERROR: using DELETED hint clause %lli\n", (long long) *hints); printf ("c %i\n", topTable[*hints/BUCKET]); return FAILED; };
+    int unit = 0;
+    ltype *clause = table + getClause(*(hints++));
     while (*clause) {
       int clit = convertLit (*(clause++));
       if (mask[clit] >= thisMask) continue; // lit is falsified
-      if (unit != 0) { printf ("c FAILED: multiple literals unassigned in hint %i: %i %i\n", hints[-1], unit%2?(-unit >> 1):(unit>>1), clit%2?(-clit >> 1):(clit>>1));
+      if (unit != 0) { printf ("c FAILED: multiple literals unassigned in hint %lli: %i %i\n", (long long) hints[-1], unit%2?(-unit >> 1):(unit>>1), clit%2?(-clit >> 1):(clit>>1));
                        return FAILED; }
       unit = clit; }
     if (print) {
@@ -125,7 +153,17 @@ int checkRedundancy (int pivot, int start, int *hints, ltype thisMask, int print
   if (res == 0) return SUCCESS;
   return FAILED; }
 
-int checkClause (int* list, int size, int* hints, int print) {
+void growMask (int clit) {
+  if (clit >= maskAlloc) { // in case we encountered a new literal
+    int old = maskAlloc;  // need to set intro?
+    maskAlloc = (clit * 3) >> 1;
+    if (maskAlloc % 2) maskAlloc++;
+    mask  = (ltype *) realloc (mask,  sizeof (ltype) * maskAlloc);
+    intro = (ltype *) realloc (intro, sizeof (ltype) * maskAlloc);
+    if (!mask || !intro) { printf ("c Memory allocation failure\n"); exit (1); }
+    for (int j = old; j < maskAlloc; j++) mask[j] = intro[j] = 0; } }
+
+int checkClause (ltype* list, int size, ltype* hints, int print) {
   now++;
   int pivot = convertLit (list[0]);
 
@@ -134,31 +172,24 @@ int checkClause (int* list, int size, int* hints, int print) {
   int RATs = getRATs (hints + 1); // the number of negated hints
   for (int i = 0; i < size; i++) { // assign all literals in the clause to false
     int clit = convertLit (list[i]);
-    if (clit >= maskAlloc) { // in case we encountered a new literal
-      int old = maskAlloc;  // need to set intro?
-      maskAlloc = (clit * 3) >> 1;
-      if (maskAlloc % 2) maskAlloc++;
-      mask  = (ltype *) realloc (mask,  sizeof (ltype) * maskAlloc);
-      intro = (ltype *) realloc (intro, sizeof (ltype) * maskAlloc);
-      if (!mask || !intro) { printf ("c Memory allocation failure\n"); exit (1); }
-      for (int j = old; j < maskAlloc; j++) mask[j] = intro[j] = 0; }
+    growMask (clit);
     mask [clit] = now + RATs; } // mark all literals in lemma with mask
 
   int res = checkRedundancy (pivot, 0, hints, now + RATs, print);
   if (res == CONFLICT) { return SUCCESS; }
   if (res == FAILED  ) { return FAILED;  }
 
-  int *first = hints; first++; while (*first > 0) first++;
-  int start = intro[pivot ^ 1];
+  ltype *first = hints; first++; while (*first > 0) first++;
+  ltype start = intro[pivot ^ 1];
 
   if (RATs == 0)      {
-    if (print) printf ("c start %i first %i\n", start, -first[0]);
+    if (print) printf ("c start %lli first %lli\n", (long long) start, (long long) -first[0]);
     if (start != 0) return FAILED;
     return SUCCESS; }
 
   while (start < -first[0]) {  // check whether no clause before -first[0] has -pivot.
     if (getClause(start) != DELETED) {
-      int *clause = table + getClause(start);
+      ltype *clause = table + getClause(start);
       while (*clause) {
         int clit = convertLit (*clause++);
         if (clit == (pivot^1)) return FAILED; } }
@@ -170,24 +201,24 @@ int checkClause (int* list, int size, int* hints, int print) {
   while (1) {
     hints++; now++; while (*hints > 0) hints++;
     if (*hints == 0) break;
-    if (-hints[0] < start) printf ("c %i %i\n", -hints[0], start);
+    if (-hints[0] < start) printf ("c %lli %lli\n", (long long) -hints[0], (long long) start);
     assert (-hints[0] >= start);
     if (checkRedundancy (pivot, start, hints, now, print) == FAILED) return FAILED;
-    start = abs(*hints) + 1; }
+    start = -*hints + 1; }
 
   while (start <= clsLast) {
     if (getClause(start++) != DELETED) {
-      int *clause = table + getClause(start-1);
+      ltype *clause = table + getClause(start-1);
       while (*clause) {
         int clit = convertLit (*clause++);
         if (clit == (pivot^1)) { printf("c FAILED: tautology %i\n", pivot); return FAILED; } } } }
 
   return SUCCESS; }
 
-void addClause (int index, int* literals, int size, FILE* drat) {
+void addClause (ltype index, ltype* literals, int size, FILE* drat) {
 
 //  printf ("c index %i\n", index);
-  if (index >= topAlloc * BUCKET) {
+  if (index >= (ltype) topAlloc * BUCKET) {
     int old = topAlloc;
     topAlloc = (topAlloc * 3) >> 1;
     printf ("c topTable reallocation from %i to %i\n", old, topAlloc);
@@ -209,21 +240,21 @@ void addClause (int index, int* literals, int size, FILE* drat) {
     printf ("c increasing the number of buckets from %i to %i\n", bucket, maxBucket);
     inBucket = (int*) realloc (inBucket, sizeof(int) * maxBucket);
     for (int j = bucket; j < maxBucket; j++) inBucket[j] = 0;
-    clsList = (int*) realloc (clsList, sizeof(int) * maxBucket * BUCKET);
-    for (int i = bucket * BUCKET; i < maxBucket * BUCKET; i++) clsList[i] = DELETED; // is this required?
+    clsList = (ltype*) realloc (clsList, sizeof(ltype) * maxBucket * BUCKET);
+    for (ltype i = (ltype) bucket * BUCKET; i < (ltype) maxBucket * BUCKET; i++) clsList[i] = DELETED; // is this required?
   }
 
   topTable[index/BUCKET] = bucket;
 
   if (tableSize + size >= tableAlloc) {
     tableAlloc = (tableAlloc * 3) >> 1;
-    table = (int*) realloc (table, sizeof (int) * tableAlloc); }
+    table = (ltype*) realloc (table, sizeof (ltype) * tableAlloc); }
 
   setClause (index, tableSize);
   for (int i = 0; i < size; i++) {
     int clit = convertLit (literals[i]);
     if (intro[clit] == 0) intro[clit] = index;
-    if (drat != NULL) fprintf (drat, "%i ", literals[i]);
+    if (drat != NULL) fprintf (drat, "%lli ", (long long) literals[i]);
     table[tableSize++] = literals[i]; }
   if (drat != NULL) fprintf (drat, "0\n");
   table[tableSize++] = 0;
@@ -238,16 +269,16 @@ void addClause (int index, int* literals, int size, FILE* drat) {
       max_live_clauses = live_clauses;
 }
 
-void deleteClauses (int* list, FILE* drat) {
+void deleteClauses (ltype* list, FILE* drat) {
   while (*list) {
-    int index = *list++;
+    ltype index = *list++;
     if (getClause(index) == DELETED) {
-      printf ("c WARNING: clause %i is already deleted\n", index); }
+      printf ("c WARNING: clause %lli is already deleted\n", (long long) index); }
     else {
       if (drat) {
-        int* clause = table + getClause(index);
+        ltype* clause = table + getClause(index);
         fprintf (drat, "d ");
-        while (*clause) fprintf (drat, "%i ", *clause++);
+        while (*clause) fprintf (drat, "%lli ", (long long) *clause++);
         fprintf (drat, "0\n"); }
       setClause (index, DELETED);
       int bucket = topTable[index/BUCKET];
@@ -261,18 +292,18 @@ void deleteClauses (int* list, FILE* drat) {
   }
 }
 
-void compress (int index, int print) {
-   int* newTable = table;
-   int n = 0;
+void compress (ltype index, int print) {
+   ltype* newTable = table;
+   ltype n = 0;
    for (int i = 0; i < topAlloc; i++) {
      if (topTable[i] == -1) continue;
 //     int b = topTable[i];
 //     printf ("c bucket: %i size: %i\n", b, inBucket[b]);
 //     assert (inBucket[b]);
      for (int j = 0; j < BUCKET; j++) {
-       int c = i*BUCKET+j;
+       ltype c = (ltype) i*BUCKET+j;
        if (getClause(c) == DELETED) continue;
-       int* clause = table + getClause(c);
+       ltype* clause = table + getClause(c);
        setClause (c, n);
        while (*clause != 0) { newTable[n++] = *clause++; }
        newTable[n++] = 0; }
@@ -291,34 +322,160 @@ void compress (int index, int print) {
    }
 */
    if (print)
-     printf ("c compress at index %i: tableSize reduced from %i to %i\n", index, tableSize, n);
+     printf ("c compress at index %lli: tableSize reduced from %lli to %lli\n", (long long) index, (long long) tableSize, (long long) n);
    tableSize = n;
 }
 
-static void addLit (int lit) {
+static void addLit (ltype lit) {
   if (litCount >= litAlloc) {
     litAlloc = (litAlloc * 3) >> 1;
-    litList = (int*) realloc (litList, sizeof (int) * litAlloc); }
+    litList = (ltype*) realloc (litList, sizeof (ltype) * litAlloc); }
   litList[litCount++] = lit; }
 
-int parseLine (FILE* file, int mode, int line) {
-  int lit, tmp;
-  litCount = 0;
-  char c = 0;
+// Regular files are mapped into memory and parsed directly.
+// Pipes, FIFOs and standard input ("-") are read in chunks as data arrives
+typedef struct {
+  char *buf, *pos, *end;
+  size_t size;
+  int mapped;
+  int fd; } reader;   // fd >= 0 while more input can be read
+
+int openReader (reader* r, char* name) {
+  int fd = strcmp (name, "-") == 0 ? dup (STDIN_FILENO) : open (name, O_RDONLY);
+  if (fd < 0) return 0;
+  struct stat st;
+  r->mapped = 0;
+  r->buf = NULL;
+  r->size = 0;
+  r->fd = -1;
+  if (fstat (fd, &st) == 0 && S_ISREG (st.st_mode) && st.st_size > 0) {
+    void* m = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m != MAP_FAILED) {
+      posix_madvise (m, st.st_size, POSIX_MADV_SEQUENTIAL);
+      r->buf = (char*) m; r->size = st.st_size; r->mapped = 1; } }
+  if (r->mapped) close (fd);
+  else {
+    r->size = STREAM_CHUNK;
+    r->buf = (char*) malloc (r->size);
+    if (!r->buf) { printf ("c Memory allocation failure\n"); exit (1); }
+    r->fd = fd; }
+  r->pos = r->buf;
+  r->end = r->mapped ? r->buf + r->size : r->buf;
+  return 1; }
+
+// Called when all buffered input is consumed.  Return 0 at end of input
+int fillReader (reader* r) {
+  while (r->fd >= 0) {
+    ssize_t n = read (r->fd, r->buf, r->size);
+    if (n > 0) {
+      r->pos = r->buf;
+      r->end = r->buf + n;
+      return 1; }
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) printf ("c ERROR: failed to read input\n");
+    close (r->fd);
+    r->fd = -1; }
+  return 0; }
+
+// Is there another byte of input?
+static inline int more (reader* r) {
+  return r->pos < r->end || fillReader (r); }
+
+void closeReader (reader* r) {
+  if (r->mapped) munmap (r->buf, r->size);
+  else free (r->buf);
+  if (r->fd >= 0) close (r->fd);
+  r->buf = r->pos = r->end = NULL; }
+
+static inline int isSpace (char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r'; }
+
+static inline void skipSpace (reader* r) {
+  while (more (r) && isSpace (*r->pos)) r->pos++; }
+
+// Skip white space and comment lines
+static inline void skipComments (reader* r) {
   while (1) {
-    tmp = fscanf (file, " c%c", &c);
-    if (tmp == EOF) return 0;
-    if (tmp ==   0) break;
-    while (1) {
-      if (tmp == EOF ) return 0;
-      if (c   == '\n') break;
-      tmp = fscanf (file, "%c", &c); } }
+    skipSpace (r);
+    if (!more (r) || *r->pos != 'c') return;
+    while (more (r) && *r->pos != '\n') r->pos++; } }
+
+// Match string in input.  Return 0 if it doesn't match
+int matchString (reader* r, const char* s) {
+  for (; *s; s++, r->pos++)
+    if (!more (r) || *r->pos != *s) return 0;
+  return 1; }
+
+// Read decimal integer.  Return 0 if none found
+static inline int readInt (reader* r, ltype* val) {
+  skipSpace (r);
+  if (!more (r)) return 0;
+  int sign = 1;
+  if (*r->pos == '-') { sign = -1; r->pos++; }
+  if (!more (r) || *r->pos < '0' || *r->pos > '9') return 0;
+  ltype v = 0;
+  while (more (r) && *r->pos >= '0' && *r->pos <= '9')
+    v = 10 * v + (*r->pos++ - '0');
+  *val = sign * v;
+  return 1; }
+
+// Read integer in variable-byte encoding of binary proofs.  Return 0 if none found
+static inline int readBinaryInt (reader* r, ltype* val) {
+  ultype u = 0;
+  int shift = 0;
+  while (1) {
+    if (!more (r)) return 0;
+    unsigned char b = (unsigned char) *r->pos++;
+    u |= (ultype) (b & 0x7F) << shift;
+    if (b < 128) break;
+    shift += 7; }
+  *val = (u & 1) ? -(ltype) (u >> 1) : (ltype) (u >> 1);
+  return 1; }
+
+// Binary proofs start with an addition or deletion.  Text proofs start with a number or comment
+int isBinary (reader* r) {
+  return more (r) && (*r->pos == 'a' || *r->pos == 'd'); }
+
+int parseError = 0;
+// Set once the empty clause has been derived.  A proof that ends before
+// then (e.g., a truncated one) is not verified
+int verified = 0;
+
+int parseBinaryLine (reader* r) {
+  ltype lit;
+  if (!more (r)) return 0;
+  char c = *r->pos++;
+  int zeros;
+  if (c == 'a') {
+    if (!readBinaryInt (r, &lit)) return 0;
+    addLit (lit);
+    zeros = 2; }
+  else if (c == 'd') {
+    addLit (lastIndex);
+    zeros = 1; }
+  else {
+    printf ("c ERROR: invalid byte 0x%.2x in binary proof\n", (unsigned char) c);
+    parseError = 1;
+    return 0; }
+  addLit ((int) c);
+  while (zeros > 0) {
+    if (!readBinaryInt (r, &lit)) {
+      printf ("c ERROR: incomplete line at end of binary proof\n");
+      parseError = 1;
+      return 0; }
+    addLit (lit);
+    if (lit == 0) zeros--; }
+  return litCount; }
+
+int parseLine (reader* r, int mode, ltype line) {
+  ltype lit;
+  litCount = 0;
+  if (mode == BLRAT) return parseBinaryLine (r);
+  skipComments (r);
 
   if (mode == CNF) {
     line++;
     while (1) {
-      tmp = fscanf (file, " %i ", &lit);
-      if (tmp == 0 || tmp == EOF) return 0;
+      if (!readInt (r, &lit)) return 0;
       int clit = convertLit (lit);
       if (intro[clit] == 0) {
 //        printf ("c setting intro[%i] = %i\n", lit, line - 1);
@@ -327,27 +484,20 @@ int parseLine (FILE* file, int mode, int line) {
       if (lit == 0) return litCount; } }
 
   if (mode == LRAT) {
-    int index;
+    ltype index;
     int zeros = 2;
-    tmp = fscanf (file, " %i ", &index);
-    if (tmp == 0 || tmp == EOF) return 0;
+    if (!readInt (r, &index)) return 0;
     addLit (index);
 
-    tmp = fscanf (file, " d %i ", &lit);
-    if (tmp == 1) {
+    skipSpace (r);
+    if (more (r) && *r->pos == 'd') {
+      r->pos++;
       addLit ((int) 'd');
-      addLit (lit);
-      zeros--;
-      if (lit   == 0) zeros--;
-      if (zeros == 0) {
-	  //	  printf("Processed line %d %c.  Length = %d\n", litList[1], litList[2], litCount);
-	  return litCount; }
-    }
+      zeros--; }
     else { addLit((int) 'a'); }
 
     while (1) {
-      tmp = fscanf (file, " %i ", &lit);
-      if (tmp == 0 || tmp == EOF) return 0;
+      if (!readInt (r, &lit)) return 0;
       addLit(lit);
       if (lit   == 0) zeros--;
       if (zeros == 0) {
@@ -357,7 +507,191 @@ int parseLine (FILE* file, int mode, int line) {
   }
   return 0; }
 
+/*
+  Parallel checking.  The proof is processed in epochs of EPOCH lines.
+  The main thread processes the lines of an epoch in order: it performs
+  deletions, checks lemmas having RAT hints, and for lemmas having only
+  RUP hints, it looks up the hint clauses and adds the lemma to the
+  clause table without checking it.  Worker threads then check these
+  lemmas against the (now unchanging) clause table, each with its own
+  mask array, while the main thread parses the next epoch.
+*/
+
+typedef struct {
+  ltype index;    // lemma ID
+  ltype litOff;   // position of lemma literals in table
+  int hintStart;  // position of hint clause offsets in hintOff
+  int hintCount;
+  int step;       // position of line within epoch
+  int ratOK;      // no clause contains negated pivot
+  int result; } rupItem;
+
+typedef struct {
+  ltype *steps;   // each line stored as length followed by litList
+  size_t count, alloc;
+  int nsteps; } epochBuf;
+
+typedef struct {
+  pthread_t thread;
+  int id, nthreads;
+  ltype *mask, now;
+  int maskSize; } worker;
+
+rupItem *items;
+int nItems, itemAlloc;
+ltype *hintOff;
+int nHintOff, hintOffAlloc;
+
+void parseEpoch (reader* r, int mode, epochBuf* eb) {
+  eb->count = 0;
+  eb->nsteps = 0;
+  while (eb->nsteps < EPOCH) {
+    int size = parseLine (r, mode, 0);
+    if (size == 0) break;
+    if (eb->count + size + 1 > eb->alloc) {
+      eb->alloc = 2 * (eb->count + size + 1);
+      eb->steps = (ltype*) realloc (eb->steps, sizeof (ltype) * eb->alloc);
+      if (!eb->steps) { printf ("c Memory allocation failure\n"); exit (1); } }
+    eb->steps[eb->count++] = size;
+    memcpy (eb->steps + eb->count, litList, sizeof (ltype) * size);
+    eb->count += size;
+    eb->nsteps++; } }
+
+// Position of clause in table, or DELETED if not present
+ltype findClause (ltype index) {
+  if (index <= 0 || index >= (ltype) topAlloc * BUCKET || topTable[index/BUCKET] < 0) return DELETED;
+  return getClause (index); }
+
+void addItem (ltype index, int step, ltype* list, ltype* hints) {
+  if (nItems >= itemAlloc) {
+    itemAlloc = 2 * itemAlloc + 1024;
+    items = (rupItem*) realloc (items, sizeof (rupItem) * itemAlloc);
+    if (!items) { printf ("c Memory allocation failure\n"); exit (1); } }
+  rupItem* it = &items[nItems++];
+  it->index = index;
+  it->step = step;
+  it->ratOK = intro[convertLit (list[0]) ^ 1] == 0;
+  it->hintStart = nHintOff;
+  it->hintCount = 0;
+  it->result = SUCCESS;
+  for (hints++; *hints > 0; hints++) {
+    if (nHintOff >= hintOffAlloc) {
+      hintOffAlloc = 2 * hintOffAlloc + 1024;
+      hintOff = (ltype*) realloc (hintOff, sizeof (ltype) * hintOffAlloc);
+      if (!hintOff) { printf ("c Memory allocation failure\n"); exit (1); } }
+    ltype pos = findClause (*hints);
+    if (pos == DELETED) {
+      printf ("c ERROR: using DELETED hint clause %lli\n", (long long) *hints);
+      it->result = FAILED; }
+    hintOff[nHintOff++] = pos;
+    it->hintCount++; } }
+
+int checkRUP (worker* w, rupItem* it) {
+  if (it->result == FAILED) return FAILED;
+  ltype thisMask = ++w->now;
+  ltype* lits = table + it->litOff;
+  while (*lits) w->mask[convertLit (*lits++)] = thisMask;
+  for (int i = 0; i < it->hintCount; i++) {
+    int unit = 0;
+    ltype *clause = table + hintOff[it->hintStart + i];
+    while (*clause) {
+      int clit = convertLit (*(clause++));
+      if (w->mask[clit] >= thisMask) continue; // lit is falsified
+      if (unit != 0) return FAILED;
+      unit = clit; }
+    if (unit == 0) return SUCCESS;  // detected conflict
+    w->mask[unit^1] = thisMask; }
+  return it->ratOK ? SUCCESS : FAILED; }
+
+void* runWorker (void* arg) {
+  worker* w = (worker*) arg;
+  for (int i = w->id; i < nItems; i += w->nthreads)
+    items[i].result = checkRUP (w, &items[i]);
+  return NULL; }
+
+int checkParallel (reader* proof, int mode, FILE* drat, int nthreads) {
+  worker* workers = (worker*) calloc (nthreads, sizeof (worker));
+  for (int t = 0; t < nthreads; t++) {
+    workers[t].id = t; workers[t].nthreads = nthreads; }
+  epochBuf eb[2] = { { NULL, 0, 0, 0 }, { NULL, 0, 0, 0 } };
+  int cur = 0;
+  ltype line = 0;
+  ltype del = 0;
+  parseEpoch (proof, mode, &eb[cur]);
+  while (eb[cur].nsteps > 0) {
+    if (live_clauses < 5 * (deleted_clauses - del)) {
+      compress (line, 0);
+      del = deleted_clauses; }
+
+    // Sequential pass over epoch
+    nItems = nHintOff = 0;
+    int failStep = -1, emptyAdded = 0;
+    ltype* list = eb[cur].steps;
+    for (int step = 0; step < eb[cur].nsteps; step++) {
+      int size = *list++;
+      ltype* lits = list;
+      list += size;
+      if (getType (lits) == (int) 'd') {
+        deleteClauses (lits + 2, drat); }
+      else if (getType (lits) == (int) 'a') {
+        line  = getIndex  (lits);
+        lastIndex = line;
+        int    length = getLength (lits);
+        ltype* hints  = getHints  (lits);
+        if (getRATs (hints + 1) > 0) {
+          if (checkClause (lits + 2, length, hints, 0) != SUCCESS) { failStep = step; break; } }
+        else {
+          for (int i = 0; i < length; i++) growMask (convertLit (lits[i+2]));
+          addItem (line, step, lits + 2, hints); }
+        addClause (line, lits + 2, length, drat);
+        if (getRATs (hints + 1) == 0) items[nItems-1].litOff = getClause (line);
+        if (length == 0) emptyAdded = 1; }
+      else {
+        printf ("c failed type\n");
+        failStep = step;
+        break; } }
+
+    // Check RUP lemmas while parsing next epoch
+    for (int t = 0; t < nthreads; t++) {
+      worker* w = &workers[t];
+      if (w->maskSize < maskAlloc) {
+        w->mask = (ltype*) realloc (w->mask, sizeof (ltype) * maskAlloc);
+        if (!w->mask) { printf ("c Memory allocation failure\n"); exit (1); }
+        for (int j = w->maskSize; j < maskAlloc; j++) w->mask[j] = 0;
+        w->maskSize = maskAlloc; }
+      pthread_create (&w->thread, NULL, runWorker, w); }
+    if (failStep < 0)
+      parseEpoch (proof, mode, &eb[cur^1]);
+    for (int t = 0; t < nthreads; t++)
+      pthread_join (workers[t].thread, NULL);
+
+    // Find earliest failure
+    ltype* failed = NULL;
+    for (int i = 0; i < nItems; i++)
+      if (items[i].result != SUCCESS) {
+        if (failStep < 0 || items[i].step < failStep) failed = table + items[i].litOff;
+        break; }
+    if (failed == NULL && failStep >= 0) {
+      ltype* list = eb[cur].steps;
+      for (int step = 0; step < failStep; step++) list += *list + 1;
+      failed = list + 3; }
+    if (failed != NULL) {
+      printf("c failed while checking clause: "); printClause (failed);
+      printf("c NOT VERIFIED\n");
+      return 1; }
+    if (emptyAdded) {
+      printf ("c VERIFIED\n");
+      verified = 1; }
+    cur ^= 1; }
+  return 0; }
+
 int main (int argc, char** argv) {
+  int nthreads = 1;
+  if (argc > 2 && strcmp (argv[1], "-t") == 0) {
+    nthreads = atoi (argv[2]);
+    if (nthreads < 1) usage (argv[0]);
+    argv[2] = argv[0];
+    argc -= 2; argv += 2; }
   if (argc < 3)
      usage(argv[0]);
   struct timeval start_time, finish_time;
@@ -365,20 +699,17 @@ int main (int argc, char** argv) {
   gettimeofday(&start_time, NULL);
   now = 0, clsLast = 0;
 
-  int nVar = 0, nCls = 0;
-  char ignore[1024];
-  FILE* cnf   = fopen (argv[1], "r");
-  if (!cnf) {
+  ltype nVar = 0, nCls = 0;
+  reader cnf;
+  if (!openReader (&cnf, argv[1])) {
       printf("Couldn't open file '%s'\n", argv[1]);
       exit(1); }
 
-  for (;;) {
-    fscanf (cnf, " p cnf %i %i ", &nVar, &nCls);
-    if (nVar > 0) break;
-    fgets (ignore, sizeof (ignore), cnf);
-    int j; for (j = 0; j < 1024; j++) { if (ignore[j] == '\n') break; }
-    if (j == 1024) {
-      printf ("c ERROR: comment longer than 1024 characters: %s\n", ignore); exit (0); } }
+  skipComments (&cnf);
+  if (!matchString (&cnf, "p cnf")) {
+    printf ("c ERROR: missing header in CNF file '%s'\n", argv[1]); exit (1); }
+  if (!readInt (&cnf, &nVar) || !readInt (&cnf, &nCls)) {
+    printf ("c ERROR: invalid header in CNF file '%s'\n", argv[1]); exit (1); }
 
   topAlloc = INIT;
   topTable = (int*) malloc (sizeof(int) * topAlloc);
@@ -387,32 +718,32 @@ int main (int argc, char** argv) {
   maxBucket = topAlloc;
   inBucket = (int*) malloc (sizeof(int) * maxBucket);
   for (int i = 0; i < maxBucket; i++) inBucket[i] = 0;
-  clsList  = (int*) malloc (sizeof(int) * maxBucket * BUCKET);
+  clsList  = (ltype*) malloc (sizeof(ltype) * maxBucket * BUCKET);
   for (int i = 0; i < maxBucket * BUCKET; i++) clsList[i] = DELETED;
 
   tableSize  = 0;
   tableAlloc = nCls * 2;
-  table = (int *) malloc (sizeof(int) * tableAlloc);
+  table = (ltype *) malloc (sizeof(ltype) * tableAlloc);
 
   litAlloc = nVar * 10;
-  litList = (int*) malloc (sizeof (int) * litAlloc);
+  litList = (ltype*) malloc (sizeof (ltype) * litAlloc);
 
   maskAlloc = 20 * nVar;
   mask  = (ltype*) malloc (sizeof(ltype) * maskAlloc);
   intro = (ltype*) malloc (sizeof(ltype) * maskAlloc);
   for (int i = 0; i < maskAlloc; i++) mask[i] = intro[i] = 0;
 
-  int index = 1;
+  ltype index = 1;
   while (1) {
-    int size = parseLine (cnf, CNF, index);
+    int size = parseLine (&cnf, CNF, index);
     if (size == 0) break;
     addClause (index++, litList, size, NULL); }
-  fclose (cnf);
+  closeReader (&cnf);
 
-  printf ("c parsed a formula with %i variables and %i clauses\n", nVar, nCls);
+  printf ("c parsed a formula with %lli variables and %lli clauses\n", (long long) nVar, (long long) nCls);
 
-  FILE* proof = fopen (argv[2], "r");
-  if (!proof) {
+  reader proof;
+  if (!openReader (&proof, argv[2])) {
     printf("c Couldn't open file '%s'\n", argv[2]);
     exit(1); }
 
@@ -424,15 +755,19 @@ int main (int argc, char** argv) {
       exit(1); } }
 
   int print = PRINT;
-  int mode = LRAT;
-  int line = 0;
+  int mode = isBinary (&proof) ? BLRAT : LRAT;
+  if (mode == BLRAT) printf ("c reading binary proof\n");
+  ltype line = 0;
   ltype del = 0;
-  while (1) {
+  if (nthreads > 1) {
+    printf ("c checking with %i threads\n", nthreads);
+    return_code = checkParallel (&proof, mode, drat, nthreads); }
+  else while (1) {
     if (live_clauses < 5 * (deleted_clauses - del)) {
       compress (line, print);
       del = deleted_clauses; }
 
-    int size = parseLine (proof, LRAT, 0);
+    int size = parseLine (&proof, mode, 0);
     if (size == 0) break;
 
     if (getType (litList) == (int) 'd') {
@@ -440,8 +775,8 @@ int main (int argc, char** argv) {
     else if (getType (litList) == (int) 'a') {
       line  = getIndex  (litList);
       lastIndex = line;
-      int  length = getLength (litList);
-      int* hints  = getHints  (litList);
+      int    length = getLength (litList);
+      ltype* hints  = getHints  (litList);
 
       if (checkClause (litList + 2, length, hints, print) == SUCCESS) {
         addClause (line, litList + 2, length, drat); }
@@ -452,16 +787,23 @@ int main (int argc, char** argv) {
         return_code = 1;
         break;
       }
-      if (length == 0)
+      if (length == 0) {
         printf ("c VERIFIED\n");
+        verified = 1; }
     }
     else {
       printf ("c failed type\n");
       return_code = 1;
     }
   }
-
-  printf ("c allocated %i %i %i\n", maxBucket, tableAlloc, litAlloc);
+  if (parseError) return_code = 1;
+  if (return_code == 0 && !verified) {
+    printf ("c empty clause not derived\n");
+    printf ("c NOT VERIFIED\n");
+    return_code = 1; }
+  closeReader (&proof);
+
+  printf ("c allocated %i %lli %i\n", maxBucket, (long long) tableAlloc, litAlloc);
 
   gettimeofday(&finish_time, NULL);
   double secs = (finish_time.tv_sec + 1e-6 * finish_time.tv_usec) -
@@ -28,6 +28,8 @@
 #include <unistd.h>
 #include "signal.h"
 #include <sys/time.h>
+#include <sys/wait.h>
+#include <errno.h>
 #include <string.h>
 #include "clause.h"
 
@@ -43,12 +45,21 @@ extern bool solve(FILE *cnf_file, FILE *proof_file, FILE *order_file, FILE *sche
 // BDD-based SAT solver
 
 void usage(char *name) {
-    printf("Usage: %s [-h] [-b] [-v VERB] [-i FILE.cnf] [-o FILE.lrat(b)] [-p FILE.order] [-s FILE.schedule] [-m SOLNS] [-t TLIM]\n", name);
+    printf("Usage: %s [-h] [-b] [-a] [-l] [-r] [-g] [-j THREADS] [-P] [-J] [-v VERB] [-i FILE.cnf] [-o FILE.lrat(b)] [-c CHECKER] [-p FILE.order] [-s FILE.schedule] [-m SOLNS] [-t TLIM]\n", name);
     printf("  -h               Print this message\n");
     printf("  -b               Use bucket elimination\n");
+    printf("  -a               Write proof with background thread\n");
+    printf("  -l               Generate defining clauses only for nodes used in proof\n");
+    printf("  -r               Trim proof to clauses needed for refutation (LRAT only)\n");
+    printf("  -g               Use generational garbage collection\n");
+    printf("  -j THREADS       Use multiple threads for BDD operations\n");
+    printf("  -P               Also split proofs of conjunctions among threads\n");
+    printf("  -J               Time proof steps of conjunctions apart from the rest\n");
+    printf("  -M MB            Limit memory of BDD node table and caches to MB megabytes\n");
     printf("  -v VERB          Set verbosity level (0-3)\n");
     printf("  -i FILE.cnf      Specify input file (otherwise use standard input)\n");
     printf("  -o FILE.lrat(b)  Specify output proof file (otherwise no proof)\n");
+    printf("  -c CHECKER       Check proof while solving by piping it to CHECKER FILE.cnf -\n");
     printf("  -p FILE.order    Specify variable ordering file\n");
     printf("  -s FILE.schedule Specify schedule file\n");
     printf("  -m SOLNS         Generate up to specified number of solutions\n");
@@ -85,6 +96,43 @@ char *get_extension(char *name) {
     return NULL;
 }
 
+/*
+  Start checker as "CHECKER FILE.cnf -", without going through a shell,
+  and return a stream to its standard input.
+*/
+FILE *start_checker(char *checker, char *cnf_name, pid_t *pidp) {
+    int fd[2];
+    if (pipe(fd) != 0)
+	return NULL;
+    pid_t pid = fork();
+    if (pid < 0) {
+	close(fd[0]);
+	close(fd[1]);
+	return NULL;
+    }
+    if (pid == 0) {
+	char dash[] = "-";
+	char *args[] = { checker, cnf_name, dash, NULL };
+	close(fd[1]);
+	if (fd[0] != STDIN_FILENO) {
+	    dup2(fd[0], STDIN_FILENO);
+	    close(fd[0]);
+	}
+	execvp(checker, args);
+	fprintf(stderr, "Couldn't run proof checker '%s': %s\n", checker, strerror(errno));
+	_exit(127);
+    }
+    close(fd[0]);
+    FILE *pipe_file = fdopen(fd[1], "w");
+    if (pipe_file == NULL) {
+	close(fd[1]);
+	waitpid(pid, NULL, 0);
+	return NULL;
+    }
+    *pidp = pid;
+    return pipe_file;
+}
+
 int main(int argc, char *argv[]) {
     FILE *cnf_file = stdin;
     FILE *sched_file = NULL;
@@ -96,7 +144,11 @@ int main(int argc, char *argv[]) {
     int c;
     int verb = 1;
     int max_solutions = 1;
-    while ((c = getopt(argc, argv, "hbv:i:o:p:s:m:t:")) != -1) {
+    char *cnf_name = NULL;
+    char *checker = NULL;
+    FILE *checker_pipe = NULL;
+    pid_t checker_pid = 0;
+    while ((c = getopt(argc, argv, "hbalrgj:PJM:v:i:o:c:p:s:m:t:")) != -1) {
 	char buf[2] = { (char) c, '\0' };
 	char *extension;
 	switch (c) {
@@ -105,6 +157,30 @@ int main(int argc, char *argv[]) {
 	case 'b':
 	    bucket = true;
 	    break;
+	case 'a':
+	    tbdd_set_async_proof(true);
+	    break;
+	case 'l':
+	    tbdd_set_lazy_defining(true);
+	    break;
+	case 'r':
+	    tbdd_set_trim_proof(true);
+	    break;
+	case 'g':
+	    bdd_setgenerational(1);
+	    break;
+	case 'j':
+	    bdd_setapplythreads(atoi(optarg));
+	    break;
+	case 'P':
+	    tbdd_set_parallel_justify(true);
+	    break;
+	case 'J':
+	    tbdd_set_time_justify(true);
+	    break;
+	case 'M':
+	    bdd_setmemlimit(atoi(optarg));
+	    break;
 	case 'v':
 	    verb = atoi(optarg);
 	    break;
@@ -115,6 +191,7 @@ int main(int argc, char *argv[]) {
 	    set_timeout(atoi(optarg));
 	    break;
 	case 'i':
+	    cnf_name = optarg;
 	    cnf_file = fopen(optarg, "r");
 	    if (cnf_file == NULL) {
 		std::cerr << "Couldn't open file " << optarg << std::endl;
@@ -168,18 +245,47 @@ int main(int argc, char *argv[]) {
 		usage(argv[0]);
 	    }
 	    break;
+	case 'c':
+	    checker = optarg;
+	    break;
 	default:
 	    std::cerr << "Unknown option '" << buf << "'" << std::endl;
 	    usage(argv[0]);
 	}
     }
+    if (checker != NULL) {
+	if (cnf_name == NULL || proof_file != NULL) {
+	    std::cerr << "Proof checking requires input file and no output proof file" << std::endl;
+	    usage(argv[0]);
+	}
+	/* Binary LRAT is the most compact format to transfer and parse */
+	fflush(stdout);
+	/* Report checker failure rather than being killed when it exits early */
+	signal(SIGPIPE, SIG_IGN);
+	checker_pipe = start_checker(checker, cnf_name, &checker_pid);
+	if (checker_pipe == NULL) {
+	    std::cerr << "Couldn't run proof checker '" << checker << "'" << std::endl;
+	    exit(1);
+	}
+	proof_file = checker_pipe;
+	ptype = PROOF_LRAT;
+	binary = true;
+    }
     double start = tod();
     if (solve(cnf_file, proof_file, order_file, sched_file, bucket, verb, ptype, binary, max_solutions)) {
 	if (verb >= 1) {
 	    printf("c Elapsed seconds: %.2f\n", tod()-start);
 	}
     }
-    if (proof_file != NULL)
+    if (checker_pipe != NULL) {
+	fflush(stdout);
+	fclose(checker_pipe);
+	int status = -1;
+	if (waitpid(checker_pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+	    printf("c Proof checker failed (status %d)\n", status);
+	    return 1;
+	}
+    } else if (proof_file != NULL)
 	fclose(proof_file);
     if (sched_file != NULL)
 	fclose(sched_file);
@@ -109,11 +109,11 @@ int Clause::max_variable() {
   return mvar;
 }
 
-int * Clause::data() {
+ilist Clause::data() {
   return contents;
 }
 
-int& Clause::operator[](int i) {
+ival_t& Clause::operator[](int i) {
   return contents[i];
 }
 
@@ -173,7 +173,7 @@ void Clause::show(FILE *outfile) {
   if (is_tautology)
     fprintf(outfile, "c Tautology\n");
   for (int i = 0; i < length(); i++)
-    fprintf(outfile, "%d ", contents[i]);
+    fprintf(outfile, "%d ", (int) contents[i]);
   fprintf(outfile, "0\n");
 }
 
@@ -225,7 +225,7 @@ public:
 	    }
 	    constraint = nconstraint;
 	    solution = bdd_and(litbdd, solution);
-	    if (verbosity_level >= 3) {
+	    if (tbdd_prover_vars()->verbosity_level >= 3) {
 		std::cout << "c Assigned value " << p << " to variable V" << var << std::endl;
 	    }
 	}
@@ -237,11 +237,12 @@ public:
 	bdd nlocal_constraint = bdd_and(local_constraint, upper_constraint);
 	if (nlocal_constraint == local_constraint)
 	    return bdd_true();
-	if (verbosity_level >= 3) {
+	if (tbdd_prover_vars()->verbosity_level >= 3) {
 	    printf("c Imposing new constraint on variables V"); ilist_print(variables, stdout, " V"); printf("\n");
 	}
 	local_constraint = nlocal_constraint;
-	bdd varbdd = bdd_makeset(variables, ilist_length(variables));
+	std::vector<int> vars(variables, variables + ilist_length(variables));
+	bdd varbdd = bdd_makeset(vars.data(), vars.size());
 	bdd down_constraint = bdd_exist(local_constraint, varbdd);
 	return down_constraint;
     }
@@ -349,7 +350,7 @@ public:
 
     bdd get_root() { return tfun.get_root(); }
 
-    int get_clause_id() { return tfun.get_clause_id(); }
+    clause_id_t get_clause_id() { return tfun.get_clause_id(); }
 
     xor_constraint *get_equation() { return xor_equation; }
 
@@ -379,7 +380,7 @@ private:
     int dead_count;
     // Counters used by proof generator
     int variable_count;
-    int last_clause_id;
+    clause_id_t last_clause_id;
   
     // For generating solutions
     bool generate_solution;
@@ -398,7 +399,7 @@ private:
     void check_gc() {
 	int collect_min = proof_type == PROOF_LRAT ? COLLECT_MIN_LRAT : COLLECT_MIN_DRAT;
 	if (dead_count >= collect_min && (double) dead_count / total_count >= COLLECT_FRACTION) {
-	    if (verbosity_level >= 2) {
+	    if (tbdd_prover_vars()->verbosity_level >= 2) {
 		std::cout << "c Initiating GC.  Estimated total nodes = " << total_count << ".  Estimated dead nodes = " << dead_count << std::endl;
 	    }
 	    bdd_gbc();
@@ -574,7 +575,7 @@ public:
 	    if (buckets[blevel].size() == 0) {
 		if (solver && eliminated_variables.count(blevel) == 0) {
 		    // Insert step so that solver will assign value to blevel
-		    int vbuf[ILIST_OVHD+1];
+		    ival_t vbuf[ILIST_OVHD+1];
 		    ilist vlist = ilist_make(vbuf, 1);
 		    ilist_fill1(vlist, bvar);
 		    solver->add_step(vlist, bdd_true());
@@ -626,7 +627,7 @@ public:
 	    } else {
 		if (solver) {
 		    // Insert step so that solver will assign value to blevel
-		    int vbuf[ILIST_OVHD+1];
+		    ival_t vbuf[ILIST_OVHD+1];
 		    ilist vlist = ilist_make(vbuf, 1);
 		    ilist_fill1(vlist, bvar);
 		    solver->add_step(vlist, bdd_true());
@@ -873,7 +874,7 @@ public:
 			for (int pid = 0; pid < iset.xlist.size(); pid++) {
 			    xor_constraint *xc = iset.xlist[pid];
 			    int pvar = pivot_sequence[pid];
-			    int vbuf[ILIST_OVHD+1];
+			    ival_t vbuf[ILIST_OVHD+1];
 			    ilist vlist = ilist_make(vbuf, 1);
 			    ilist_fill1(vlist, pvar);
 			    solver->add_step(vlist, xc->get_validation().get_root());